@@ -0,0 +1,236 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    AslTokenSource - Hand-written lexer for the Asl programming
+//                     language
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "AslTokenSource.h"
+#include "AslLexer.h"
+#include "MappedInputStream.h"
+#include "Utf8.h"
+
+#include "antlr4-runtime.h"
+
+#include <string>
+#include <memory>
+
+// using namespace std;
+
+
+namespace {
+
+  bool isLetter(char c) {
+    return ('a' <= c and c <= 'z') or ('A' <= c and c <= 'Z') or c == '_';
+  }
+
+  bool isDigit(char c) {
+    return '0' <= c and c <= '9';
+  }
+
+}
+
+
+AslTokenSource::AslTokenSource(antlr4::CharStream *input,
+                               const antlr4::dfa::Vocabulary & vocabulary)
+  : input{input}, factory{antlr4::CommonTokenFactory::DEFAULT},
+    pos{0}, index{0}, line{1}, column{0}, error{false} {
+  MappedInputStream *mapped = dynamic_cast<MappedInputStream *>(input);
+  if (mapped) {
+    text = mapped->bytes();
+    size = mapped->numBytes();
+  }
+  else {
+    if (input->size() > 0)
+      copy = input->getText(antlr4::misc::Interval(size_t(0), input->size() - 1));
+    text = copy.data();
+    size = copy.size();
+  }
+  // the literal names of the vocabulary are quoted: "'while'", "'<='"
+  for (size_t c = 0; c < 128; ++c)
+    oneChar[c] = 0;
+  for (size_t type = 1; type <= vocabulary.getMaxTokenType(); ++type) {
+    std::string lit = vocabulary.getLiteralName(type);
+    if (lit.size() < 3 or lit.front() != '\'' or lit.back() != '\'')
+      continue;
+    lit = lit.substr(1, lit.size() - 2);
+    if (isLetter(lit[0]))
+      keywords[lit] = type;
+    else if (lit.size() == 1 and static_cast<unsigned char>(lit[0]) < 128)
+      oneChar[size_t(lit[0])] = type;
+    else if (lit.size() == 2)
+      twoChars[lit] = type;
+  }
+}
+
+bool AslTokenSource::failed() const {
+  return error;
+}
+
+void AslTokenSource::advance() {
+  char c = text[pos];
+  pos += utf8CodePointLength(text, pos, size);
+  ++index;
+  if (c == '\n') {
+    ++line;
+    column = 0;
+  }
+  else
+    ++column;
+}
+
+std::unique_ptr<antlr4::Token> AslTokenSource::token(size_t type, std::size_t startIndex,
+                                                     std::size_t startLine,
+                                                     std::size_t startColumn) {
+  // the text of the token is taken from the input when needed, as
+  // the tokens of AslLexer do
+  return factory->create({this, input}, type, "", antlr4::Token::DEFAULT_CHANNEL,
+                         startIndex, index - 1, startLine, startColumn);
+}
+
+std::unique_ptr<antlr4::Token> AslTokenSource::fail() {
+  error = true;
+  pos = size;
+  return factory->create({this, input}, antlr4::Token::EOF, "", antlr4::Token::DEFAULT_CHANNEL,
+                         index, index - 1, line, column);
+}
+
+std::unique_ptr<antlr4::Token> AslTokenSource::nextToken() {
+  while (pos < size) {
+    char c = text[pos];
+    // WS
+    if (c == ' ' or c == '\t' or c == '\r' or c == '\n') {
+      advance();
+      continue;
+    }
+    // COMMENT: '//' ~('\n'|'\r')* '\r'? '\n'. Without the final '\n'
+    // it is not a comment, but a '/' followed by more tokens
+    if (c == '/' and pos + 1 < size and text[pos+1] == '/') {
+      std::size_t end = pos + 2;
+      while (end < size and text[end] != '\n' and text[end] != '\r')
+        ++end;
+      if (end < size and text[end] == '\r')
+        ++end;
+      if (end < size and text[end] == '\n') {
+        while (pos <= end)
+          advance();
+        continue;
+      }
+    }
+
+    std::size_t startIndex = index, startLine = line, startColumn = column;
+    // ID, or a keyword if it is exactly one
+    if (isLetter(c)) {
+      std::size_t start = pos;
+      while (pos < size and (isLetter(text[pos]) or isDigit(text[pos])))
+        advance();
+      auto kw = keywords.find(std::string(text + start, pos - start));
+      return token(kw != keywords.end() ? kw->second : size_t(AslLexer::ID),
+                   startIndex, startLine, startColumn);
+    }
+    // INTVAL, or FLOATVAL if a '.' and some digit follow
+    if (isDigit(c)) {
+      while (pos < size and isDigit(text[pos]))
+        advance();
+      if (pos + 1 < size and text[pos] == '.' and isDigit(text[pos+1])) {
+        advance();
+        while (pos < size and isDigit(text[pos]))
+          advance();
+        return token(AslLexer::FLOATVAL, startIndex, startLine, startColumn);
+      }
+      return token(AslLexer::INTVAL, startIndex, startLine, startColumn);
+    }
+    // CHARVAL: '\'' (. | '\\n' | '\\t' | '\\\'') '\''. The longest
+    // match wins, so '\'' is the escaped quote, not '\' and a quote
+    if (c == '\'') {
+      if (pos + 3 < size and text[pos+1] == '\\' and text[pos+3] == '\'' and
+          (text[pos+2] == 'n' or text[pos+2] == 't' or text[pos+2] == '\'')) {
+        for (int k = 0; k < 4; ++k)
+          advance();
+        return token(AslLexer::CHARVAL, startIndex, startLine, startColumn);
+      }
+      advance();
+      if (pos < size)
+        advance();
+      if (pos >= size or text[pos] != '\'')
+        return fail();
+      advance();
+      return token(AslLexer::CHARVAL, startIndex, startLine, startColumn);
+    }
+    // STRING: '"' ( ESC_SEQ | ~('\\'|'"') )* '"'
+    if (c == '"') {
+      advance();
+      while (pos < size and text[pos] != '"') {
+        if (text[pos] == '\\') {
+          if (pos + 1 >= size or std::string("btnfr\"'\\").find(text[pos+1]) == std::string::npos)
+            return fail();
+          advance();
+        }
+        advance();
+      }
+      if (pos >= size)
+        return fail();
+      advance();
+      return token(AslLexer::STRING, startIndex, startLine, startColumn);
+    }
+    // operators and punctuation, the longest first
+    if (pos + 1 < size) {
+      auto op = twoChars.find(std::string(text + pos, 2));
+      if (op != twoChars.end()) {
+        advance();
+        advance();
+        return token(op->second, startIndex, startLine, startColumn);
+      }
+    }
+    unsigned char u = static_cast<unsigned char>(c);
+    if (u < 128 and oneChar[u] != 0) {
+      advance();
+      return token(oneChar[u], startIndex, startLine, startColumn);
+    }
+    return fail();
+  }
+  return factory->create({this, input}, antlr4::Token::EOF, "", antlr4::Token::DEFAULT_CHANNEL,
+                         index, index - 1, line, column);
+}
+
+size_t AslTokenSource::getLine() const {
+  return line;
+}
+
+size_t AslTokenSource::getCharPositionInLine() {
+  return column;
+}
+
+antlr4::CharStream * AslTokenSource::getInputStream() {
+  return input;
+}
+
+std::string AslTokenSource::getSourceName() {
+  return input->getSourceName();
+}
+
+antlr4::Ref<antlr4::TokenFactory<antlr4::CommonToken>> AslTokenSource::getTokenFactory() {
+  return factory;
+}
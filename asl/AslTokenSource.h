@@ -0,0 +1,109 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    AslTokenSource - Hand-written lexer for the Asl programming
+//                     language
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "antlr4-runtime.h"
+
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <cstddef>    // std::size_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class AslTokenSource: a lexer for the tokens of Asl.g4 written by
+// hand (a loop and a switch on the current character), that can be
+// given to AslParser instead of the AslLexer generated by antlr4.
+//
+// Its tokens have the same types, text and positions (start/stop
+// index, line and column) as those of AslLexer. The types of the
+// literal tokens ('(', 'of', 'while', '<=', ...) are taken from the
+// vocabulary of AslLexer, so they follow the grammar.
+//
+// It does not try to report or recover from lexical errors like
+// AslLexer does: on any input that is not a valid list of tokens it
+// stops (returning EOF) and failed() becomes true. The input must
+// then be lexed again with AslLexer, which gives the usual messages.
+
+class AslTokenSource : public antlr4::TokenSource {
+
+public:
+
+  // Constructor: tokens of 'input', with the types in 'vocabulary'
+  // (that of AslLexer)
+  AslTokenSource(antlr4::CharStream *input,
+                 const antlr4::dfa::Vocabulary & vocabulary);
+
+  // Has some lexical error been found?
+  bool failed () const;
+
+  // Methods of antlr4::TokenSource
+  std::unique_ptr<antlr4::Token> nextToken () override;
+  size_t getLine () const override;
+  size_t getCharPositionInLine () override;
+  antlr4::CharStream * getInputStream () override;
+  std::string getSourceName () override;
+  antlr4::Ref<antlr4::TokenFactory<antlr4::CommonToken>> getTokenFactory () override;
+
+private:
+
+  antlr4::CharStream * input;
+  antlr4::Ref<antlr4::TokenFactory<antlr4::CommonToken>> factory;
+
+  // The whole input, in UTF-8: the bytes of a MappedInputStream, or
+  // a copy of any other input. Positions in tokens count code points
+  // (as in antlr4::ANTLRInputStream), not bytes.
+  const char * text;
+  std::size_t  size;
+  std::string  copy;
+  std::size_t  pos;        // current byte in 'text'
+  std::size_t  index;      // current code point
+  std::size_t  line;
+  std::size_t  column;
+  bool         error;
+
+  // Token types of the literals of the grammar: keywords, and
+  // operators of one and two characters
+  std::unordered_map<std::string, size_t> keywords;
+  size_t oneChar[128];
+  std::unordered_map<std::string, size_t> twoChars;
+
+  // Move one code point forward (as MappedInputStream splits them,
+  // see Utf8.h)
+  void advance ();
+  // Token of 'type' from (startIndex, startLine, startColumn) to here
+  std::unique_ptr<antlr4::Token> token (size_t type, std::size_t startIndex,
+                                        std::size_t startLine, std::size_t startColumn);
+  // Stop at a lexical error
+  std::unique_ptr<antlr4::Token> fail ();
+
+};  // class AslTokenSource
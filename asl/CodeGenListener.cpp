@@ -33,10 +33,13 @@
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
+#include "../common/StringPool.h"
 #include "../common/TreeDecoration.h"
 #include "../common/code.h"
 
 #include <cstddef>    // std::size_t
+#include <cassert>
+#include <utility>    // std::move
 
 // uncomment the following line to enable debugging messages with DEBUG*
 // #define DEBUG_BUILD
@@ -48,12 +51,15 @@
 // Constructor
 CodeGenListener::CodeGenListener(TypesMgr       & Types,
 				 SymTable       & Symbols,
+				 StringPool     & Names,
 				 TreeDecoration & Decorations,
 				 code           & Code) :
   Types{Types},
   Symbols{Symbols},
+  Names{Names},
   Decorations{Decorations},
   Code{Code} {
+  assert(&Names == &Code.get_pool());
 }
 
 void CodeGenListener::enterProgram(AslParser::ProgramContext *ctx) {
@@ -68,9 +74,10 @@ void CodeGenListener::exitProgram(AslParser::ProgramContext *ctx) {
 
 void CodeGenListener::enterFunction(AslParser::FunctionContext *ctx) {
   DEBUG_ENTER();
-  subroutine subr(ctx->ID()->getText());
-  if (ctx->ID()->getText() != "main")
-    subr.add_param("_result");
+  StringPool::Name name = Names.getName(ctx->ID());
+  subroutine subr(*name);
+  if (*name != "main")
+    subr.add_param(intern("_result"));
   Code.add_subroutine(subr);
   SymTable::ScopeId sc = getScopeDecor(ctx);
   TypesMgr::TypeId t = getTypeDecor(ctx);
@@ -80,9 +87,13 @@ void CodeGenListener::enterFunction(AslParser::FunctionContext *ctx) {
 }
 void CodeGenListener::exitFunction(AslParser::FunctionContext *ctx) {
   subroutine & subrRef = Code.get_last_subroutine();
-  instructionList code = getCodeDecor(ctx->statements());
-  code = code || instruction::RETURN();
-  subrRef.set_instructions(code);
+  instructionList code = takeCodeDecor(ctx->statements());
+  code = std::move(code) || instruction::RETURN();
+  subrRef.set_instructions(std::move(code));
+  Symbols.popScope();
+  DEBUG_EXIT();
+}
+void CodeGenListener::skipFunction(AslParser::FunctionContext *ctx) {
   Symbols.popScope();
   DEBUG_EXIT();
 }
@@ -102,16 +113,17 @@ void CodeGenListener::exitReturnStmt(AslParser::ReturnStmtContext *ctx) {
   if (ctx->expr()) {
     TypesMgr::TypeId te = getTypeDecor(ctx->expr());
     TypesMgr::TypeId tr = Symbols.getCurrentFunctionTy();
-    std::string addr = getAddrDecor(ctx->expr());
-    code = getCodeDecor(ctx->expr());
+    operand addr = getAddrDecor(ctx->expr());
+    operand result = operand::NAME(intern("_result"));
+    code = takeCodeDecor(ctx->expr());
     if (Types.isFloatTy(tr) and (not Types.isFloatTy(te))) {
-      code = code || instruction::FLOAT("_result", addr);
+      code = std::move(code) || instruction::FLOAT(result, addr);
     } else {
-      code = code || instruction::LOAD("_result", addr);
+      code = std::move(code) || instruction::LOAD(result, addr);
     }
   }
-  code = code || instruction::RETURN();
-  putCodeDecor(ctx, code);
+  code = std::move(code) || instruction::RETURN();
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -120,7 +132,7 @@ void CodeGenListener::enterParameter(AslParser::ParameterContext *ctx) {
 }
 void CodeGenListener::exitParameter(AslParser::ParameterContext *ctx) {
   subroutine & subrRef = Code.get_last_subroutine();
-  subrRef.add_param(ctx->ID()->getText());
+  subrRef.add_param(nameOperand(ctx->ID()).value);
   DEBUG_EXIT();
 }
 
@@ -129,7 +141,7 @@ void CodeGenListener::enterParenthesis(AslParser::ParenthesisContext *ctx) {
 }
 void CodeGenListener::exitParenthesis(AslParser::ParenthesisContext *ctx) {
   putAddrDecor(ctx, getAddrDecor(ctx->expr()));
-  putCodeDecor(ctx, getCodeDecor(ctx->expr()));
+  putCodeDecor(ctx, takeCodeDecor(ctx->expr()));
   DEBUG_EXIT();
 }
 
@@ -141,7 +153,7 @@ void CodeGenListener::exitVariable_decl(AslParser::Variable_declContext *ctx) {
   TypesMgr::TypeId t1 = getTypeDecor(ctx->data());
   std::size_t size = Types.getSizeOfType(t1);
   for(unsigned int i = 0; i < ctx->ID().size(); ++i)
-    subrRef.add_var(ctx->ID(i)->getText(), size);
+    subrRef.add_var(nameOperand(ctx->ID(i)).value, size);
   DEBUG_EXIT();
 }
 
@@ -158,9 +170,9 @@ void CodeGenListener::enterStatements(AslParser::StatementsContext *ctx) {
 void CodeGenListener::exitStatements(AslParser::StatementsContext *ctx) {
   instructionList code;
   for (auto stCtx : ctx->statement()) {
-    code = code || getCodeDecor(stCtx);
+    code = std::move(code) || takeCodeDecor(stCtx);
   }
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -177,33 +189,32 @@ void CodeGenListener::enterAssignStmt(AslParser::AssignStmtContext *ctx) {
 }
 void CodeGenListener::exitAssignStmt(AslParser::AssignStmtContext *ctx) {
   instructionList  code;
-  std::string     addr2 = getAddrDecor(ctx->expr());
-  instructionList code2 = getCodeDecor(ctx->expr());
+  operand         addr2 = getAddrDecor(ctx->expr());
+  instructionList code2 = takeCodeDecor(ctx->expr());
   if (ctx->left_expr()->ident()) {
     TypesMgr::TypeId t = getTypeDecor(ctx->left_expr()->ident());
-    std::string     addr1 = getAddrDecor(ctx->left_expr()->ident());
-    instructionList code1 = getCodeDecor(ctx->left_expr()->ident());
+    operand         addr1 = getAddrDecor(ctx->left_expr()->ident());
+    instructionList code1 = takeCodeDecor(ctx->left_expr()->ident());
     if (Types.isArrayTy(t)) {
       size_t s = Types.getArraySize(t);
-      std::string temp1 = "%"+codeCounters.newTEMP();
-      std::string temp2 = "%"+codeCounters.newTEMP();
-      code = code1 || code2;
+      operand temp1 = codeCounters.newTEMP();
+      operand temp2 = codeCounters.newTEMP();
+      code = std::move(code1) || code2;
       for (size_t i = 0; i < s; ++i) {
-        code = code || instruction::ILOAD(temp1, std::to_string(i)) || instruction::LOADX(temp2, addr2, temp1);
-        code = code || instruction::XLOAD(addr1, temp1, temp2);
+        code = std::move(code) || instruction::ILOAD(temp1, operand::INT(intern(std::to_string(i)))) || instruction::LOADX(temp2, addr2, temp1);
+        code = std::move(code) || instruction::XLOAD(addr1, temp1, temp2);
       }
     } else {
-      code = code1 || code2 || instruction::LOAD(addr1, addr2);
+      code = std::move(code1) || code2 || instruction::LOAD(addr1, addr2);
     }
   } else {
-    std::string     addr1 = getAddrDecor(ctx->left_expr()->arrayid()->ident());
-    instructionList code1 = getCodeDecor(ctx->left_expr()->arrayid()->ident());
-    std::string name = ctx->left_expr()->arrayid()->ident()->ID()->getText();
-    instructionList code3 = getCodeDecor(ctx->left_expr()->arrayid()->expr());
-    std::string     addr3 = getAddrDecor(ctx->left_expr()->arrayid()->expr());
-    code = code1 || code3 || code2 || instruction::XLOAD(addr1, addr3, addr2);
+    operand         addr1 = getAddrDecor(ctx->left_expr()->arrayid()->ident());
+    instructionList code1 = takeCodeDecor(ctx->left_expr()->arrayid()->ident());
+    instructionList code3 = takeCodeDecor(ctx->left_expr()->arrayid()->expr());
+    operand         addr3 = getAddrDecor(ctx->left_expr()->arrayid()->expr());
+    code = std::move(code1) || code3 || code2 || instruction::XLOAD(addr1, addr3, addr2);
   }
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -212,22 +223,22 @@ void CodeGenListener::enterIfStmt(AslParser::IfStmtContext *ctx) {
 }
 void CodeGenListener::exitIfStmt(AslParser::IfStmtContext *ctx) {
   instructionList   code;
-  std::string      addr1 = getAddrDecor(ctx->expr());
-  instructionList  code1 = getCodeDecor(ctx->expr());
-  instructionList  code2 = getCodeDecor(ctx->statements());
+  operand          addr1 = getAddrDecor(ctx->expr());
+  instructionList  code1 = takeCodeDecor(ctx->expr());
+  instructionList  code2 = takeCodeDecor(ctx->statements());
   std::string      label = codeCounters.newLabelIF();
-  std::string labelEndIf = "endif"+label;
+  operand     labelEndIf = operand::LABEL(intern("endif"+label));
   if (ctx->elseStmt()) {
-    std::string labelElse = "else"+label;
-    instructionList code3 = getCodeDecor(ctx->elseStmt()->statements());
-    code = code1 || instruction::FJUMP(addr1, labelElse) || code2 ||
+    operand labelElse = operand::LABEL(intern("else"+label));
+    instructionList code3 = takeCodeDecor(ctx->elseStmt()->statements());
+    code = std::move(code1) || instruction::FJUMP(addr1, labelElse) || code2 ||
            instruction::UJUMP(labelEndIf) || instruction::LABEL(labelElse) ||
            code3 || instruction::LABEL(labelEndIf);
   } else {
-    code = code1 || instruction::FJUMP(addr1, labelEndIf) ||
+    code = std::move(code1) || instruction::FJUMP(addr1, labelEndIf) ||
            code2 || instruction::LABEL(labelEndIf);
   }
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -236,15 +247,15 @@ void CodeGenListener::enterWhileStmt(AslParser::WhileStmtContext *ctx) {
 }
 void CodeGenListener::exitWhileStmt(AslParser::WhileStmtContext *ctx) {
   instructionList   code;
-  std::string      addr1 = getAddrDecor(ctx->expr());
-  instructionList  code1 = getCodeDecor(ctx->expr());
-  instructionList  code2 = getCodeDecor(ctx->statements());
+  operand          addr1 = getAddrDecor(ctx->expr());
+  instructionList  code1 = takeCodeDecor(ctx->expr());
+  instructionList  code2 = takeCodeDecor(ctx->statements());
   std::string      label = codeCounters.newLabelWHILE();
-  std::string labelEndWhile = "endwhile"+label;
-  std::string labelWhile = "while"+label;
+  operand labelEndWhile = operand::LABEL(intern("endwhile"+label));
+  operand labelWhile = operand::LABEL(intern("while"+label));
   code = instruction::LABEL(labelWhile) || code1 || instruction::FJUMP(addr1, labelEndWhile) ||
          code2 || instruction::UJUMP(labelWhile) || instruction::LABEL(labelEndWhile);
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -258,31 +269,30 @@ void CodeGenListener::exitProcCall(AslParser::ProcCallContext *ctx) {
   if (ctx->exprs()) {
     std::vector<TypesMgr::TypeId> Params = Types.getFuncParamsTypes(getTypeDecor(ctx->ident())); 
     for (size_t i = 0; i < ctx->exprs()->expr().size(); ++i) {
-      std::string addr = getAddrDecor(ctx->exprs()->expr(i));
-      instructionList code1 = getCodeDecor(ctx->exprs()->expr(i));
+      operand addr = getAddrDecor(ctx->exprs()->expr(i));
+      instructionList code1 = takeCodeDecor(ctx->exprs()->expr(i));
       TypesMgr::TypeId tp = getTypeDecor(ctx->exprs()->expr(i));
       if (Types.isArrayTy(tp)) {
-        std::string temp = "%"+codeCounters.newTEMP();
-        code1 = code1 || instruction::ALOAD(temp, addr);
+        operand temp = codeCounters.newTEMP();
+        code1 = std::move(code1) || instruction::ALOAD(temp, addr);
         addr = temp;
       }
       else if (Types.isFloatTy(Params[i]) and (not Types.isFloatTy(tp))) {
-        std::string temp = "%"+codeCounters.newTEMP();
-        code1 = code1 || instruction::FLOAT(temp, addr);
+        operand temp = codeCounters.newTEMP();
+        code1 = std::move(code1) || instruction::FLOAT(temp, addr);
         addr = temp;
       }
-      code = code || code1 || instruction::PUSH(addr);
+      code = std::move(code) || code1 || instruction::PUSH(addr);
     }
   }
-  std::string name = ctx->ident()->getText();
-  code = code || instruction::CALL(name);
+  code = std::move(code) || instruction::CALL(nameOperand(ctx->ident()->ID()));
   if (ctx->exprs()) {
     for (size_t i = 0; i < ctx->exprs()->expr().size(); ++i) {
-      code = code  || instruction::POP();
+      code = std::move(code) || instruction::POP();
     }
   }
-  code = code || instruction::POP();
-  putCodeDecor(ctx, code);
+  code = std::move(code) || instruction::POP();
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -296,34 +306,32 @@ void CodeGenListener::exitFuncid(AslParser::FuncidContext *ctx) {
   if (ctx->exprs()) {
     std::vector<TypesMgr::TypeId> Params = Types.getFuncParamsTypes(getTypeDecor(ctx->ident())); 
     for (size_t i = 0; i < ctx->exprs()->expr().size(); ++i) {
-      std::string addr = getAddrDecor(ctx->exprs()->expr(i));
-      instructionList code1 = getCodeDecor(ctx->exprs()->expr(i));
+      operand addr = getAddrDecor(ctx->exprs()->expr(i));
+      instructionList code1 = takeCodeDecor(ctx->exprs()->expr(i));
       TypesMgr::TypeId tp = getTypeDecor(ctx->exprs()->expr(i));
       if (Types.isArrayTy(tp)) {
-        std::string temp = "%"+codeCounters.newTEMP();
-        code1 = code1 || instruction::ALOAD(temp, addr);
+        operand temp = codeCounters.newTEMP();
+        code1 = std::move(code1) || instruction::ALOAD(temp, addr);
         addr = temp;
       }
       else if (Types.isFloatTy(Params[i]) and (not Types.isFloatTy(tp))) {
-        std::string temp = "%"+codeCounters.newTEMP();
-        code1 = code1 || instruction::FLOAT(temp, addr);
+        operand temp = codeCounters.newTEMP();
+        code1 = std::move(code1) || instruction::FLOAT(temp, addr);
         addr = temp;
       }
-      code = code || code1 || instruction::PUSH(addr);
+      code = std::move(code) || code1 || instruction::PUSH(addr);
     }
   }
-  std::string name = ctx->ident()->getText();
-  code = code || instruction::CALL(name);
+  code = std::move(code) || instruction::CALL(nameOperand(ctx->ident()->ID()));
   if (ctx->exprs()) {
     for (size_t i = 0; i < ctx->exprs()->expr().size(); ++i) {
-      code = code  || instruction::POP();
+      code = std::move(code) || instruction::POP();
     }
   }
-  std::string label = codeCounters.newTEMP();
-  std::string labelTemp = "%"+label;
-  code = code || instruction::POP(labelTemp);
-  putAddrDecor(ctx,labelTemp);
-  putCodeDecor(ctx, code);
+  operand temp = codeCounters.newTEMP();
+  code = std::move(code) || instruction::POP(temp);
+  putAddrDecor(ctx,temp);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -333,30 +341,30 @@ void CodeGenListener::enterReadStmt(AslParser::ReadStmtContext *ctx) {
 void CodeGenListener::exitReadStmt(AslParser::ReadStmtContext *ctx) {
   instructionList  code;
   TypesMgr::TypeId tid1;
-  std::string     addr1;
+  operand         addr1;
   instructionList code1;
   if (ctx->left_expr()->ident()) {
     tid1 = getTypeDecor(ctx->left_expr()->ident());
     addr1 = getAddrDecor(ctx->left_expr()->ident());
-    code1 = getCodeDecor(ctx->left_expr()->ident());
+    code1 = takeCodeDecor(ctx->left_expr()->ident());
   } else {
     tid1 = getTypeDecor(ctx->left_expr()->arrayid());
-    addr1 = "%"+codeCounters.newTEMP();
-    code1 = getCodeDecor(ctx->left_expr()->arrayid()->expr());
+    addr1 = codeCounters.newTEMP();
+    code1 = takeCodeDecor(ctx->left_expr()->arrayid()->expr());
   }
   if (Types.isFloatTy(tid1)) {
-    code = code1 || instruction::READF(addr1);
+    code = std::move(code1) || instruction::READF(addr1);
   } else if (Types.isCharacterTy(tid1)) {
-    code = code1 || instruction::READC(addr1);
+    code = std::move(code1) || instruction::READC(addr1);
   } else {
-    code = code1 || instruction::READI(addr1);
+    code = std::move(code1) || instruction::READI(addr1);
   }
   if (ctx->left_expr()->arrayid()) {
-    std::string addr2 = getAddrDecor(ctx->left_expr()->arrayid()->ident());
-    std::string addr3 = getAddrDecor(ctx->left_expr()->arrayid()->expr());
-    code = code || instruction::XLOAD(addr2, addr3, addr1);
+    operand addr2 = getAddrDecor(ctx->left_expr()->arrayid()->ident());
+    operand addr3 = getAddrDecor(ctx->left_expr()->arrayid()->expr());
+    code = std::move(code) || instruction::XLOAD(addr2, addr3, addr1);
   }
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -365,17 +373,17 @@ void CodeGenListener::enterWriteExpr(AslParser::WriteExprContext *ctx) {
 }
 void CodeGenListener::exitWriteExpr(AslParser::WriteExprContext *ctx) {
   instructionList code;
-  std::string     addr1 = getAddrDecor(ctx->expr());
-  instructionList code1 = getCodeDecor(ctx->expr());
+  operand         addr1 = getAddrDecor(ctx->expr());
+  instructionList code1 = takeCodeDecor(ctx->expr());
   TypesMgr::TypeId tid1 = getTypeDecor(ctx->expr());
   if (Types.isFloatTy(tid1)) {
-    code = code1 || instruction::WRITEF(addr1);
+    code = std::move(code1) || instruction::WRITEF(addr1);
   } else if (Types.isCharacterTy(tid1)) {
-    code = code1 || instruction::WRITEC(addr1);
+    code = std::move(code1) || instruction::WRITEC(addr1);
   } else {
-    code = code1 || instruction::WRITEI(addr1);
+    code = std::move(code1) || instruction::WRITEI(addr1);
   }
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -385,36 +393,36 @@ void CodeGenListener::enterWriteString(AslParser::WriteStringContext *ctx) {
 void CodeGenListener::exitWriteString(AslParser::WriteStringContext *ctx) {
   instructionList code;
   std::string s = ctx->STRING()->getText();
-  std::string temp = "%"+codeCounters.newTEMP();
+  operand temp = codeCounters.newTEMP();
   int i = 1;
   while (i < int(s.size())-1) {
     if (s[i] != '\\') {
-      code = code ||
-	     instruction::CHLOAD(temp, s.substr(i,1)) ||
+      code = std::move(code) ||
+	     instruction::CHLOAD(temp, operand::CHAR(intern(s.substr(i,1)))) ||
 	     instruction::WRITEC(temp);
       i += 1;
     }
     else {
       assert(i < int(s.size())-2);
       if (s[i+1] == 'n') {
-        code = code || instruction::WRITELN();
+        code = std::move(code) || instruction::WRITELN();
         i += 2;
       }
       else if (s[i+1] == 't' or s[i+1] == '"' or s[i+1] == '\\') {
-        code = code ||
-               instruction::CHLOAD(temp, s.substr(i,2)) ||
+        code = std::move(code) ||
+               instruction::CHLOAD(temp, operand::CHAR(intern(s.substr(i,2)))) ||
 	       instruction::WRITEC(temp);
         i += 2;
       }
       else {
-        code = code ||
-               instruction::CHLOAD(temp, s.substr(i,1)) ||
+        code = std::move(code) ||
+               instruction::CHLOAD(temp, operand::CHAR(intern(s.substr(i,1)))) ||
 	       instruction::WRITEC(temp);
         i += 1;
       }
     }
   }
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -430,7 +438,7 @@ void CodeGenListener::enterIdentExpr(AslParser::IdentExprContext *ctx) {
 }
 void CodeGenListener::exitIdentExpr(AslParser::IdentExprContext *ctx) {
   putAddrDecor(ctx, getAddrDecor(ctx->ident()));
-  putCodeDecor(ctx, getCodeDecor(ctx->ident()));
+  putCodeDecor(ctx, takeCodeDecor(ctx->ident()));
   DEBUG_ENTER();
 }
 
@@ -438,15 +446,14 @@ void CodeGenListener::enterArrayExpr(AslParser::ArrayExprContext *ctx) {
   DEBUG_ENTER();
 }
 void CodeGenListener::exitArrayExpr(AslParser::ArrayExprContext *ctx) {
-  std::string label = codeCounters.newTEMP();
-  std::string labelTemp = "%"+label;
-  std::string addr1 = getAddrDecor(ctx->arrayid()->ident());
-  instructionList code1 =  getCodeDecor(ctx->arrayid()->ident());
-  std::string addr2 = getAddrDecor(ctx->arrayid()->expr());
-  instructionList code2 = getCodeDecor(ctx->arrayid()->expr());
-  instructionList code = code1 || code2 || instruction::LOADX(labelTemp, addr1, addr2);
-  putCodeDecor(ctx, code);
-  putAddrDecor(ctx, labelTemp);
+  operand temp = codeCounters.newTEMP();
+  operand addr1 = getAddrDecor(ctx->arrayid()->ident());
+  instructionList code1 =  takeCodeDecor(ctx->arrayid()->ident());
+  operand addr2 = getAddrDecor(ctx->arrayid()->expr());
+  instructionList code2 = takeCodeDecor(ctx->arrayid()->expr());
+  instructionList code = std::move(code1) || code2 || instruction::LOADX(temp, addr1, addr2);
+  putCodeDecor(ctx, std::move(code));
+  putAddrDecor(ctx, temp);
   DEBUG_ENTER();
 }
 
@@ -454,51 +461,51 @@ void CodeGenListener::enterArithmetic(AslParser::ArithmeticContext *ctx) {
   DEBUG_ENTER();
 }
 void CodeGenListener::exitArithmetic(AslParser::ArithmeticContext *ctx) {
-  std::string     addr1 = getAddrDecor(ctx->expr(0));
-  instructionList code1 = getCodeDecor(ctx->expr(0));
-  std::string     addr2 = getAddrDecor(ctx->expr(1));
-  instructionList code2 = getCodeDecor(ctx->expr(1));
-  instructionList code  = code1 || code2;
-  std::string temp = "%"+codeCounters.newTEMP();
+  operand         addr1 = getAddrDecor(ctx->expr(0));
+  instructionList code1 = takeCodeDecor(ctx->expr(0));
+  operand         addr2 = getAddrDecor(ctx->expr(1));
+  instructionList code2 = takeCodeDecor(ctx->expr(1));
+  instructionList code  = std::move(code1) || code2;
+  operand temp = codeCounters.newTEMP();
   TypesMgr::TypeId tp = getTypeDecor(ctx);
   if (Types.isFloatTy(tp)) {
     TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
     TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
     if (not Types.isFloatTy(t1)) {
-      std::string temp1 = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(temp1,addr1);
+      operand temp1 = codeCounters.newTEMP();
+      code = std::move(code) || instruction::FLOAT(temp1,addr1);
       addr1 = temp1;
     }
     if (not Types.isFloatTy(t2)) {
-      std::string temp2 = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(temp2,addr2);
+      operand temp2 = codeCounters.newTEMP();
+      code = std::move(code) || instruction::FLOAT(temp2,addr2);
       addr2 = temp2;
     }
     if (ctx->MUL()) {
-      code = code || instruction::FMUL(temp, addr1, addr2);
+      code = std::move(code) || instruction::FMUL(temp, addr1, addr2);
     } else if (ctx->DIV()) {
-      code = code || instruction::FDIV(temp, addr1, addr2);
+      code = std::move(code) || instruction::FDIV(temp, addr1, addr2);
     } else if (ctx->PLUS()) {
-      code = code || instruction::FADD(temp, addr1, addr2);
+      code = std::move(code) || instruction::FADD(temp, addr1, addr2);
     } else { // MINUS
-      code = code || instruction::FSUB(temp, addr1, addr2);
+      code = std::move(code) || instruction::FSUB(temp, addr1, addr2);
     }
   } else {
     if (ctx->MUL()) {
-      code = code || instruction::MUL(temp, addr1, addr2);
+      code = std::move(code) || instruction::MUL(temp, addr1, addr2);
     } else if (ctx->DIV()) {
-      code = code || instruction::DIV(temp, addr1, addr2);
+      code = std::move(code) || instruction::DIV(temp, addr1, addr2);
     } else if (ctx->MOD()) {
-      code = code || instruction::DIV(temp, addr1, addr2) || instruction::MUL(temp, addr2, temp) || instruction::SUB(temp, addr1, temp);
+      code = std::move(code) || instruction::DIV(temp, addr1, addr2) || instruction::MUL(temp, addr2, temp) || instruction::SUB(temp, addr1, temp);
     } else if (ctx->PLUS()) {
-      code = code || instruction::ADD(temp, addr1, addr2);
+      code = std::move(code) || instruction::ADD(temp, addr1, addr2);
     } else { // MINUS
-      code = code || instruction::SUB(temp, addr1, addr2);
+      code = std::move(code) || instruction::SUB(temp, addr1, addr2);
     }
   }
   putAddrDecor(ctx, temp);
   putOffsetDecor(ctx, "");
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -506,20 +513,20 @@ void CodeGenListener::enterLogical(AslParser::LogicalContext *ctx) {
   DEBUG_ENTER();
 }
 void CodeGenListener::exitLogical(AslParser::LogicalContext *ctx) {
-  std::string     addr1 = getAddrDecor(ctx->expr(0));
-  instructionList code1 = getCodeDecor(ctx->expr(0));
-  std::string     addr2 = getAddrDecor(ctx->expr(1));
-  instructionList code2 = getCodeDecor(ctx->expr(1));
-  instructionList code  = code1 || code2;
-  std::string temp = "%"+codeCounters.newTEMP();
+  operand         addr1 = getAddrDecor(ctx->expr(0));
+  instructionList code1 = takeCodeDecor(ctx->expr(0));
+  operand         addr2 = getAddrDecor(ctx->expr(1));
+  instructionList code2 = takeCodeDecor(ctx->expr(1));
+  instructionList code  = std::move(code1) || code2;
+  operand temp = codeCounters.newTEMP();
   if (ctx->AND()) {
-    code = code || instruction::AND(temp, addr1, addr2);
+    code = std::move(code) || instruction::AND(temp, addr1, addr2);
   } else {
-    code = code || instruction::OR(temp, addr1, addr2);
+    code = std::move(code) || instruction::OR(temp, addr1, addr2);
   }
   putAddrDecor(ctx, temp);
   putOffsetDecor(ctx, "");
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -527,26 +534,26 @@ void CodeGenListener::enterUnary(AslParser::UnaryContext *ctx) {
   DEBUG_ENTER();
 }
 void CodeGenListener::exitUnary(AslParser::UnaryContext *ctx) {
-  std::string     addr1 = getAddrDecor(ctx->expr());
-  instructionList code1 = getCodeDecor(ctx->expr());
+  operand         addr1 = getAddrDecor(ctx->expr());
+  instructionList code1 = takeCodeDecor(ctx->expr());
   instructionList code  = code1;
-  std::string temp = addr1;
+  operand temp = addr1;
   if (not ctx->PLUS()) {
-    temp = "%"+codeCounters.newTEMP();
+    temp = codeCounters.newTEMP();
     if (ctx->NOT()) {
-      code = code || instruction::NOT(temp, addr1);
+      code = std::move(code) || instruction::NOT(temp, addr1);
     } else {
       TypesMgr::TypeId tp = getTypeDecor(ctx->expr());
       if (Types.isFloatTy(tp)) {
-        code = code || instruction::FNEG(temp, addr1);
+        code = std::move(code) || instruction::FNEG(temp, addr1);
       } else {
-        code = code || instruction::NEG(temp, addr1);
+        code = std::move(code) || instruction::NEG(temp, addr1);
       }
     }
   }
   putAddrDecor(ctx, temp);
   putOffsetDecor(ctx, "");
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -554,56 +561,56 @@ void CodeGenListener::enterRelational(AslParser::RelationalContext *ctx) {
   DEBUG_ENTER();
 }
 void CodeGenListener::exitRelational(AslParser::RelationalContext *ctx) {
-  std::string     addr1 = getAddrDecor(ctx->expr(0));
-  instructionList code1 = getCodeDecor(ctx->expr(0));
-  std::string     addr2 = getAddrDecor(ctx->expr(1));
-  instructionList code2 = getCodeDecor(ctx->expr(1));
-  instructionList code  = code1 || code2;
-  std::string temp = "%"+codeCounters.newTEMP();
+  operand         addr1 = getAddrDecor(ctx->expr(0));
+  instructionList code1 = takeCodeDecor(ctx->expr(0));
+  operand         addr2 = getAddrDecor(ctx->expr(1));
+  instructionList code2 = takeCodeDecor(ctx->expr(1));
+  instructionList code  = std::move(code1) || code2;
+  operand temp = codeCounters.newTEMP();
   TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
   TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
   if (Types.isFloatTy(t1) or Types.isFloatTy(t2)) {
     if (not Types.isFloatTy(t1)) {
-      std::string temp1 = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(temp1,addr1);
+      operand temp1 = codeCounters.newTEMP();
+      code = std::move(code) || instruction::FLOAT(temp1,addr1);
       addr1 = temp1;
     }
     if (not Types.isFloatTy(t2)) {
-      std::string temp2 = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(temp2,addr2);
+      operand temp2 = codeCounters.newTEMP();
+      code = std::move(code) || instruction::FLOAT(temp2,addr2);
       addr2 = temp2;
     }
     if (ctx->EQUAL()) {
-      code = code || instruction::FEQ(temp, addr1, addr2);
+      code = std::move(code) || instruction::FEQ(temp, addr1, addr2);
     } else if (ctx->NEQUAL()) {
-      code = code || instruction::FEQ(temp, addr1, addr2) || instruction::NOT(temp, temp);
+      code = std::move(code) || instruction::FEQ(temp, addr1, addr2) || instruction::NOT(temp, temp);
     } else if (ctx->LT()) {
-      code = code || instruction::FLT(temp, addr1, addr2);
+      code = std::move(code) || instruction::FLT(temp, addr1, addr2);
     } else if (ctx->GT()) {
-      code = code || instruction::FLT(temp, addr2, addr1);
+      code = std::move(code) || instruction::FLT(temp, addr2, addr1);
     } else if (ctx->LE()) {
-      code = code || instruction::FLE(temp, addr1, addr2);
+      code = std::move(code) || instruction::FLE(temp, addr1, addr2);
     } else { // GE
-      code = code || instruction::FLE(temp, addr2, addr1);
+      code = std::move(code) || instruction::FLE(temp, addr2, addr1);
     }
   } else {
     if (ctx->EQUAL()) {
-      code = code || instruction::EQ(temp, addr1, addr2);
+      code = std::move(code) || instruction::EQ(temp, addr1, addr2);
     } else if (ctx->NEQUAL()) {
-      code = code || instruction::EQ(temp, addr1, addr2) || instruction::NOT(temp, temp);
+      code = std::move(code) || instruction::EQ(temp, addr1, addr2) || instruction::NOT(temp, temp);
     } else if (ctx->LT()) {
-      code = code || instruction::LT(temp, addr1, addr2);
+      code = std::move(code) || instruction::LT(temp, addr1, addr2);
     } else if (ctx->GT()) {
-      code = code || instruction::LT(temp, addr2, addr1);
+      code = std::move(code) || instruction::LT(temp, addr2, addr1);
     } else if (ctx->LE()) {
-      code = code || instruction::LE(temp, addr1, addr2);
+      code = std::move(code) || instruction::LE(temp, addr1, addr2);
     } else { // GE
-      code = code || instruction::LE(temp, addr2, addr1);
+      code = std::move(code) || instruction::LE(temp, addr2, addr1);
     }
   }
   putAddrDecor(ctx, temp);
   putOffsetDecor(ctx, "");
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -612,23 +619,23 @@ void CodeGenListener::enterValue(AslParser::ValueContext *ctx) {
 }
 void CodeGenListener::exitValue(AslParser::ValueContext *ctx) {
   instructionList code;
-  std::string temp = "%"+codeCounters.newTEMP();
+  operand temp = codeCounters.newTEMP();
   if (ctx->INTVAL()) {
-    code = instruction::ILOAD(temp, ctx->getText());
+    code = instruction::ILOAD(temp, operand::INT(intern(ctx->getText())));
   } else if (ctx->CHARVAL()) {
     int mida = (int)ctx->getText().size();
     assert(mida > 2);
-    code = instruction::CHLOAD(temp, ctx->getText().substr(1,mida-2));
+    code = instruction::CHLOAD(temp, operand::CHAR(intern(ctx->getText().substr(1,mida-2))));
   } else if (ctx->FLOATVAL()) {
-    code = instruction::FLOAD(temp, ctx->getText());
+    code = instruction::FLOAD(temp, operand::FLOAT(intern(ctx->getText())));
   } else if (ctx->TRUE()) {
-    code = instruction::ILOAD(temp, "1");
+    code = instruction::ILOAD(temp, operand::INT(intern("1")));
   } else {
-    code = instruction::ILOAD(temp, "0");
+    code = instruction::ILOAD(temp, operand::INT(intern("0")));
   }
   putAddrDecor(ctx, temp);
   putOffsetDecor(ctx, "");
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   DEBUG_EXIT();
 }
 
@@ -636,15 +643,15 @@ void CodeGenListener::enterIdent(AslParser::IdentContext *ctx) {
   DEBUG_ENTER();
 }
 void CodeGenListener::exitIdent(AslParser::IdentContext *ctx) {
-  std::string name = ctx->ID()->getText();
+  operand name = nameOperand(ctx->ID());
   putOffsetDecor(ctx, "");
   instructionList code;
-  if (Types.isArrayTy(getTypeDecor(ctx)) and Symbols.isParameterClass(name)) {
-    std::string temp = "%"+codeCounters.newTEMP();
+  if (Types.isArrayTy(getTypeDecor(ctx)) and Symbols.isParameterClass(getSymbolDecor(ctx))) {
+    operand temp = codeCounters.newTEMP();
     code = instruction::LOAD(temp, name);
     name = temp;
   }
-  putCodeDecor(ctx, code);
+  putCodeDecor(ctx, std::move(code));
   putAddrDecor(ctx, name);
   DEBUG_EXIT();
 }
@@ -662,32 +669,45 @@ void CodeGenListener::exitIdent(AslParser::IdentContext *ctx) {
 // }
 
 
+// Operands of the code generated: the name of an identifier (the
+// Name kept for its token, with no new hashing), and the Id of a
+// label or constant in the pool of the code
+operand CodeGenListener::nameOperand(antlr4::tree::TerminalNode *id) {
+  return operand::NAME(Names.id(Names.getName(id)));
+}
+StringPool::Id CodeGenListener::intern(const std::string & s) {
+  return Names.id(Names.intern(s));
+}
+
 // Getters for the necessary tree node atributes:
-//   Scope, Type, Addr, Offset and Code
+//   Scope, Type, Symbol, Addr, Offset and Code
 SymTable::ScopeId CodeGenListener::getScopeDecor(antlr4::ParserRuleContext *ctx) {
   return Decorations.getScope(ctx);
 }
 TypesMgr::TypeId CodeGenListener::getTypeDecor(antlr4::ParserRuleContext *ctx) {
   return Decorations.getType(ctx);
 }
-std::string CodeGenListener::getAddrDecor(antlr4::ParserRuleContext *ctx) {
+SymTable::SymbolId CodeGenListener::getSymbolDecor(antlr4::ParserRuleContext *ctx) {
+  return Decorations.getSymbol(ctx);
+}
+const operand & CodeGenListener::getAddrDecor(antlr4::ParserRuleContext *ctx) {
   return Decorations.getAddr(ctx);
 }
-std::string  CodeGenListener::getOffsetDecor(antlr4::ParserRuleContext *ctx) {
+const std::string & CodeGenListener::getOffsetDecor(antlr4::ParserRuleContext *ctx) {
   return Decorations.getOffset(ctx);
 }
-instructionList CodeGenListener::getCodeDecor(antlr4::ParserRuleContext *ctx) {
-  return Decorations.getCode(ctx);
+instructionList CodeGenListener::takeCodeDecor(antlr4::ParserRuleContext *ctx) {
+  return Decorations.takeCode(ctx);
 }
 
 // Setters for the necessary tree node attributes:
 //   Addr, Offset and Code
-void CodeGenListener::putAddrDecor(antlr4::ParserRuleContext *ctx, const std::string & a) {
+void CodeGenListener::putAddrDecor(antlr4::ParserRuleContext *ctx, const operand & a) {
   Decorations.putAddr(ctx, a);
 }
 void CodeGenListener::putOffsetDecor(antlr4::ParserRuleContext *ctx, const std::string & o) {
   Decorations.putOffset(ctx, o);
 }
-void CodeGenListener::putCodeDecor(antlr4::ParserRuleContext *ctx, const instructionList & c) {
-  Decorations.putCode(ctx, c);
+void CodeGenListener::putCodeDecor(antlr4::ParserRuleContext *ctx, instructionList && c) {
+  Decorations.putCode(ctx, std::move(c));
 }
@@ -34,6 +34,7 @@
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
+#include "../common/StringPool.h"
 #include "../common/TreeDecoration.h"
 #include "../common/code.h"
 
@@ -56,9 +57,11 @@ class  CodeGenListener : public AslBaseListener {
 
 public:
 
-  // Constructor
+  // Constructor (Names must be the pool of Code: the operands of
+  // the identifiers are the Ids of their Names)
   CodeGenListener(TypesMgr       & Types,
 		  SymTable       & Symbols,
+		  StringPool     & Names,
 		  TreeDecoration & TreeNodeProps,
 		  code           & Code);
 
@@ -67,6 +70,11 @@ public:
 
   void enterFunction(AslParser::FunctionContext *ctx);
   void exitFunction(AslParser::FunctionContext *ctx);
+  // Instead of exitFunction, for a function where a semantic error has
+  // been found after enterFunction (PipelineListener type checks and
+  // generates code in the same walk): no code is generated for it,
+  // and only its scope is closed
+  void skipFunction(AslParser::FunctionContext *ctx);
 
   void enterDeclarations(AslParser::DeclarationsContext *ctx);
   void exitDeclarations(AslParser::DeclarationsContext *ctx);
@@ -153,22 +161,31 @@ private:
   // Attributes
   TypesMgr        & Types;
   SymTable        & Symbols;
+  StringPool      & Names;
   TreeDecoration  & Decorations;
   code            & Code;
   counters          codeCounters;
 
+  // Operands of the code: the name of an identifier, and the Id of
+  // a label or constant, with their text interned in Names
+  operand             nameOperand    (antlr4::tree::TerminalNode *id);
+  StringPool::Id      intern         (const std::string & s);
+
   // Getters for the necessary tree node atributes:
-  //   Scope, Type, Addr, Offset and Code
-  SymTable::ScopeId getScopeDecor  (antlr4::ParserRuleContext *ctx);
-  TypesMgr::TypeId  getTypeDecor   (antlr4::ParserRuleContext *ctx);
-  std::string       getAddrDecor   (antlr4::ParserRuleContext *ctx);
-  std::string       getOffsetDecor (antlr4::ParserRuleContext *ctx);
-  instructionList   getCodeDecor   (antlr4::ParserRuleContext *ctx);
+  //   Scope, Type, Symbol, Addr, Offset and Code
+  SymTable::ScopeId   getScopeDecor  (antlr4::ParserRuleContext *ctx);
+  TypesMgr::TypeId    getTypeDecor   (antlr4::ParserRuleContext *ctx);
+  SymTable::SymbolId  getSymbolDecor (antlr4::ParserRuleContext *ctx);
+  const operand     & getAddrDecor   (antlr4::ParserRuleContext *ctx);
+  const std::string & getOffsetDecor (antlr4::ParserRuleContext *ctx);
+  // (the code of a node is used only once, by its parent, so it is
+  // moved out of the node instead of copied)
+  instructionList     takeCodeDecor  (antlr4::ParserRuleContext *ctx);
 
   // Setters for the necessary tree node attributes:
   //   Addr, Offset and Code
-  void putAddrDecor   (antlr4::ParserRuleContext *ctx, const std::string & a);
+  void putAddrDecor   (antlr4::ParserRuleContext *ctx, const operand & a);
   void putOffsetDecor (antlr4::ParserRuleContext *ctx, const std::string & o);
-  void putCodeDecor   (antlr4::ParserRuleContext *ctx, const instructionList & c);
+  void putCodeDecor   (antlr4::ParserRuleContext *ctx, instructionList && c);
 
 };
@@ -0,0 +1,196 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    MappedInputStream - Source of an Asl program, read with no
+//                        copies for the lexer
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "MappedInputStream.h"
+#include "Utf8.h"
+
+#include "antlr4-runtime.h"
+
+#include <string>
+#include <iterator>   // istreambuf_iterator
+#include <algorithm>  // upper_bound
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// using namespace std;
+
+
+MappedInputStream::MappedInputStream()
+  : data{""}, length{0}, mapping{nullptr}, numCodePoints{0}, p{0} { }
+
+MappedInputStream::~MappedInputStream() {
+  if (mapping)
+    munmap(mapping, length);
+}
+
+bool MappedInputStream::open(const std::string & fileName) {
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 or not S_ISREG(st.st_mode)) {
+    close(fd);
+    return false;
+  }
+  name = fileName;
+  length = st.st_size;
+  if (length > 0) {
+    mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      mapping = nullptr;
+      length = 0;
+      close(fd);
+      return false;
+    }
+    // the lexer reads it once, from the beginning to the end
+    madvise(mapping, length, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(mapping);
+  }
+  close(fd);
+  scan();
+  return true;
+}
+
+bool MappedInputStream::read(std::istream & is) {
+  buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+  if (is.bad())
+    return false;
+  data = buffer.data();
+  length = buffer.size();
+  scan();
+  return true;
+}
+
+const char * MappedInputStream::bytes() const {
+  return data;
+}
+
+std::size_t MappedInputStream::numBytes() const {
+  return length;
+}
+
+void MappedInputStream::scan() {
+  wide.clear();
+  std::size_t i = 0;
+  for (std::size_t b = 0; b < length; ++i) {
+    if (static_cast<unsigned char>(data[b]) < 0x80) {
+      ++b;
+      continue;
+    }
+    std::size_t k = utf8CodePointLength(data, b, length);
+    if (k > 1)
+      wide.push_back(Wide{i, b, b + k});
+    b += k;
+  }
+  numCodePoints = i;
+  p = 0;
+}
+
+std::size_t MappedInputStream::offset(std::size_t i) const {
+  if (wide.empty())
+    return i;
+  // the last wide character at or before code point i
+  auto it = std::upper_bound(wide.begin(), wide.end(), i,
+                             [](std::size_t i, const Wide & w) { return i < w.index; });
+  if (it == wide.begin())
+    return i;
+  --it;
+  return (it->index == i ? it->begin : it->end + (i - it->index - 1));
+}
+
+size_t MappedInputStream::decode(std::size_t b) const {
+  unsigned char c = data[b];
+  std::size_t n = utf8CodePointLength(data, b, length);
+  if (n == 1)
+    return c;
+  size_t cp = c & (0x7F >> utf8Length(c));
+  for (std::size_t k = 1; k < n; ++k)
+    cp = (cp << 6) | (data[b+k] & 0x3F);
+  return cp;
+}
+
+// Methods of antlr4::CharStream, with the same behaviour as those of
+// antlr4::ANTLRInputStream
+
+void MappedInputStream::consume() {
+  if (p >= numCodePoints)
+    throw antlr4::IllegalStateException("cannot consume EOF");
+  ++p;
+}
+
+size_t MappedInputStream::LA(ssize_t i) {
+  if (i == 0)
+    return 0;     // undefined
+  ssize_t pos = ssize_t(p) + (i < 0 ? i : i - 1);
+  if (pos < 0 or size_t(pos) >= numCodePoints)
+    return antlr4::IntStream::EOF;
+  if (wide.empty())
+    return static_cast<unsigned char>(data[pos]);
+  return decode(offset(pos));
+}
+
+ssize_t MappedInputStream::mark() {
+  return -1;
+}
+
+void MappedInputStream::release(ssize_t marker) {
+}
+
+size_t MappedInputStream::index() {
+  return p;
+}
+
+void MappedInputStream::seek(size_t index) {
+  p = std::min(index, numCodePoints);
+}
+
+size_t MappedInputStream::size() {
+  return numCodePoints;
+}
+
+std::string MappedInputStream::getSourceName() const {
+  return name.empty() ? antlr4::IntStream::UNKNOWN_SOURCE_NAME : name;
+}
+
+std::string MappedInputStream::getText(const antlr4::misc::Interval & interval) {
+  if (interval.a < 0 or interval.b < 0 or size_t(interval.a) >= numCodePoints)
+    return "";
+  size_t stop = std::min(size_t(interval.b), numCodePoints - 1);
+  if (stop < size_t(interval.a))
+    return "";
+  std::size_t begin = offset(interval.a), end = offset(stop + 1);
+  return std::string(data + begin, end - begin);
+}
+
+std::string MappedInputStream::toString() const {
+  return std::string(data, length);
+}
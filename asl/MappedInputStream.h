@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    MappedInputStream - Source of an Asl program, read with no
+//                        copies for the lexer
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "antlr4-runtime.h"
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <cstddef>    // std::size_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class MappedInputStream: an antlr4::CharStream over the UTF-8 bytes
+// of the source, as they are in a file mapped in memory (or as they
+// were read from a stream, in a single buffer).
+//
+// antlr4::ANTLRInputStream decodes the whole source to UTF-32, four
+// bytes per character. Here the bytes are used as they are, and
+// characters are decoded when the lexer asks for them. Like in
+// ANTLRInputStream, indices count code points, not bytes: to find
+// the byte of a code point, the stream keeps the position of every
+// character of more than one byte (there are none in most sources,
+// and then code points and bytes are the same).
+
+class MappedInputStream : public antlr4::CharStream {
+
+public:
+
+  // Constructor and destructor (which unmaps the file, if any)
+  MappedInputStream();
+  ~MappedInputStream();
+  MappedInputStream(const MappedInputStream &) = delete;
+  MappedInputStream & operator=(const MappedInputStream &) = delete;
+
+  // Map the contents of a file. Returns false if it cannot be read.
+  bool open (const std::string & fileName);
+  // Read all the contents of a stream
+  bool read (std::istream & is);
+
+  // The source, in UTF-8
+  const char * bytes    () const;
+  std::size_t  numBytes () const;
+  // Byte where code point 'i' starts (numBytes() if i is the end):
+  // the text of a token goes from the offset of its start index to
+  // that of its stop index + 1
+  std::size_t  offset   (std::size_t i) const;
+
+  // Methods of antlr4::CharStream
+  void consume () override;
+  size_t LA (ssize_t i) override;
+  ssize_t mark () override;
+  void release (ssize_t marker) override;
+  size_t index () override;
+  void seek (size_t index) override;
+  size_t size () override;
+  std::string getSourceName () const override;
+  std::string getText (const antlr4::misc::Interval & interval) override;
+  std::string toString () const override;
+
+private:
+
+  const char * data;
+  std::size_t  length;          // in bytes
+  void *       mapping;         // the mapped file, or nullptr
+  std::string  buffer;          // what was read, if not mapped
+  std::string  name;
+
+  std::size_t  numCodePoints;
+  std::size_t  p;               // current code point
+
+  // A character of more than one byte: its code point index, and
+  // the bytes it takes
+  struct Wide {
+    std::size_t index;
+    std::size_t begin;
+    std::size_t end;
+  };
+  std::vector<Wide> wide;
+
+  // Find the code points of more than one byte
+  void scan ();
+  // Code point starting at byte 'b'
+  size_t decode (std::size_t b) const;
+
+};  // class MappedInputStream
@@ -0,0 +1,139 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    PipelineListener - Type check and generate code for the Asl
+//                       programming language in a single walk
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "PipelineListener.h"
+
+#include "antlr4-runtime.h"
+#include "AslParser.h"
+#include "tree/ParseTreeWalker.h"
+
+#include "../common/TreeDecoration.h"
+#include "../common/SemErrors.h"
+#include "SymbolsListener.h"
+#include "TypeCheckListener.h"
+#include "CodeGenListener.h"
+
+#include <algorithm>  // std::max
+
+// using namespace std;
+
+
+// Constructor
+PipelineListener::PipelineListener(SymbolsListener   & SymbolDecl,
+                                   TypeCheckListener & TypeCheck,
+                                   CodeGenListener   & CodeGen,
+                                   TreeDecoration    & Decorations,
+                                   SemErrors         & Errors) :
+  SymbolDecl{SymbolDecl},
+  TypeCheck{TypeCheck},
+  CodeGen{CodeGen},
+  Decorations{Decorations},
+  Errors{Errors},
+  genProgram{false},
+  genFunction{false},
+  maxEntries{0} {
+}
+
+void PipelineListener::declare(AslParser::ProgramContext *ctx) {
+  // the same calls to the SymbolsListener, in the same order, as the
+  // walk of the whole tree (it does nothing on statements)
+  antlr4::tree::ParseTreeWalker & walker = antlr4::tree::ParseTreeWalker::DEFAULT;
+  SymbolDecl.enterProgram(ctx);
+  for (auto fCtx : ctx->function()) {
+    SymbolDecl.enterFunction(fCtx);
+    if (fCtx->parameters())
+      walker.walk(&SymbolDecl, fCtx->parameters());
+    if (fCtx->type())
+      walker.walk(&SymbolDecl, fCtx->type());
+    walker.walk(&SymbolDecl, fCtx->declarations());
+    SymbolDecl.exitFunction(fCtx);
+  }
+  SymbolDecl.exitProgram(ctx);
+}
+
+bool PipelineListener::generating() const {
+  return Errors.getNumberOfSemanticErrors() == 0;
+}
+
+// Each context calls the method of its own rule (enterFunction,
+// exitArithmetic, ...) of a listener with enterRule and exitRule.
+// For every node, the TypeCheckListener goes first, as the code
+// generation needs the types it decorates the node with.
+void PipelineListener::enterEveryRule(antlr4::ParserRuleContext *ctx) {
+  ctx->enterRule(&TypeCheck);
+  size_t rule = ctx->getRuleIndex();
+  if (rule == AslParser::RuleProgram) {
+    genProgram = generating();
+    if (genProgram) ctx->enterRule(&CodeGen);
+  }
+  else if (rule == AslParser::RuleFunction) {
+    genFunction = generating();
+    if (genFunction) ctx->enterRule(&CodeGen);
+  }
+  else if (generating()) {
+    ctx->enterRule(&CodeGen);
+  }
+}
+
+void PipelineListener::exitEveryRule(antlr4::ParserRuleContext *ctx) {
+  ctx->exitRule(&TypeCheck);
+  size_t rule = ctx->getRuleIndex();
+  if (rule == AslParser::RuleProgram) {
+    if (genProgram) ctx->exitRule(&CodeGen);
+  }
+  else if (rule == AslParser::RuleFunction) {
+    // a function with some semantic error has no code to finish
+    // (its nodes have not been exited by the CodeGenListener since)
+    if (genFunction and generating())
+      ctx->exitRule(&CodeGen);
+    else if (genFunction)
+      CodeGen.skipFunction(static_cast<AslParser::FunctionContext *>(ctx));
+    // the subroutine is finished: its decorations are no longer needed
+    maxEntries = std::max(maxEntries, Decorations.getNumberOfEntries());
+    for (auto node : walked)
+      Decorations.removeDecorations(node);
+    Decorations.removeDecorations(ctx);
+    walked.clear();
+  }
+  else {
+    if (generating()) ctx->exitRule(&CodeGen);
+    walked.push_back(ctx);
+  }
+}
+
+void PipelineListener::visitTerminal(antlr4::tree::TerminalNode *node) {
+}
+
+void PipelineListener::visitErrorNode(antlr4::tree::ErrorNode *node) {
+}
+
+// Statistics:
+std::size_t PipelineListener::getMaxNumberOfEntries() const {
+  return maxEntries;
+}
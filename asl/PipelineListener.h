@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    PipelineListener - Type check and generate code for the Asl
+//                       programming language in a single walk
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "antlr4-runtime.h"
+#include "AslParser.h"
+
+#include "../common/TreeDecoration.h"
+#include "../common/SemErrors.h"
+#include "SymbolsListener.h"
+#include "TypeCheckListener.h"
+#include "CodeGenListener.h"
+
+#include <vector>
+#include <cstddef>    // std::size_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class PipelineListener: does the work of the SymbolsListener, the
+// TypeCheckListener and the CodeGenListener with fewer walks of the
+// parser tree:
+//   - declare() collects the declarations (functions, parameters and
+//     local variables) walking only the header and the declarations
+//     of each function, not its statements
+//   - then a single walk of the whole tree with this listener calls,
+//     for every node, the methods of the TypeCheckListener and then
+//     those of the CodeGenListener
+// The code of a function is generated while it is type checked, so
+// it is generated only as long as no semantic error has been found
+// (after the first one, only the type check goes on, to report all
+// of them). When a function has been walked its subroutine is done,
+// and the decorations of its nodes are removed from TreeDecoration.
+
+class PipelineListener final : public antlr4::tree::ParseTreeListener {
+
+public:
+
+  // Constructor
+  PipelineListener(SymbolsListener   & SymbolDecl,
+                   TypeCheckListener & TypeCheck,
+                   CodeGenListener   & CodeGen,
+                   TreeDecoration    & Decorations,
+                   SemErrors         & Errors);
+
+  // Collect the declarations of the program, like a walk with the
+  // SymbolsListener, but skipping the statements of the functions
+  void declare (AslParser::ProgramContext *ctx);
+
+  // Methods of antlr4::tree::ParseTreeListener
+  void enterEveryRule (antlr4::ParserRuleContext *ctx) override;
+  void exitEveryRule  (antlr4::ParserRuleContext *ctx) override;
+  void visitTerminal  (antlr4::tree::TerminalNode *node) override;
+  void visitErrorNode (antlr4::tree::ErrorNode *node) override;
+
+  // Accessor to get the largest number of decorations stored at the
+  // same time while walking a function (statistics)
+  std::size_t getMaxNumberOfEntries () const;
+
+private:
+
+  // Attributes
+  SymbolsListener   & SymbolDecl;
+  TypeCheckListener & TypeCheck;
+  CodeGenListener   & CodeGen;
+  TreeDecoration    & Decorations;
+  SemErrors         & Errors;
+
+  // Has the CodeGenListener entered the program / current function?
+  // (then it has to exit it, or skip the function if some error is
+  // found inside)
+  bool genProgram;
+  bool genFunction;
+
+  // Nodes walked so far in the current function, to be undecorated
+  std::vector<antlr4::ParserRuleContext *> walked;
+  std::size_t maxEntries;
+
+  // Code is generated until the first semantic error
+  bool generating () const;
+
+};  // class PipelineListener
@@ -33,6 +33,7 @@
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
+#include "../common/StringPool.h"
 #include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
 
@@ -52,10 +53,12 @@
 // Constructor
 SymbolsListener::SymbolsListener(TypesMgr       & Types,
 				 SymTable       & Symbols,
+				 StringPool     & Names,
 				 TreeDecoration & Decorations,
 				 SemErrors      & Errors) :
   Types{Types},
   Symbols{Symbols},
+  Names{Names},
   Decorations{Decorations},
   Errors{Errors} {
 }
@@ -73,14 +76,13 @@ void SymbolsListener::exitProgram(AslParser::ProgramContext *ctx) {
 
 void SymbolsListener::enterFunction(AslParser::FunctionContext *ctx) {
   DEBUG_ENTER();
-  std::string funcName = ctx->ID()->getText();
-  SymTable::ScopeId sc = Symbols.pushNewScope(funcName);
+  SymTable::ScopeId sc = Symbols.pushNewScope(*Names.getName(ctx->ID()));
   putScopeDecor(ctx, sc);
 }
 void SymbolsListener::exitFunction(AslParser::FunctionContext *ctx) {
   // Symbols.print();
   Symbols.popScope();
-  std::string ident = ctx->ID()->getText();
+  StringPool::Name ident = Names.getName(ctx->ID());
   if (Symbols.findInCurrentScope(ident)) {
     Errors.declaredIdent(ctx->ID());
     TypesMgr::TypeId t = Types.createErrorTy();
@@ -106,7 +108,7 @@ void SymbolsListener::enterParameter(AslParser::ParameterContext *ctx) {
 
 void SymbolsListener::exitParameter(AslParser::ParameterContext *ctx) {
   TypesMgr::TypeId t = getTypeDecor(ctx->data());
-  std::string ident = ctx->ID()->getText();
+  StringPool::Name ident = Names.getName(ctx->ID());
   if (Symbols.findInCurrentScope(ident)) {
     Errors.declaredIdent(ctx->ID());
   } else {
@@ -129,7 +131,7 @@ void SymbolsListener::enterVariable_decl(AslParser::Variable_declContext *ctx) {
 void SymbolsListener::exitVariable_decl(AslParser::Variable_declContext *ctx) {
   TypesMgr::TypeId t1 = getTypeDecor(ctx->data());                
   for(unsigned int i = 0; i < ctx->ID().size(); ++i){
-    std::string ident = ctx->ID(i)->getText();
+    StringPool::Name ident = Names.getName(ctx->ID(i));
     if (Symbols.findInCurrentScope(ident)) {
        Errors.declaredIdent(ctx->ID(i));
     }
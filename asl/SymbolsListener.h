@@ -34,6 +34,7 @@
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
+#include "../common/StringPool.h"
 #include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
 
@@ -54,6 +55,7 @@ public:
   // Constructor
   SymbolsListener(TypesMgr       & Types,
 		  SymTable       & Symbols,
+		  StringPool     & Names,
 		  TreeDecoration & TreeNodeProps,
 		  SemErrors      & Errors);
 
@@ -127,6 +129,7 @@ private:
   // Attributes:
   TypesMgr       & Types;
   SymTable       & Symbols;
+  StringPool     & Names;
   TreeDecoration & Decorations;
   SemErrors      & Errors;
 
@@ -33,6 +33,7 @@
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
+#include "../common/StringPool.h"
 #include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
 
@@ -49,10 +50,12 @@
 // Constructor
 TypeCheckListener::TypeCheckListener(TypesMgr       & Types,
 				     SymTable       & Symbols,
+				     StringPool     & Names,
 				     TreeDecoration & Decorations,
 				     SemErrors      & Errors) :
   Types{Types},
   Symbols {Symbols},
+  Names{Names},
   Decorations{Decorations},
   Errors{Errors} {
 }
@@ -406,17 +409,20 @@ void TypeCheckListener::enterIdent(AslParser::IdentContext *ctx) {
   DEBUG_ENTER();
 }
 void TypeCheckListener::exitIdent(AslParser::IdentContext *ctx) {
-  std::string ident = ctx->getText();
-  if (Symbols.findInStack(ident) == -1) {
+  // the identifier is looked up by name only here: the next phases
+  // get its symbol from the node
+  SymTable::SymbolId sym = Symbols.findSymbol(Names.getName(ctx->ID()));
+  putSymbolDecor(ctx, sym);
+  if (sym == SymTable::NoSymbol) {
     Errors.undeclaredIdent(ctx->ID());
     TypesMgr::TypeId te = Types.createErrorTy();
     putTypeDecor(ctx, te);
     putIsLValueDecor(ctx, true);
   }
   else {
-    TypesMgr::TypeId t1 = Symbols.getType(ident);
+    TypesMgr::TypeId t1 = Symbols.getType(sym);
     putTypeDecor(ctx, t1);
-    if (Symbols.isFunctionClass(ident))
+    if (Symbols.isFunctionClass(sym))
       putIsLValueDecor(ctx, false);
     else
       putIsLValueDecor(ctx, true);
@@ -450,13 +456,16 @@ bool TypeCheckListener::getIsLValueDecor(antlr4::ParserRuleContext *ctx) {
 }
 
 // Setters for the necessary tree node attributes:
-//   Scope, Type ans IsLValue
+//   Scope, Type, Symbol ans IsLValue
 void TypeCheckListener::putScopeDecor(antlr4::ParserRuleContext *ctx, SymTable::ScopeId s) {
   Decorations.putScope(ctx, s);
 }
 void TypeCheckListener::putTypeDecor(antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t) {
   Decorations.putType(ctx, t);
 }
+void TypeCheckListener::putSymbolDecor(antlr4::ParserRuleContext *ctx, SymTable::SymbolId s) {
+  Decorations.putSymbol(ctx, s);
+}
 void TypeCheckListener::putIsLValueDecor(antlr4::ParserRuleContext *ctx, bool b) {
   Decorations.putIsLValue(ctx, b);
 }
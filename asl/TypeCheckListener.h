@@ -34,6 +34,7 @@
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
+#include "../common/StringPool.h"
 #include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
 
@@ -56,6 +57,7 @@ public:
   // Constructor
   TypeCheckListener(TypesMgr       & Types,
 		    SymTable       & Symbols,
+		    StringPool     & Names,
 		    TreeDecoration & Decorations,
 		    SemErrors      & Errors);
 
@@ -147,6 +149,7 @@ private:
   // Attributes
   TypesMgr       & Types;
   SymTable       & Symbols;
+  StringPool     & Names;
   TreeDecoration & Decorations;
   SemErrors      & Errors;
 
@@ -157,9 +160,10 @@ private:
   bool              getIsLValueDecor (antlr4::ParserRuleContext *ctx);
 
   // Setters for the necessary tree node attributes:
-  //   Scope, Type ans IsLValue
+  //   Scope, Type, Symbol ans IsLValue
   void putScopeDecor    (antlr4::ParserRuleContext *ctx, SymTable::ScopeId s);
   void putTypeDecor     (antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t);
+  void putSymbolDecor   (antlr4::ParserRuleContext *ctx, SymTable::SymbolId s);
   void putIsLValueDecor (antlr4::ParserRuleContext *ctx, bool b);
 
 };  // class TypeCheckListener
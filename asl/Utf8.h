@@ -0,0 +1,59 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    Utf8 - How the bytes of an Asl source are split into code
+//           points, shared by MappedInputStream and AslTokenSource
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>    // std::size_t
+
+// using namespace std;
+
+
+// Number of bytes of the UTF-8 sequence that starts with byte 'c'
+// (1 for bytes that cannot start one)
+inline std::size_t utf8Length(unsigned char c) {
+  if (c < 0x80)         return 1;
+  if ((c >> 5) == 0x6)  return 2;
+  if ((c >> 4) == 0xE)  return 3;
+  if ((c >> 3) == 0x1E) return 4;
+  return 1;
+}
+
+// Number of bytes of the code point at byte 'b' of the 'n' bytes of
+// 'text': the first byte and the continuation bytes (10xxxxxx) that
+// follow it, as many as the first byte announces. Any other byte, a
+// stray continuation byte included, is a code point on its own, and a
+// truncated sequence is one code point with the bytes there are.
+// The character stream and the hand lexer must both split the input
+// this way, so that their indices of code points agree.
+inline std::size_t utf8CodePointLength(const char *text, std::size_t b, std::size_t n) {
+  std::size_t length = utf8Length(static_cast<unsigned char>(text[b])), k = 1;
+  while (k < length and b + k < n and (text[b+k] & 0xC0) == 0x80)
+    ++k;
+  return k;
+}
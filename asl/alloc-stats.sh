@@ -0,0 +1,21 @@
+#!/bin/bash
+#
+# Allocations made by asl per line of source, for each program given
+# (default: the examples). Needs asl built with 'make stats', so that
+# --mem-stats counts the allocations of each phase.
+# Usage: ./alloc-stats.sh [file.asl ...]
+
+if [ $# -eq 0 ]; then
+    set -- ../examples/*.asl
+fi
+
+printf "%-24s %8s %12s %10s\n" program lines allocations per-line
+for f in "$@"; do
+    lines=$(wc -l < "$f")
+    allocs=$(./asl --mem-stats --stats-json "$f" 2>&1 >/dev/null |
+             grep -o '"allocations": [0-9]*' | awk '{ n += $2 } END { print n + 0 }')
+    printf "%-24s %8d %12d %10s\n" $(basename "$f") $lines $allocs \
+           $(awk -v a=$allocs -v l=$lines 'BEGIN { if (l > 0) printf "%.1f", a/l; else print "-" }')
+done |
+awk '{ print } $2 > 0 { lines += $2; allocs += $3 }
+     END { if (lines > 0) printf "%-24s %8d %12d %10.1f\n", "total", lines, allocs, allocs/lines }'
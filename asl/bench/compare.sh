@@ -0,0 +1,51 @@
+#!/bin/bash
+#
+# Compare the time asl spends in one phase with two sets of options
+# (A and B). Every shape of genasl is compiled at a large size with
+# both, and the generated code must be the same. The phase can also
+# be a list (phase1,phase2,...): then their times are added up.
+# Usage: ./compare.sh <phase> "<options A>" "<options B>" [size factor]
+# (see parsing.sh, lexing.sh and walking.sh)
+
+ASL=${ASL:-../asl}
+if [ $# -lt 3 ]; then
+    echo "Usage: ./compare.sh <phase> \"<options A>\" \"<options B>\" [size factor]" >&2
+    exit 1
+fi
+PHASE=$1
+OPTS_A=$2
+OPTS_B=$3
+FACTOR=${4:-1}
+OUT=out
+
+make -s genasl || exit 1
+if [ ! -x "$ASL" ]; then
+    echo "$ASL not found: build asl first" >&2
+    exit 1
+fi
+mkdir -p $OUT
+
+# time of the phase(s), for given options
+phasetime() {
+    $ASL --time-passes "$@" 2>&1 >/dev/null |
+        awk -v p=$PHASE 'BEGIN { n = split(p, ps, ","); for (i = 1; i <= n; ++i) want[ps[i]] = 1 }
+                         $1 in want { t += $2; found = 1 }
+                         END { if (found) print t }'
+}
+
+echo "time in $PHASE (ms), A: ${OPTS_A:-default}, B: ${OPTS_B:-default}"
+printf "%-12s %8s %14s %14s %8s\n" shape size "A" "B" speedup
+for spec in functions:8000 nesting:2000 statements:40000 arrays:80000 params:2000; do
+    shape=${spec%:*}
+    n=$((${spec#*:} * FACTOR))
+    ./genasl $shape $n > $OUT/$shape.asl || exit 1
+    $ASL $OPTS_A $OUT/$shape.asl > $OUT/$shape.a.t
+    $ASL $OPTS_B $OUT/$shape.asl > $OUT/$shape.b.t
+    if ! cmp -s $OUT/$shape.a.t $OUT/$shape.b.t; then
+        echo "$shape $n: different output with A and B" >&2
+    fi
+    ta=$(phasetime $OPTS_A -o /dev/null $OUT/$shape.asl)
+    tb=$(phasetime $OPTS_B -o /dev/null $OUT/$shape.asl)
+    printf "%-12s %8s %14s %14s %8s\n" $shape $n "$ta" "$tb" \
+           $(awk -v a="$ta" -v b="$tb" 'BEGIN { if (b > 0) printf "%.2fx", a/b; else print "-" }')
+done
@@ -0,0 +1,269 @@
+/////////////////////////////////////////////////////////////////
+//
+//    genasl - Generator of large Asl programs, to measure how the
+//             compiler scales with the size of its input
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+// Writes on std::cout a valid Asl program (it passes the type
+// check, and it terminates when run) of one of these shapes, where
+// <n> gives its size:
+//   functions   <n> functions, each one calling the previous one
+//   nesting     expressions <n> levels deep, with and without parenthesis
+//   statements  a main with <n> statements of every kind
+//   arrays      arrays of <n> elements of every basic type
+//   params      functions with <n> parameters, and calls to them
+// The same shape, size and seed always give the same program.
+
+#include <iostream>
+#include <string>
+#include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS, strtoul
+
+
+namespace {
+
+  // small deterministic pseudo-random generator (an LCG), so that
+  // programs do not depend on the C library
+  unsigned long state = 1;
+
+  unsigned int rnd(unsigned int n) {
+    state = state * 6364136223846793005UL + 1442695040888963407UL;
+    return (state >> 33) % n;
+  }
+
+  std::string str(unsigned long n) {
+    return std::to_string(n);
+  }
+
+  // <n> functions f0..f<n-1>; each one has its own local vars and
+  // calls the previous one, so the call chain is <n> levels deep
+  void functions(unsigned long n) {
+    for (unsigned long i = 0; i < n; ++i) {
+      std::cout << "func f" << i << "(x:int, y:float): int\n"
+                << "  var a" << i << ", b" << i << ":int\n"
+                << "  var c" << i << ":bool\n"
+                << "  a" << i << " = x * " << rnd(10) + 1 << " + " << rnd(100) << ";\n"
+                << "  b" << i << " = a" << i << " % " << rnd(10) + 2 << ";\n"
+                << "  c" << i << " = a" << i << " > b" << i << " and y < " << rnd(100) << ".5;\n"
+                << "  if c" << i << " then\n"
+                << "    a" << i << " = a" << i << " - b" << i << ";\n"
+                << "  endif\n";
+      if (i == 0)
+        std::cout << "  return a0;\n";
+      else
+        std::cout << "  return f" << i-1 << "(x - 1, y + 1.0) + b" << i << ";\n";
+      std::cout << "endfunc\n\n";
+    }
+    std::cout << "func main()\n"
+              << "  write f" << (n ? n-1 : 0) << "(" << n << ", 0.5);\n"
+              << "  write \"\\n\";\n"
+              << "endfunc\n";
+  }
+
+  // an int expression <depth> levels deep: (((x op k) op k) op k)...
+  std::string nested(unsigned long depth) {
+    const char * ops[] = {" + ", " - ", " * "};
+    std::string e = "x";
+    for (unsigned long i = 0; i < depth; ++i)
+      e = "(" + e + ops[rnd(3)] + str(rnd(9) + 1) + ")";
+    return e;
+  }
+
+  // expressions <n> levels deep: nested parenthesis, and long chains
+  // of operators (left-recursive in the grammar, so just as deep)
+  void nesting(unsigned long n) {
+    std::cout << "func main()\n"
+              << "  var x, y:int\n"
+              << "  var b:bool\n"
+              << "  x = 1;\n"
+              << "  y = " << nested(n) << ";\n"
+              << "  write y; write \"\\n\";\n"
+              << "  y = x";
+    for (unsigned long i = 0; i < n; ++i)
+      std::cout << (rnd(2) ? " + " : " - ") << rnd(100);
+    std::cout << ";\n"
+              << "  write y; write \"\\n\";\n"
+              << "  b = x < 0";
+    for (unsigned long i = 0; i < n; ++i) {
+      if (rnd(2)) std::cout << " or x == " << rnd(100);
+      else        std::cout << " and not (y == " << rnd(100) << ")";
+    }
+    std::cout << ";\n"
+              << "  write b; write \"\\n\";\n"
+              << "endfunc\n";
+  }
+
+  // one random statement of a long statement list (all loops end)
+  void statement(unsigned int indent) {
+    std::string sp(indent, ' ');
+    unsigned int k = rnd(1000);
+    switch (rnd(8)) {
+    case 0:
+      std::cout << sp << "a = b + c * " << k << ";\n";
+      break;
+    case 1:
+      std::cout << sp << "b = (a - " << k << ") % 7 + c;\n";
+      break;
+    case 2:
+      std::cout << sp << "if a < b then\n"
+                << sp << "  c = c + 1;\n"
+                << sp << "else\n"
+                << sp << "  c = c - 1;\n"
+                << sp << "endif\n";
+      break;
+    case 3:
+      std::cout << sp << "v[" << k % 16 << "] = a + v[" << (k+1) % 16 << "];\n";
+      break;
+    case 4:
+      std::cout << sp << "f = f + a * 0.5;\n";
+      break;
+    case 5:
+      std::cout << sp << "p = a == b or not p;\n";
+      break;
+    case 6:
+      std::cout << sp << "while c > " << k << " do\n"
+                << sp << "  c = c - 3;\n"
+                << sp << "endwhile\n";
+      break;
+    default:
+      std::cout << sp << "ch = 'x';\n";
+      break;
+    }
+  }
+
+  // a main with <n> statements
+  void statements(unsigned long n) {
+    std::cout << "func main()\n"
+              << "  var a, b, c:int\n"
+              << "  var f:float\n"
+              << "  var p:bool\n"
+              << "  var ch:char\n"
+              << "  var v:array[16] of int\n"
+              << "  var i:int\n"
+              << "  a = 1; b = 2; c = 3; f = 0.0; p = true;\n"
+              << "  i = 0;\n"
+              << "  while i < 16 do\n"
+              << "    v[i] = i;\n"
+              << "    i = i + 1;\n"
+              << "  endwhile\n";
+    for (unsigned long i = 0; i < n; ++i)
+      statement(2);
+    std::cout << "  write a; write \" \"; write b; write \" \"; write c; write \"\\n\";\n"
+              << "endfunc\n";
+  }
+
+  // arrays of <n> elements of every basic type, filled and added up,
+  // also through array parameters
+  void arrays(unsigned long n) {
+    std::string sz = str(n ? n : 1);
+    std::cout << "func sum(v:array[" << sz << "] of int): int\n"
+              << "  var i, s:int\n"
+              << "  i = 0; s = 0;\n"
+              << "  while i < " << sz << " do\n"
+              << "    s = s + v[i];\n"
+              << "    i = i + 1;\n"
+              << "  endwhile\n"
+              << "  return s;\n"
+              << "endfunc\n\n"
+              << "func main()\n"
+              << "  var vi, wi:array[" << sz << "] of int\n"
+              << "  var vf:array[" << sz << "] of float\n"
+              << "  var vb:array[" << sz << "] of bool\n"
+              << "  var vc:array[" << sz << "] of char\n"
+              << "  var i:int\n"
+              << "  var f:float\n"
+              << "  i = 0;\n"
+              << "  while i < " << sz << " do\n"
+              << "    vi[i] = i % 10;\n"
+              << "    vf[i] = i * 0.5;\n"
+              << "    vb[i] = i % 2 == 0;\n"
+              << "    vc[i] = 'a';\n"
+              << "    i = i + 1;\n"
+              << "  endwhile\n"
+              << "  wi = vi;\n"
+              << "  f = vf[" << sz << " - 1];\n"
+              << "  write sum(wi); write \" \"; write f; write \" \";\n"
+              << "  write vb[0]; write vc[" << sz << " - 1]; write \"\\n\";\n"
+              << "endfunc\n";
+  }
+
+  // functions with <n> params of every basic type, and calls to them
+  void params(unsigned long n) {
+    const char * types[] = {"int", "float", "bool", "char"};
+    const char * values[] = {"1", "2.5", "true", "'c'"};
+    for (unsigned int f = 0; f < 4; ++f) {
+      std::cout << "func g" << f << "(";
+      for (unsigned long i = 0; i < n; ++i)
+        std::cout << (i ? ", " : "") << "p" << i << ":" << types[(i + f) % 4];
+      std::cout << "): int\n"
+                << "  var s:int\n"
+                << "  s = 0;\n";
+      for (unsigned long i = 0; i < n; ++i)
+        if ((i + f) % 4 == 0)
+          std::cout << "  s = s + p" << i << ";\n";
+      std::cout << "  return s;\n"
+                << "endfunc\n\n";
+    }
+    std::cout << "func main()\n"
+              << "  var s:int\n"
+              << "  s = 0;\n";
+    for (unsigned int f = 0; f < 4; ++f) {
+      std::cout << "  s = s + g" << f << "(";
+      for (unsigned long i = 0; i < n; ++i)
+        std::cout << (i ? ", " : "") << values[(i + f) % 4];
+      std::cout << ");\n";
+    }
+    std::cout << "  write s; write \"\\n\";\n"
+              << "endfunc\n";
+  }
+
+  void usage() {
+    std::cerr << "Usage: ./genasl functions|nesting|statements|arrays|params <n> [<seed>]" << std::endl;
+  }
+
+}
+
+
+int main(int argc, const char* argv[]) {
+  if (argc < 3 or argc > 4) {
+    usage();
+    return EXIT_FAILURE;
+  }
+  std::string shape = argv[1];
+  unsigned long n = std::strtoul(argv[2], nullptr, 10);
+  if (argc == 4) state = std::strtoul(argv[3], nullptr, 10);
+
+  std::ios::sync_with_stdio(false);
+  if (shape == "functions")       functions(n);
+  else if (shape == "nesting")    nesting(n);
+  else if (shape == "statements") statements(n);
+  else if (shape == "arrays")     arrays(n);
+  else if (shape == "params")     params(n);
+  else {
+    usage();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
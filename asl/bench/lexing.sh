@@ -0,0 +1,15 @@
+#!/bin/bash
+#
+# Time in the lexer with AslLexer, generated by antlr4 (A), and with
+# the hand-written AslTokenSource (B). The output (code or errors) for
+# every program in ../../examples must also be the same with both.
+# Usage: ./lexing.sh [size factor]
+
+ASL=${ASL:-../asl}
+for f in ../../examples/*.asl; do
+    if ! cmp -s <($ASL "$f" 2>&1) <($ASL --fast-lexer "$f" 2>&1); then
+        echo "$(basename "$f"): different output with --fast-lexer" >&2
+    fi
+done
+
+exec ./compare.sh lexer "" "--fast-lexer" "$@"
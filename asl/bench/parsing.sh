@@ -0,0 +1,7 @@
+#!/bin/bash
+#
+# Time in the parser with full LL prediction only (A), and with the
+# two-stage parse, SLL first and LL only if needed (B)
+# Usage: ./parsing.sh [size factor]
+
+exec ./compare.sh parser "--ll-only" "" "$@"
@@ -0,0 +1,63 @@
+#!/bin/bash
+#
+# Measure how asl scales with the size of its input: for every shape
+# of genasl, compile programs of doubling size and record the time and
+# peak RSS of each phase (asl --time-passes --mem-stats).
+#   - the table shows, for each size, the total time and memory, and
+#     how much they grew since the previous (half as large) size:
+#     about 2x is linear, 4x is quadratic. Growths above $LIMIT are
+#     marked with '!'
+#   - all the measures, per phase, are written to out/scaling.csv
+# Usage: ./scaling.sh [shape ...]    (all shapes by default)
+# Sizes can be changed with SIZES_<shape>="n1 n2 ..." in the environment.
+
+ASL=${ASL:-../asl}
+LIMIT=${LIMIT:-3.0}
+OUT=out
+
+SIZES_functions=${SIZES_functions:-"1000 2000 4000 8000 16000"}
+SIZES_nesting=${SIZES_nesting:-"250 500 1000 2000 4000"}
+SIZES_statements=${SIZES_statements:-"5000 10000 20000 40000 80000"}
+SIZES_arrays=${SIZES_arrays:-"10000 20000 40000 80000 160000"}
+SIZES_params=${SIZES_params:-"250 500 1000 2000 4000"}
+
+SHAPES=${*:-"functions nesting statements arrays params"}
+
+make -s genasl || exit 1
+if [ ! -x "$ASL" ]; then
+    echo "$ASL not found: build asl first" >&2
+    exit 1
+fi
+mkdir -p $OUT
+echo "shape,size,phase,wall_ms,cpu_ms,peak_rss_kb" > $OUT/scaling.csv
+
+# growth of $2 over $1, marked if above $LIMIT
+growth() {
+    awk -v a="$1" -v b="$2" -v l="$LIMIT" \
+        'BEGIN { if (a == "" || a <= 0) print "-"; else printf "%.2fx%s", b/a, (b/a > l ? "!" : "") }'
+}
+
+printf "%-12s %8s %12s %8s %14s %8s\n" shape size "time (ms)" growth "peak RSS (KB)" growth
+for shape in $SHAPES; do
+    sizes=SIZES_$shape
+    prevTime=""; prevRSS=""
+    for n in ${!sizes}; do
+        ./genasl $shape $n > $OUT/$shape.asl || exit 1
+        if ! $ASL --time-passes --mem-stats -o $OUT/$shape.t $OUT/$shape.asl > $OUT/$shape.log 2> $OUT/$shape.stats; then
+            echo "$shape $n: asl failed (see $OUT/$shape.log)" >&2
+            continue
+        fi
+        # rows of the phase table: phase wall cpu rss
+        awk -v s=$shape -v n=$n '
+            /^=== Compiler phases/ { on = 1; next }
+            /^$/                   { on = 0 }
+            on && NF == 4 && $1 != "phase" { printf "%s,%s,%s,%s,%s,%s\n", s, n, $1, $2, $3, $4 }
+        ' $OUT/$shape.stats >> $OUT/scaling.csv
+        time=$(awk '/^  total/ { print $2 }' $OUT/$shape.stats)
+        rss=$(awk '/^=== Compiler phases/ { on = 1; next } /^$/ { on = 0 }
+                   on && NF == 4 && $1 != "phase" { r = $4 } END { print r }' $OUT/$shape.stats)
+        printf "%-12s %8s %12s %8s %14s %8s\n" $shape $n $time "$(growth "$prevTime" $time)" \
+               $rss "$(growth "$prevRSS" $rss)"
+        prevTime=$time; prevRSS=$rss
+    done
+done
@@ -0,0 +1,17 @@
+#!/bin/bash
+#
+# Time in the walks of the parse tree with the three listeners, one
+# after the other (A), and with the declarations taken from the
+# function headers and a single walk of PipelineListener (B). The
+# output (code or errors) for every program in ../../examples must
+# also be the same with both.
+# Usage: ./walking.sh [size factor]
+
+ASL=${ASL:-../asl}
+for f in ../../examples/*.asl; do
+    if ! cmp -s <($ASL "$f" 2>&1) <($ASL --pipeline "$f" 2>&1); then
+        echo "$(basename "$f"): different output with --pipeline" >&2
+    fi
+done
+
+exec ./compare.sh symbols,typecheck,codegen,pipeline "" "--pipeline" "$@"
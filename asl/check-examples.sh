@@ -60,3 +60,95 @@ echo "END   examples-initial/execution"
 #     rm -f tmp.t tmp.out
 # done
 # echo "END   examples-full/execution"
+
+echo ""
+echo "BEGIN examples-initial/execution (vm)"
+for f in ../examples/jpbasic_genc_*.asl; do
+    echo $(basename "$f")
+    ./asl "$f" > tmp.t
+    ../vm/vm tmp.t < "${f/asl/in}" > tmp.out
+    diff tmp.out "${f/asl/out}"
+    rm -f tmp.t tmp.out
+done
+echo "END   examples-initial/execution (vm)"
+
+echo ""
+echo "BEGIN examples/pipeline"
+for f in ../examples/jp*_chkt_*.asl ../examples/jp*_genc_*.asl; do
+    echo $(basename "$f")
+    ./asl "$f" > tmp.t
+    ./asl --pipeline "$f" > tmp.pipeline.t
+    diff tmp.pipeline.t tmp.t
+    rm -f tmp.t tmp.pipeline.t
+done
+echo "END   examples/pipeline"
+
+echo ""
+echo "BEGIN examples/fast-lexer"
+for f in ../examples/jp*_chkt_*.asl ../examples/jp*_genc_*.asl; do
+    echo $(basename "$f")
+    ./asl "$f" > tmp.t
+    ./asl --fast-lexer "$f" > tmp.fast.t
+    diff tmp.fast.t tmp.t
+    rm -f tmp.t tmp.fast.t
+done
+echo "END   examples/fast-lexer"
+
+echo ""
+echo "BEGIN examples/batch"
+rm -rf tmp.batch
+mkdir tmp.batch
+cp ../examples/jp*_genc_*.asl tmp.batch
+./asl --batch -j 4 tmp.batch/*.asl
+for f in ../examples/jp*_genc_*.asl; do
+    echo $(basename "$f")
+    ./asl "$f" > tmp.t
+    diff "tmp.batch/$(basename "${f%.asl}").t" tmp.t
+    rm -f tmp.t
+done
+rm -rf tmp.batch
+echo "END   examples/batch"
+
+# a client of asl --serve: sends a FILE request for each file given, and
+# writes the messages and the t-code of each answer to tmp.<n>.serve
+cat > tmp.client.py <<'CLIENT'
+import os, socket, sys
+client = socket.socket(socket.AF_UNIX)
+client.connect(sys.argv[1])
+conn = client.makefile('rwb')
+for n, path in enumerate(sys.argv[2:]):
+    conn.write(b'FILE ' + os.path.abspath(path).encode() + b'\n')
+    conn.flush()
+    status, m, k = conn.readline().split()
+    with open('tmp.%d.serve' % n, 'wb') as out:
+        out.write(conn.read(int(m) + int(k)))
+CLIENT
+
+echo ""
+echo "BEGIN examples/serve"
+files=(../examples/jp*_chkt_*.asl ../examples/jp*_genc_*.asl)
+./asl --serve tmp.sock -j 4 &
+server=$!
+while [ ! -S tmp.sock ]; do sleep 0.1; done
+python3 tmp.client.py tmp.sock "${files[@]}"
+kill $server
+for n in "${!files[@]}"; do
+    f=${files[$n]}
+    echo $(basename "$f")
+    ./asl "$f" > tmp.t
+    diff tmp.$n.serve tmp.t
+    rm -f tmp.t tmp.$n.serve
+done
+rm -f tmp.sock tmp.client.py
+echo "END   examples/serve"
+
+echo ""
+echo "BEGIN examples/optimizer (tvm)"
+for f in ../examples/jp*_genc_*.asl; do
+    echo $(basename "$f")
+    ./asl -O "$f" > tmp.t
+    ../tvm/tvm tmp.t < "${f/asl/in}" > tmp.out
+    diff tmp.out "${f/asl/out}"
+    rm -f tmp.t tmp.out
+done
+echo "END   examples/optimizer (tvm)"
@@ -33,63 +33,228 @@
 #include "antlr4-runtime.h"
 #include "AslLexer.h"
 #include "AslParser.h"
+#include "AslTokenSource.h"
+#include "MappedInputStream.h"
 #include "tree/ParseTreeWalker.h"
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
+#include "../common/StringPool.h"
 #include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
 #include "SymbolsListener.h"
 #include "TypeCheckListener.h"
 #include "../common/code.h"
+#include "../common/tbc.h"
+#include "../common/optimizer.h"
+#include "../common/PhaseStats.h"
 #include "CodeGenListener.h"
+#include "PipelineListener.h"
 
 #include <iostream>
-#include <fstream>    // ifstream
+#include <fstream>    // ofstream
+#include <string>
+#include <vector>
+#include <memory>     // unique_ptr
+#include <sstream>    // ostringstream
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <system_error>
+#include <atomic>
+#include <chrono>
 
-#include <cstdio>     // fopen
-#include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS
+#include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS, atoi, _Exit
+#include <cstring>    // memset, strcpy, strlen
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h> // lstat
+#include <unistd.h>   // close, unlink
 
 // using namespace std;
 // using namespace antlr4;
 
 
-int main(int argc, const char* argv[]) {
-  // check the correct use of the program
-  if (argc > 2) {
-    std::cout << "Usage: ./main [<file>]" << std::endl;
-    return EXIT_FAILURE;
+// size of the buffer used to write the generated code to a file
+static const std::size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+
+// options of a compilation
+struct Options {
+  bool timePasses = false;         // report time of each phase
+  bool memStats   = false;         // report memory and counts of each phase
+  bool statsJSON  = false;         // ... as a JSON object instead of a table
+  bool llOnly     = false;         // parse only with full LL prediction (slower)
+  bool fastLexer  = false;         // use AslTokenSource instead of AslLexer
+  bool pipeline   = false;         // type check and generate code in one walk
+  bool optimize   = false;         // run the optimizer on the generated code
+};
+
+// lexical and syntactical errors written to a stream, as
+// antlr4::ConsoleErrorListener writes them to std::cerr
+class StreamErrorListener : public antlr4::BaseErrorListener {
+public:
+  StreamErrorListener(std::ostream &os) : os(os) { }
+  void syntaxError(antlr4::Recognizer *recognizer, antlr4::Token *offendingSymbol,
+                   size_t line, size_t charPositionInLine,
+                   const std::string &msg, std::exception_ptr e) override {
+    os << "line " << line << ":" << charPositionInLine << " " << msg << std::endl;
   }
-  if (argc == 2 and not std::fopen(argv[1], "r")) {
-    std::cout << "No such file: " << argv[1] << std::endl;
-    return EXIT_FAILURE;
+private:
+  std::ostream &os;
+};
+
+// number of nodes of a parse tree (iterative: trees can be deep)
+static std::size_t countNodes(antlr4::tree::ParseTree *tree) {
+  std::size_t n = 0;
+  std::vector<antlr4::tree::ParseTree *> pending(1, tree);
+  while (not pending.empty()) {
+    antlr4::tree::ParseTree *node = pending.back();
+    pending.pop_back();
+    ++n;
+    pending.insert(pending.end(), node->children.begin(), node->children.end());
   }
+  return n;
+}
 
-  // open input file (or std::cin) and create a character stream
-  antlr4::ANTLRInputStream input;
-  if (argc == 2) {  // reads from <file>
-    std::ifstream stream;
-    stream.open(argv[1]);
-    input = antlr4::ANTLRInputStream(stream);
+// intern the text of every identifier token in 'names', taking it
+// straight from the bytes of the input, and remember the name of each
+// token by its index: the listeners get it from there, instead of
+// making a new std::string each time they look at an ID
+static void internIdentifiers(antlr4::BufferedTokenStream &tokens,
+                              const MappedInputStream &input, StringPool &names) {
+  for (antlr4::Token *t : tokens.getTokens()) {
+    if (t->getType() != AslLexer::ID)
+      continue;
+    std::size_t begin = input.offset(t->getStartIndex());
+    std::size_t end   = input.offset(t->getStopIndex() + 1);
+    names.putTokenName(t->getTokenIndex(), names.intern(input.bytes() + begin, end - begin));
   }
-  else {            // reads fron std::cin
-    input = antlr4::ANTLRInputStream(std::cin);
+}
+
+// parse the whole program. Unless 'llOnly', it is parsed first with
+// SLL prediction, which is much faster but gives up at the first
+// syntax error (without reporting it). Only then is the program
+// parsed again from the start with full LL prediction, which gives
+// the same tree and the same error messages (to 'syntaxErrors') as if
+// it were the only parse. 'reparsed' tells whether the second parse
+// was needed.
+static antlr4::tree::ParseTree * parse(AslParser &parser, antlr4::CommonTokenStream &tokens,
+                                       antlr4::ANTLRErrorListener &syntaxErrors,
+                                       bool llOnly, bool &reparsed) {
+  reparsed = false;
+  auto interpreter = parser.getInterpreter<antlr4::atn::ParserATNSimulator>();
+  if (not llOnly) {
+    interpreter->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+    parser.removeErrorListeners();
+    parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+    try {
+      return parser.program();
+    }
+    catch (antlr4::ParseCancellationException &) {
+      // not an SLL program, or not a program at all
+    }
+    reparsed = true;
+    tokens.reset();
+    parser.reset();
+    parser.addErrorListener(&syntaxErrors);
+    parser.setErrorHandler(std::make_shared<antlr4::DefaultErrorStrategy>());
   }
+  interpreter->setPredictionMode(antlr4::atn::PredictionMode::LL);
+  return parser.program();
+}
+
+
+// streams of a compilation
+struct Streams {
+  std::istream               &in;            // source, if there is no input file
+  std::ostream               &out;           // code, if there is no output file
+  std::ostream               &msgs;          // messages and semantic errors
+  antlr4::ANTLRErrorListener &syntaxErrors;  // lexical and syntactical errors
+  std::ostream               &log;           // report of the phases (if asked for)
+};
+
+// compile the program in 'inFile' (io.in if null) and write its code
+// to 'outFile' (io.out if null). Returns the exit status.
+static int compile(const char *inFile, const char *outFile, const Options &opts,
+                   const Streams &io) {
+  std::ostream &msgs = io.msgs;
+  antlr4::ANTLRErrorListener &syntaxErrors = io.syntaxErrors;
+  // cost of each phase, reported (if asked for) when the compiler ends
+  PhaseStats stats;
+  auto report = [&]() {
+    stats.stop();
+    if (not opts.timePasses and not opts.memStats) return;
+    if (opts.statsJSON) stats.printJSON(io.log, opts.timePasses, opts.memStats);
+    else                stats.print(io.log, opts.timePasses, opts.memStats);
+  };
+
+  // create a character stream over the input file (mapped in memory)
+  // or io.in (read all at once)
+  stats.start("input");
+  MappedInputStream input;
+  if (inFile and not input.open(inFile)) {
+    msgs << "No such file: " << inFile << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (not inFile and not input.read(io.in)) {
+    msgs << "Cannot read the input" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  stats.count("characters", input.size());
 
   // create a lexer that consumes the character stream and produce a token stream
+  stats.start("lexer");
   AslLexer lexer(&input);
+  lexer.removeErrorListeners();
+  lexer.addErrorListener(&syntaxErrors);
   antlr4::CommonTokenStream tokens(&lexer);
+  // with --fast-lexer, the input is lexed by hand. If it finds some
+  // lexical error, AslLexer lexes it again, to report the errors.
+  std::unique_ptr<AslTokenSource> handLexer;
+  if (opts.fastLexer) {
+    handLexer.reset(new AslTokenSource(&input, lexer.getVocabulary()));
+    tokens.setTokenSource(handLexer.get());
+  }
+  // read all the tokens now (the parser would do it on demand)
+  tokens.fill();
+  bool relexed = handLexer and handLexer->failed();
+  if (relexed) {
+    tokens.setTokenSource(&lexer);
+    tokens.fill();
+  }
+  stats.count("tokens", tokens.size());
+  stats.count("AslLexer runs", not opts.fastLexer or relexed);
+
+  // the code we will be creating. Its pool holds the names of the
+  // identifiers, shared by the symbol table and the listeners (and
+  // then by the operands of the code)
+  code mycode;
+  stats.start("names");
+  StringPool & names = mycode.get_pool();
+  internIdentifiers(tokens, input, names);
+  stats.count("identifiers", names.size());
 
   // create a parser that consumes the token stream, and parses it.
+  stats.start("parser");
   AslParser parser(&tokens);
+  parser.removeErrorListeners();
+  parser.addErrorListener(&syntaxErrors);
 
   // call the parser and get the parse tree
-  antlr4::tree::ParseTree *tree = parser.program();
+  bool reparsed;
+  antlr4::tree::ParseTree *tree = parse(parser, tokens, syntaxErrors, opts.llOnly, reparsed);
+  stats.count("LL parses", opts.llOnly or reparsed);
+  if (opts.memStats) stats.count("parse-tree nodes", countNodes(tree));
 
   // check for lexical or syntactical errors
   if (lexer.getNumberOfSyntaxErrors() > 0 or
       parser.getNumberOfSyntaxErrors() > 0) {
-    std::cout << "Lexical and/or syntactical errors have been found." << std::endl;
+    msgs << "Lexical and/or syntactical errors have been found." << std::endl;
+    report();
     return EXIT_FAILURE;
   }
 
@@ -103,36 +268,523 @@ int main(int argc, const char* argv[]) {
   // Auxililary classes we are going to need to store information while
   // traversing the tree. They are described below in this document
   TypesMgr       types;
-  SymTable       symbols(types);
+  SymTable       symbols(types, names);
   TreeDecoration decorations;
-  SemErrors      errors;
+  SemErrors      errors(msgs);
 
   // Create a Listener that looks for variables and function declarations in the tree
   // and stores required information
-  SymbolsListener symboldecl(types, symbols, decorations, errors);
-  // Traverse the tree using this listener, to collect information about declared identifiers
-  walker.walk(&symboldecl, tree);
-
+  SymbolsListener symboldecl(types, symbols, names, decorations, errors);
   // Create another Listener that will perform type checkings wherever it is needed
   // (on expressions, assignments, parameter passing, etc)
-  TypeCheckListener typecheck(types, symbols, decorations, errors);
-  // Traverse the tree using this listener, so all types are checked
-  walker.walk(&typecheck, tree);
+  TypeCheckListener typecheck(types, symbols, names, decorations, errors);
+  // Create a third listener that will generate code for each part of the tree
+  CodeGenListener codegenerator(types, symbols, names, decorations, mycode);
 
-  if (errors.getNumberOfSemanticErrors() > 0) {
-    //std::cout << "There are semantic errors: no code generated." << std::endl;
-    return EXIT_FAILURE;
+  if (not opts.pipeline) {
+    // Traverse the tree using the first listener, to collect information about declared identifiers
+    stats.start("symbols");
+    walker.walk(&symboldecl, tree);
+    stats.count("decorations", decorations.getNumberOfEntries());
+    stats.count("types", types.getNumberOfTypes());
+    stats.count("scopes", symbols.getNumberOfScopes());
+    stats.count("symbols", symbols.getNumberOfSymbols());
+
+    // Traverse the tree using the second listener, so all types are checked
+    stats.start("typecheck");
+    walker.walk(&typecheck, tree);
+    stats.count("decorations", decorations.getNumberOfEntries());
+    stats.count("types", types.getNumberOfTypes());
+    stats.count("semantic errors", errors.getNumberOfSemanticErrors());
+
+    if (errors.getNumberOfSemanticErrors() > 0) {
+      //std::cout << "There are semantic errors: no code generated." << std::endl;
+      report();
+      return EXIT_FAILURE;
+    }
+
+    // Traverse the tree using the third listener, so code is generated and stored in 'mycode'
+    stats.start("codegen");
+    walker.walk(&codegenerator, tree);
+    stats.count("decorations", decorations.getNumberOfEntries());
   }
+  else {
+    // With --pipeline, the declarations are collected from the headers of
+    // the functions, and then the three listeners above are driven by a
+    // single walk of the tree (freeing the decorations of each function
+    // as soon as its code is generated)
+    PipelineListener fused(symboldecl, typecheck, codegenerator, decorations, errors);
+    stats.start("symbols");
+    fused.declare(static_cast<AslParser::ProgramContext *>(tree));
+    stats.count("decorations", decorations.getNumberOfEntries());
+    stats.count("types", types.getNumberOfTypes());
+    stats.count("scopes", symbols.getNumberOfScopes());
+    stats.count("symbols", symbols.getNumberOfSymbols());
 
-  // Auxiliary class to store the code we will be creating
-  code mycode;
-  // Create a third listener that will generate code for each part of the tree
-  CodeGenListener codegenerator(types, symbols, decorations, mycode);
-  // Traverse the tree using this listener, so code is generated and stored in 'mycode'
-  walker.walk(&codegenerator, tree);
+    stats.start("pipeline");
+    walker.walk(&fused, tree);
+    stats.count("max. decorations", fused.getMaxNumberOfEntries());
+    stats.count("types", types.getNumberOfTypes());
+    stats.count("semantic errors", errors.getNumberOfSemanticErrors());
 
-  // print generated code as output
-  std::cout << mycode.dump() << std::endl;
+    if (errors.getNumberOfSemanticErrors() > 0) {
+      report();
+      return EXIT_FAILURE;
+    }
+  }
 
+  // with -O, the code of each subroutine goes through the optimizer
+  std::vector<optimizer::counts> optimized;
+  if (opts.optimize) {
+    stats.start("optimizer");
+    optimizer::counts done;
+    for (auto & s : mycode.get_subroutines()) {
+      optimized.push_back(optimizer::counts());
+      optimizer::optimize(s, mycode.get_pool(), optimized.back());
+      done += optimized.back();
+    }
+    stats.count("constants folded", done.constantsFolded);
+    stats.count("branches folded", done.branchesFolded);
+    stats.count("loads removed", done.loadsRemoved);
+    stats.count("values reused", done.valuesReused);
+    stats.count("moves removed", done.movesRemoved);
+    stats.count("unreachable removed", done.unreachableRemoved);
+    stats.count("jumps removed", done.jumpsRemoved);
+    stats.count("labels removed", done.labelsRemoved);
+    stats.count("dead stores removed", done.deadStoresRemoved);
+  }
+
+  std::size_t numInstructions = 0;
+  for (std::size_t k = 0; k < mycode.get_subroutines().size(); ++k) {
+    const subroutine &s = mycode.get_subroutines()[k];
+    numInstructions += s.get_instructions().size();
+    stats.countSubroutine(s.get_name(), s.get_instructions().size());
+    if (opts.optimize) stats.countInSubroutine("moves removed", optimized[k].movesRemoved);
+  }
+  stats.count("subroutines", mycode.get_subroutines().size());
+  stats.count("instructions", numInstructions);
+
+  // write generated code as output, streaming it instruction by
+  // instruction (to <output> through a single large buffer if given).
+  // An <output> ending in ".tbc" gets binary t-code instead of text.
+  stats.start("output");
+  if (outFile) {
+    std::string outName = outFile;
+    bool binary = outName.size() > 4 and outName.compare(outName.size()-4, 4, ".tbc") == 0;
+    std::vector<char> buffer(OUTPUT_BUFFER_SIZE);
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+    out.open(outFile, binary ? std::ios::out | std::ios::binary : std::ios::out);
+    if (not out) {
+      msgs << "Cannot write file: " << outFile << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (binary)
+      tbc::write(mycode, out);
+    else {
+      mycode.emit(out);
+      out << std::endl;
+    }
+    // the last of the buffer is written (and may fail) when closing it
+    out.close();
+    if (not out) {
+      msgs << "Cannot write file: " << outFile << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  else {
+    mycode.emit(io.out);
+    io.out << std::endl;
+    if (not io.out) {
+      msgs << "Cannot write the output" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  report();
   return EXIT_SUCCESS;
 }
+
+// name of the output of 'file' in batch mode: the same name, with its
+// ".asl" extension (if any) replaced by ".t"
+static std::string batchOutput(const std::string &file) {
+  std::string base = file;
+  if (base.size() > 4 and base.compare(base.size()-4, 4, ".asl") == 0)
+    base.resize(base.size()-4);
+  return base + ".t";
+}
+
+// compile all the 'files' on 'jobs' threads, each one on its own, and
+// write the code of each file next to it. The messages and reports of
+// a file are kept until it has been compiled, and then written at once
+// (after a line with its name), so those of different files are never
+// mixed. A file that makes the compiler fail (e.g. with bad_alloc) is
+// reported as failed, and the batch goes on. All the compilations
+// share the ATN and the DFA caches of the lexer and the parser (static
+// in AslLexer and AslParser), so they are built once for the whole
+// batch. Returns the exit status: failure if any file failed.
+static int compileBatch(const std::vector<const char *> &files, unsigned jobs,
+                        const Options &opts) {
+  std::atomic<std::size_t> next(0);
+  std::atomic<bool> failed(false);
+  std::mutex outputLock;
+  auto worker = [&]() {
+    for (std::size_t i = next++; i < files.size(); i = next++) {
+      std::ostringstream msgs, log;
+      StreamErrorListener syntaxErrors(msgs);
+      std::string outName = batchOutput(files[i]);
+      int status;
+      try {
+        status = compile(files[i], outName.c_str(), opts,
+                         Streams{std::cin, std::cout, msgs, syntaxErrors, log});
+      }
+      catch (std::exception &e) {
+        msgs << "Internal error: " << e.what() << std::endl;
+        status = EXIT_FAILURE;
+      }
+      catch (...) {
+        msgs << "Internal error" << std::endl;
+        status = EXIT_FAILURE;
+      }
+      if (status != EXIT_SUCCESS)
+        failed = true;
+      std::lock_guard<std::mutex> lock(outputLock);
+      if (msgs.tellp() > 0) std::cout << files[i] << ":\n" << msgs.str() << std::flush;
+      if (log.tellp() > 0)  std::cerr << files[i] << ":\n" << log.str() << std::flush;
+    }
+  };
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < jobs and t < files.size(); ++t)
+    pool.emplace_back(worker);
+  worker();
+  for (auto &t : pool)
+    t.join();
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// largest source accepted by a SOURCE request of the compile server
+static const std::size_t MAX_SOURCE_SIZE = 16 << 20;
+
+// A connection of the compile server: reads lines and blocks of bytes
+// from a socket, through a buffer
+class Connection {
+public:
+  Connection(int fd) : fd(fd) { }
+  ~Connection() { close(fd); }
+  // read a line (without its '\n'). False at the end of the input.
+  bool readLine(std::string &line) {
+    std::size_t eol;
+    while ((eol = buffer.find('\n')) == std::string::npos)
+      if (not fill()) return false;
+    line.assign(buffer, 0, eol);
+    buffer.erase(0, eol + 1);
+    return true;
+  }
+  // read exactly 'n' bytes
+  bool readBytes(std::size_t n, std::string &bytes) {
+    while (buffer.size() < n)
+      if (not fill()) return false;
+    bytes.assign(buffer, 0, n);
+    buffer.erase(0, n);
+    return true;
+  }
+  // write all of 'bytes'
+  bool write(const std::string &bytes) {
+    for (std::size_t done = 0; done < bytes.size(); ) {
+      ssize_t n = send(fd, bytes.data() + done, bytes.size() - done, MSG_NOSIGNAL);
+      if (n < 0 and errno == EINTR) continue;
+      if (n <= 0) return false;
+      done += n;
+    }
+    return true;
+  }
+private:
+  int fd;
+  std::string buffer;
+  bool fill() {
+    char chunk[1 << 16];
+    ssize_t n;
+    do n = recv(fd, chunk, sizeof(chunk), 0); while (n < 0 and errno == EINTR);
+    if (n <= 0) return false;
+    buffer.append(chunk, n);
+    return true;
+  }
+};
+
+// answer of the compile server to a request it does not compile
+static std::string refusal(const std::string &message) {
+  return "ERROR " + std::to_string(message.size() + 1) + " 0\n" + message + "\n";
+}
+
+// value of the decimal number 'digits', in 'n'. False if it is larger
+// than 'max'.
+static bool decimal(const std::string &digits, std::size_t max, std::size_t &n) {
+  n = 0;
+  for (char d : digits) {
+    n = n*10 + (d - '0');
+    if (n > max) return false;
+  }
+  return true;
+}
+
+// The requests of the clients of the compile server that wait for a
+// worker. The reader of each connection submits its requests one at a
+// time, and waits for the answer; the workers take them in order. So
+// a worker is only held while it compiles, however many connections
+// are open.
+class RequestQueue {
+public:
+  struct Request {
+    std::string path;           // file to compile, or
+    std::string source;         // its source (if no path)
+    std::string answer;         // answer to the client, once compiled
+    bool answered = false;
+  };
+  // add 'r' to the queue, and wait until a worker has answered it
+  void submit(Request &r) {
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.push_back(&r);
+    ready.notify_one();
+    done.wait(lock, [&r]() { return r.answered; });
+  }
+  // take the next request, waiting until there is one
+  Request & take() {
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait(lock, [this]() { return not pending.empty(); });
+    Request &r = *pending.front();
+    pending.pop_front();
+    return r;
+  }
+  // give its answer to a request taken from the queue
+  void answer(Request &r, const std::string &answer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    r.answer = answer;
+    r.answered = true;
+    done.notify_all();
+  }
+private:
+  std::mutex mutex;
+  std::condition_variable ready;   // some request is pending
+  std::condition_variable done;    // some request has been answered
+  std::deque<Request *> pending;
+};
+
+// compile a request of the compile server, and return its answer
+// (an error of the compiler itself only fails this request)
+static std::string compileRequest(const RequestQueue::Request &r, const Options &opts,
+                                  std::mutex &logLock) {
+  std::istringstream in(r.source);
+  std::ostringstream out, msgs, log;
+  StreamErrorListener syntaxErrors(msgs);
+  int status;
+  try {
+    status = compile(r.path.empty() ? nullptr : r.path.c_str(), nullptr, opts,
+                     Streams{in, out, msgs, syntaxErrors, log});
+  }
+  catch (std::exception &e) {
+    msgs << "Internal error: " << e.what() << std::endl;
+    status = EXIT_FAILURE;
+  }
+  catch (...) {
+    msgs << "Internal error" << std::endl;
+    status = EXIT_FAILURE;
+  }
+  if (status != EXIT_SUCCESS)
+    out.str("");
+  if (log.tellp() > 0) {
+    std::lock_guard<std::mutex> lock(logLock);
+    std::cerr << (r.path.empty() ? "<source>" : r.path) << ":\n" << log.str() << std::flush;
+  }
+  std::string diagnostics = msgs.str(), tcode = out.str();
+  return std::string(status == EXIT_SUCCESS ? "OK " : "ERROR ")
+         + std::to_string(diagnostics.size()) + " "
+         + std::to_string(tcode.size()) + "\n" + diagnostics + tcode;
+}
+
+// read the requests of a connection to the compile server, have them
+// answered by the workers through 'queue' and send back the answers,
+// until the client closes it (or sends a bad request)
+static void serveConnection(int fd, RequestQueue &queue) {
+  Connection conn(fd);
+  std::string request;
+  while (conn.readLine(request)) {
+    RequestQueue::Request r;
+    std::size_t size;
+    if (request.compare(0, 5, "FILE ") == 0 and request.size() > 5)
+      r.path = request.substr(5);
+    else if (request.compare(0, 7, "SOURCE ") == 0 and
+             request.find_first_not_of("0123456789", 7) == std::string::npos and
+             request.size() > 7) {
+      if (not decimal(request.substr(7), MAX_SOURCE_SIZE, size)) {
+        conn.write(refusal("Source too large (at most " + std::to_string(MAX_SOURCE_SIZE) +
+                           " bytes)"));
+        return;
+      }
+      if (not conn.readBytes(size, r.source))
+        return;
+    }
+    else {
+      conn.write(refusal("Bad request"));
+      return;
+    }
+    queue.submit(r);
+    if (not conn.write(r.answer))
+      return;
+  }
+}
+
+// run a compile server on the Unix socket 'path', answering the
+// requests of its clients on 'jobs' threads. It keeps the ATN and DFA
+// caches of the lexer and the parser from one request to the next, so
+// a compilation costs about the same as in --batch mode. The server
+// runs until it is killed.
+//
+// A client sends one or more requests on a connection, and gets an
+// answer for each one, in order. A request is either
+//     FILE <path>\n                 to compile the file <path> (relative
+//                                   to the directory of the server), or
+//     SOURCE <n>\n<n bytes>         to compile the <n> bytes given
+//                                   (at most MAX_SOURCE_SIZE).
+// The answer is
+//     OK|ERROR <m> <k>\n<m bytes><k bytes>
+// where the <m> bytes are the messages of the compiler (lexical,
+// syntactical and semantic errors, as asl writes them) and the <k>
+// bytes are the t-code generated (none if ERROR). After a bad request,
+// or a source too large, the server answers ERROR and closes the
+// connection.
+static int serve(const char *path, unsigned jobs, const Options &opts) {
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (std::strlen(path) >= sizeof(addr.sun_path)) {
+    std::cout << "Socket path too long: " << path << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::strcpy(addr.sun_path, path);
+  // a socket left by a previous server is removed, anything else
+  // at 'path' is kept
+  struct stat st;
+  if (lstat(path, &st) == 0) {
+    if (not S_ISSOCK(st.st_mode)) {
+      std::cout << "Not a socket: " << path << std::endl;
+      return EXIT_FAILURE;
+    }
+    unlink(path);
+  }
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 or
+      bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 or
+      listen(listener, SOMAXCONN) != 0) {
+    std::cout << "Cannot listen on socket: " << path << std::endl;
+    return EXIT_FAILURE;
+  }
+  // 'jobs' workers compile the requests, and each connection has a
+  // thread of its own that reads its requests and writes the answers
+  RequestQueue queue;
+  std::mutex logLock;
+  for (unsigned t = 0; t < jobs; ++t)
+    std::thread([&]() {
+      while (true) {
+        RequestQueue::Request &r = queue.take();
+        queue.answer(r, compileRequest(r, opts, logLock));
+      }
+    }).detach();
+  while (true) {
+    int fd = accept(listener, nullptr, nullptr);
+    if (fd >= 0) {
+      try {
+        std::thread(serveConnection, fd, std::ref(queue)).detach();
+      }
+      catch (std::system_error &) {   // no more threads for now
+        close(fd);
+      }
+    }
+    else if (errno == EMFILE or errno == ENFILE)   // wait for some to close
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    else if (errno == EBADF or errno == EINVAL or errno == ENOTSOCK)
+      break;
+  }
+  // the workers and the readers never end, and they use 'queue': leave
+  // at once, without returning
+  std::cout << "Cannot accept connections on socket: " << path << std::endl;
+  std::_Exit(EXIT_FAILURE);
+}
+
+static void usage() {
+  std::cout << "Usage: ./asl [--time-passes] [--mem-stats] [--stats-json] [--ll-only] [--fast-lexer]" << std::endl
+            << "             [--pipeline] [-O]" << std::endl
+            << "             [-o <output>[.tbc]] [<file>]" << std::endl
+            << "       ./asl [options] --batch [-j <jobs>] <file>..." << std::endl
+            << "       ./asl [options] --serve <socket> [-j <jobs>]" << std::endl;
+}
+
+int main(int argc, const char* argv[]) {
+  // the output is large and only written through std::cout (or an
+  // ofstream), so there is no need to keep it in sync with stdio
+  std::ios::sync_with_stdio(false);
+
+  // check the correct use of the program
+  Options opts;
+  const char *inFile  = nullptr;   // input file (std::cin if not given)
+  const char *outFile = nullptr;   // output file (std::cout if not given)
+  bool batch = false;              // compile all the files given...
+  std::vector<const char *> files;
+  const char *socketPath = nullptr;   // ... or the requests to this socket
+  unsigned jobs = std::thread::hardware_concurrency();   // ... on 'jobs' threads
+  if (jobs == 0) jobs = 1;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-o" and i+1 < argc and not outFile)
+      outFile = argv[++i];
+    else if (arg == "-j" and i+1 < argc and std::atoi(argv[i+1]) > 0)
+      jobs = std::atoi(argv[++i]);
+    else if (arg == "--batch")
+      batch = true;
+    else if (arg == "--serve" and i+1 < argc and not socketPath)
+      socketPath = argv[++i];
+    else if (arg == "--time-passes")
+      opts.timePasses = true;
+    else if (arg == "--mem-stats")
+      opts.memStats = true;
+    else if (arg == "--stats-json")
+      opts.statsJSON = true;
+    else if (arg == "--ll-only")
+      opts.llOnly = true;
+    else if (arg == "--fast-lexer")
+      opts.fastLexer = true;
+    else if (arg == "--pipeline")
+      opts.pipeline = true;
+    else if (arg == "-O")
+      opts.optimize = true;
+    else if (arg[0] != '-')
+      files.push_back(argv[i]);
+    else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (socketPath) {
+    if (batch or outFile or not files.empty()) {
+      usage();
+      return EXIT_FAILURE;
+    }
+    return serve(socketPath, jobs, opts);
+  }
+  if (batch) {
+    if (outFile or files.empty()) {
+      usage();
+      return EXIT_FAILURE;
+    }
+    return compileBatch(files, jobs, opts);
+  }
+  if (files.size() > 1) {
+    usage();
+    return EXIT_FAILURE;
+  }
+  if (not files.empty())
+    inFile = files[0];
+
+  return compile(inFile, outFile, opts,
+                 Streams{std::cin, std::cout, std::cout,
+                         antlr4::ConsoleErrorListener::INSTANCE, std::cerr});
+}
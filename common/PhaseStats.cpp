@@ -0,0 +1,224 @@
+/////////////////////////////////////////////////////////////////
+//
+//    PhaseStats - Cost of each phase of the Asl compiler
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "PhaseStats.h"
+
+#include <string>
+#include <iomanip>
+#include <new>        // std::bad_alloc
+
+#include <cstdio>     // snprintf
+#include <cstdlib>    // malloc, free
+
+#include <sys/resource.h>   // getrusage
+
+// using namespace std;
+
+
+namespace {
+
+#ifdef COUNT_ALLOCATIONS
+  // calls to the global operator new (and so to operator new[]) made
+  // by each thread, so that the phases of compilations running at the
+  // same time (asl --batch) do not count each other's allocations
+  thread_local uint64_t numAllocations = 0;
+#endif
+
+  // a number of milliseconds, with 3 decimals
+  std::string millis(double ms) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", ms);
+    return buf;
+  }
+
+  // a string as a JSON literal
+  std::string quoted(const std::string & s) {
+    std::string q = "\"";
+    for (char c : s) {
+      if (c == '"' or c == '\\') q += '\\';
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char buf[8];
+        snprintf(buf, sizeof(buf), "\\u%04x", c);
+        q += buf;
+      }
+      else q += c;
+    }
+    return q + "\"";
+  }
+
+}
+
+
+#ifdef COUNT_ALLOCATIONS
+// The global operator new and delete, replaced to count the
+// allocations of each phase. Only in builds made to measure them
+// (make stats), as every allocation of the program pays for it.
+void * operator new(std::size_t size) {
+  ++numAllocations;
+  void * p = std::malloc(size ? size : 1);
+  if (not p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void * p) noexcept {
+  std::free(p);
+}
+#endif
+
+
+void PhaseStats::start(const std::string & phase) {
+  if (running) stop();
+  phases.push_back(Phase{phase, 0.0, 0.0, 0, {}});
+  running = true;
+  wallStart = std::chrono::steady_clock::now();
+  cpuStart = std::clock();
+  allocStart = allocations();
+}
+
+void PhaseStats::stop() {
+  if (not running) return;
+#ifdef COUNT_ALLOCATIONS
+  uint64_t allocEnd = allocations();
+#endif
+  std::clock_t cpuEnd = std::clock();
+  std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - wallStart;
+  Phase & p = phases.back();
+  p.wallMs = wall.count();
+  p.cpuMs = 1000.0 * (cpuEnd - cpuStart) / CLOCKS_PER_SEC;
+  p.peakRSSKb = peakRSS();
+  running = false;
+#ifdef COUNT_ALLOCATIONS
+  count("allocations", allocEnd - allocStart);
+#endif
+}
+
+void PhaseStats::count(const std::string & what, uint64_t n) {
+  if (phases.empty()) return;
+  phases.back().counts.push_back(std::make_pair(what, n));
+}
+
+void PhaseStats::countSubroutine(const std::string & name, uint64_t instructions) {
+  subroutines.push_back(Subroutine{name, instructions, {}});
+}
+
+void PhaseStats::countInSubroutine(const std::string & what, uint64_t n) {
+  if (not subroutines.empty())
+    subroutines.back().counts.push_back(std::make_pair(what, n));
+}
+
+uint64_t PhaseStats::allocations() {
+#ifdef COUNT_ALLOCATIONS
+  return numAllocations;
+#else
+  return 0;
+#endif
+}
+
+long PhaseStats::peakRSS() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;     // bytes
+#else
+  return usage.ru_maxrss;            // KB
+#endif
+}
+
+void PhaseStats::print(std::ostream & os, bool times, bool memory) const {
+  double wall = 0, cpu = 0;
+  os << "=== Compiler phases\n";
+  os << "  " << std::left << std::setw(12) << "phase" << std::right;
+  if (times)  os << std::setw(14) << "wall (ms)" << std::setw(14) << "cpu (ms)";
+  if (memory) os << std::setw(18) << "peak RSS (KB)";
+  os << "\n";
+  for (auto const & p : phases) {
+    wall += p.wallMs;
+    cpu += p.cpuMs;
+    os << "  " << std::left << std::setw(12) << p.name << std::right;
+    if (times)  os << std::setw(14) << millis(p.wallMs) << std::setw(14) << millis(p.cpuMs);
+    if (memory) os << std::setw(18) << p.peakRSSKb;
+    os << "\n";
+  }
+  if (times)
+    os << "  " << std::left << std::setw(12) << "total" << std::right
+       << std::setw(14) << millis(wall) << std::setw(14) << millis(cpu) << "\n";
+  if (not memory) return;
+
+  os << "\n=== Counts\n";
+  for (auto const & p : phases)
+    for (auto const & c : p.counts)
+      os << "  " << std::left << std::setw(12) << p.name << std::setw(26) << c.first
+         << std::right << std::setw(12) << c.second << "\n";
+  if (subroutines.empty()) return;
+  os << "\n=== Instructions per subroutine\n";
+  for (auto const & s : subroutines) {
+    os << "  " << std::left << std::setw(38) << s.name << std::right
+       << std::setw(12) << s.instructions << "\n";
+    for (auto const & c : s.counts)
+      os << "    " << std::left << std::setw(36) << c.first << std::right
+         << std::setw(12) << c.second << "\n";
+  }
+}
+
+void PhaseStats::printJSON(std::ostream & os, bool times, bool memory) const {
+  os << "{\n  \"phases\": [";
+  for (std::size_t i = 0; i < phases.size(); ++i) {
+    const Phase & p = phases[i];
+    os << (i ? ",\n" : "\n") << "    {\"name\": " << quoted(p.name);
+    if (times)
+      os << ", \"wall_ms\": " << millis(p.wallMs) << ", \"cpu_ms\": " << millis(p.cpuMs);
+    if (memory) {
+      os << ", \"peak_rss_kb\": " << p.peakRSSKb << ", \"counts\": {";
+      for (std::size_t k = 0; k < p.counts.size(); ++k)
+        os << (k ? ", " : "") << quoted(p.counts[k].first) << ": " << p.counts[k].second;
+      os << "}";
+    }
+    os << "}";
+  }
+  os << "\n  ]";
+  if (memory) {
+    os << ",\n  \"subroutines\": {";
+    for (std::size_t i = 0; i < subroutines.size(); ++i)
+      os << (i ? ",\n" : "\n") << "    " << quoted(subroutines[i].name)
+         << ": " << subroutines[i].instructions;
+    os << (subroutines.empty() ? "}" : "\n  }");
+    // the named counts of each subroutine, if any, apart (so the
+    // "subroutines" object stays a map of names to instructions)
+    bool any = false;
+    for (auto const & s : subroutines) {
+      if (s.counts.empty()) continue;
+      os << (any ? ",\n" : ",\n  \"subroutine_counts\": {\n") << "    " << quoted(s.name) << ": {";
+      for (std::size_t k = 0; k < s.counts.size(); ++k)
+        os << (k ? ", " : "") << quoted(s.counts[k].first) << ": " << s.counts[k].second;
+      os << "}";
+      any = true;
+    }
+    if (any) os << "\n  }";
+  }
+  os << "\n}\n";
+}
@@ -0,0 +1,111 @@
+/////////////////////////////////////////////////////////////////
+//
+//    PhaseStats - Cost of each phase of the Asl compiler
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <cstddef>    // std::size_t
+
+
+////////////////////////////////////////////////////////////////
+// Class PhaseStats: measures the phases of a compilation (lexer,
+// parser, each tree walk, output...). For every phase it keeps
+// its wall and CPU time, the peak RSS of the process when the
+// phase ends, and any number of named counts (tokens, nodes,
+// symbols...) given by the caller. Built with COUNT_ALLOCATIONS
+// defined (make stats in asl), it also counts the calls to operator
+// new made by the thread during the phase (through a replacement of
+// the global operator new in PhaseStats.cpp), as the count
+// "allocations". It also keeps the number of instructions
+// generated for each subroutine, and named counts for each one (what
+// the optimizer did to it).
+// The report can be written as a table or as a JSON object, so
+// the cost of the compiler can be tracked from one release to
+// the next.
+
+class PhaseStats {
+
+public:
+
+  // Constructor
+  PhaseStats() = default;
+
+  // Start measuring a new phase (ending the current one, if any)
+  void start (const std::string & phase);
+  // End the current phase
+  void stop  ();
+
+  // Add a named count to the last phase started
+  void count (const std::string & what, uint64_t n);
+  // Number of instructions generated for a subroutine
+  void countSubroutine (const std::string & name, uint64_t instructions);
+  // Add a named count to the last subroutine given
+  void countInSubroutine (const std::string & what, uint64_t n);
+
+  // Write the report: times (if 'times') and/or peak RSS and
+  // counts (if 'memory'), as a table or as a JSON object
+  void print     (std::ostream & os, bool times, bool memory) const;
+  void printJSON (std::ostream & os, bool times, bool memory) const;
+
+private:
+
+  struct Phase {
+    std::string name;
+    double      wallMs;
+    double      cpuMs;
+    long        peakRSSKb;
+    std::vector<std::pair<std::string, uint64_t>> counts;
+  };
+
+  struct Subroutine {
+    std::string name;
+    uint64_t    instructions;
+    std::vector<std::pair<std::string, uint64_t>> counts;
+  };
+
+  std::vector<Phase> phases;
+  std::vector<Subroutine> subroutines;
+
+  // Start of the current phase (if 'running')
+  bool running = false;
+  std::chrono::steady_clock::time_point wallStart;
+  std::clock_t cpuStart;
+  uint64_t allocStart;
+
+  // Peak resident set size of the process, in KB (0 if unknown)
+  static long peakRSS ();
+  // Calls to the global operator new made by this thread
+  static uint64_t allocations ();
+
+};  // class PhaseStats
@@ -37,9 +37,13 @@
 // using namespace std;
 
 
+SemErrors::SemErrors(std::ostream & Out) :
+  Out{Out} {
+}
+
 void SemErrors::print() {
   std::sort(ErrorList.begin(), ErrorList.end(), less);  
-  for (auto & error : ErrorList) error.print();
+  for (auto & error : ErrorList) error.print(Out);
 }
 
 bool SemErrors::less(const ErrorInfo & e1, const ErrorInfo & e2) {
@@ -149,8 +153,8 @@ SemErrors::ErrorInfo::ErrorInfo(std::size_t line, std::size_t coln, std::string
   : line{line}, coln{coln}, message{message} {
 }
 
-void SemErrors::ErrorInfo::print() const {
-  std::cout << "Line " << line << ":" << coln << " error: " << message << std::endl;
+void SemErrors::ErrorInfo::print(std::ostream & os) const {
+  os << "Line " << line << ":" << coln << " error: " << message << std::endl;
 }
 
 std::size_t SemErrors::ErrorInfo::getLine() const {
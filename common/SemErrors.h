@@ -32,6 +32,8 @@
 
 #include <string>
 #include <vector>
+#include <ostream>
+#include <iostream>
 
 // using namespace std;
 
@@ -44,13 +46,14 @@
 //   - TypeCheckVisitor
 // Semantic errors emitted are kept in a vector and when the
 // typecheck finishes they will be printed (sorted by line/column number)
+// on std::cout, or on the stream given to the constructor
 
 class SemErrors {
 
 public:
 
   // Constructor
-  SemErrors() = default;
+  SemErrors(std::ostream & Out = std::cout);
 
   // Write the semantic errors ordered by line number
   void print ();
@@ -114,14 +117,15 @@ private:
     ErrorInfo(std::size_t line, std::size_t coln, std::string message);
     std::size_t getLine() const;
     std::size_t getColumnInLine() const;
-    void print() const;
+    void print(std::ostream & os) const;
   private:
     std::size_t line, coln;
     std::string message;
   };
 
-  // List of semantic errors
+  // List of semantic errors, and where they are written
   std::vector<ErrorInfo> ErrorList;
+  std::ostream         & Out;
 
   // Compare two errors to determine the order (needed in print)
   static bool less(const ErrorInfo & e1, const ErrorInfo & e2);
@@ -0,0 +1,109 @@
+/////////////////////////////////////////////////////////////////
+//
+//    StringPool - Interned strings (identifiers) of the Asl compiler
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "StringPool.h"
+
+#include <string>
+#include <cstring>    // std::memcmp
+
+// using namespace std;
+
+
+namespace {
+
+  // initial size of the hash table (a power of two)
+  const std::size_t INITIAL_SLOTS = 1024;
+
+  // FNV-1a hash of n bytes
+  std::size_t hashBytes(const char * s, std::size_t n) {
+    std::size_t h = 2166136261u;
+    for (std::size_t i = 0; i < n; ++i)
+      h = (h ^ static_cast<unsigned char>(s[i])) * 16777619u;
+    return h;
+  }
+
+}
+
+
+StringPool::StringPool() :
+  Table(INITIAL_SLOTS, nullptr) {
+}
+
+std::size_t StringPool::slot(const char * s, std::size_t n) const {
+  std::size_t mask = Table.size() - 1;
+  std::size_t i = hashBytes(s, n) & mask;
+  while (Table[i] != nullptr and
+         not (Table[i]->size() == n and std::memcmp(Table[i]->data(), s, n) == 0))
+    i = (i + 1) & mask;
+  return i;
+}
+
+StringPool::Name StringPool::intern(const char * s, std::size_t n) {
+  std::size_t i = slot(s, n);
+  if (Table[i] != nullptr)
+    return Table[i];
+  if (2 * (Strings.size() + 1) > Table.size()) {
+    Table.assign(2 * Table.size(), nullptr);
+    for (const std::string & str : Strings)
+      Table[slot(str.data(), str.size())] = &str;
+    i = slot(s, n);
+  }
+  Strings.emplace_back(s, n, Id(Strings.size()));
+  Table[i] = &Strings.back();
+  return Table[i];
+}
+
+StringPool::Name StringPool::intern(const std::string & s) {
+  return intern(s.data(), s.size());
+}
+
+StringPool::Name StringPool::find(const std::string & s) const {
+  return Table[slot(s.data(), s.size())];
+}
+
+StringPool::Id StringPool::id(Name name) const {
+  return static_cast<const Entry *>(name)->Index;
+}
+
+StringPool::Name StringPool::name(Id id) const {
+  return &Strings[id];
+}
+
+void StringPool::putTokenName(std::size_t tokenIndex, Name name) {
+  if (tokenIndex >= TokenNames.size())
+    TokenNames.resize(tokenIndex + 1, nullptr);
+  TokenNames[tokenIndex] = name;
+}
+
+StringPool::Name StringPool::getTokenName(std::size_t tokenIndex) const {
+  return (tokenIndex < TokenNames.size() ? TokenNames[tokenIndex] : nullptr);
+}
+
+std::size_t StringPool::size() const {
+  return Strings.size();
+}
@@ -0,0 +1,114 @@
+/////////////////////////////////////////////////////////////////
+//
+//    StringPool - Interned strings (identifiers) of the Asl compiler
+//
+//    Copyright (C) 2019  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>    // std::size_t
+
+// using namespace std;
+
+
+////////////////////////////////////////////////////////////////
+// Class StringPool: keeps one copy of each different string (the
+// names of the identifiers of a program), and gives a Name for
+// it: a pointer to that copy, which does not change while the
+// pool exists. So two Names are equal iff their strings are, and
+// they can be compared, hashed and copied as pointers.
+// Each string also has an Id, its number in order of interning
+// (0, 1, 2, ...), which is what the operands of the code refer to:
+// the pool of a code object (code.h) holds the names and constants
+// of its instructions, and in the compiler it is the same pool that
+// the front end fills with the identifiers, so the operand of an
+// identifier is built from its Name with no new hashing.
+// The pool also keeps the Name of each identifier token of the
+// source, by its token index: the lexer phase fills it once, and
+// then the listeners get the names of the identifiers with no new
+// strings.
+
+class StringPool {
+
+public:
+
+  // The Name of a string in the pool, and its Id
+  typedef const std::string * Name;
+  typedef unsigned int        Id;
+
+  // Constructor
+  StringPool ();
+  StringPool (const StringPool &) = delete;
+  StringPool & operator= (const StringPool &) = delete;
+
+  // Name of a string, which is added to the pool if it is not there
+  Name intern (const char * s, std::size_t n);
+  Name intern (const std::string & s);
+  // Name of a string, or nullptr if it is not in the pool
+  Name find   (const std::string & s) const;
+
+  // Id of a Name of the pool, and Name with an Id
+  Id   id     (Name name) const;
+  Name name   (Id id) const;
+
+  // Name of the identifier at a token index (nullptr if none)
+  void putTokenName (std::size_t tokenIndex, Name name);
+  Name getTokenName (std::size_t tokenIndex) const;
+  // Name of an identifier token of the parse tree (an
+  // antlr4::tree::TerminalNode): the one kept for its token index
+  // (or, for a token that was not there, its text interned now)
+  template <class TerminalNode>
+  Name getName (TerminalNode * id) {
+    Name n = getTokenName(id->getSymbol()->getTokenIndex());
+    return n ? n : intern(id->getText());
+  }
+
+  // Accessor to get the number of different strings (statistics)
+  std::size_t size () const;
+
+private:
+
+  // A string of the pool, with its Id (every Name points to one)
+  struct Entry : std::string {
+    Entry (const char * s, std::size_t n, Id id) : std::string(s, n), Index(id) { }
+    Id Index;
+  };
+
+  // The strings, by Id (a deque, so that they never move)
+  std::deque<Entry> Strings;
+  // Hash table (open addressing with linear probing) of the
+  // strings. Its size is a power of two, and it is never more
+  // than half full.
+  std::vector<Name> Table;
+  // Names of the identifier tokens
+  std::vector<Name> TokenNames;
+
+  // Slot of the table where s is, or where it would be inserted
+  std::size_t slot (const char * s, std::size_t n) const;
+
+};  // class StringPool
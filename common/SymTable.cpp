@@ -32,6 +32,8 @@
 
 #include <string>
 #include <iostream>
+#include <functional> // std::hash
+#include <cstdint>    // std::uintptr_t
 
 #include <cstddef>    // std::size_t
 // uncomment to disable assert()
@@ -41,9 +43,20 @@
 // using namespace std;
 
 
+// initial size of the hash table of a scope (a power of two)
+static const std::size_t INITIAL_SLOTS = 8;
+
+// slot where the search of a name begins, in a table of 'mask'+1 slots
+static std::size_t home(StringPool::Name ident, std::size_t mask) {
+  std::uintptr_t h = reinterpret_cast<std::uintptr_t>(ident) >> 3;
+  return std::hash<std::uintptr_t>()(h * 0x9E3779B1u) & mask;
+}
+
+const SymTable::SymbolId SymTable::NoSymbol = SymTable::SymbolId(-1);
+
 // Constructor
-SymTable::SymTable(TypesMgr & Types) :
-  Types{Types} {
+SymTable::SymTable(TypesMgr & Types, StringPool & Names) :
+  Types{Types}, Names{Names} {
 }
 
 // Creates a new scope, push its ScopeId in the stack
@@ -73,12 +86,60 @@ SymTable::ScopeId SymTable::topScope() const {
   return ScopeIdsStack.back();
 }
 
-// Returns true if ident occurs in the current scope (top of the stack)
-bool SymTable::findInCurrentScope(const std::string & ident) const {
+// Returns the SymbolId of ident in the scope sc, or NoSymbol
+SymTable::SymbolId SymTable::findInScope(ScopeId sc, StringPool::Name ident) const {
+  assert(sc < ScopesVec.size());
+  if (ident == nullptr)     // not even in the pool
+    return NoSymbol;
+  const std::vector<SymbolId> & table = ScopesVec[sc].Table;
+  std::size_t mask = table.size() - 1;
+  for (std::size_t i = home(ident, mask);
+       table[i] != NoSymbol; i = (i + 1) & mask) {
+    if (SymbolsVec[table[i]].getName() == ident)
+      return table[i];
+  }
+  return NoSymbol;
+}
+
+// Adds a new symbol in the current scope, and returns its SymbolId
+SymTable::SymbolId SymTable::addSymbol(const SymbolInfo & info) {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  return (ScopesVec[currScope].findSymbol(ident));
+  assert(findInScope(currScope, info.getName()) == NoSymbol);
+  ScopeInfo & scope = ScopesVec[currScope];
+  SymbolId sym = SymbolsVec.size();
+  SymbolsVec.push_back(info);
+  scope.IdentsList.push_back(sym);
+  // keep the table at most half full, and insert the symbol
+  if (2 * scope.IdentsList.size() > scope.Table.size()) {
+    scope.Table.assign(2 * scope.Table.size(), NoSymbol);
+    std::size_t mask = scope.Table.size() - 1;
+    for (SymbolId s : scope.IdentsList) {
+      std::size_t i = home(SymbolsVec[s].getName(), mask);
+      while (scope.Table[i] != NoSymbol)
+        i = (i + 1) & mask;
+      scope.Table[i] = s;
+    }
+  }
+  else {
+    std::size_t mask = scope.Table.size() - 1;
+    std::size_t i = home(info.getName(), mask);
+    while (scope.Table[i] != NoSymbol)
+      i = (i + 1) & mask;
+    scope.Table[i] = sym;
+  }
+  return sym;
+}
+
+// Returns true if ident occurs in the current scope (top of the stack)
+bool SymTable::findInCurrentScope(const std::string & ident) const {
+  return findInCurrentScope(Names.find(ident));
+}
+
+bool SymTable::findInCurrentScope(StringPool::Name ident) const {
+  assert(not ScopeIdsStack.empty());
+  return findInScope(ScopeIdsStack.back(), ident) != NoSymbol;
 }
 
 // Returns an iteger >= 0 if ident occurs in some of the scopes
@@ -87,82 +148,97 @@ bool SymTable::findInCurrentScope(const std::string & ident) const {
 // Returns -1 if te symbol is not found.
 int SymTable::findInStack(const std::string & ident) const {
   assert(not ScopeIdsStack.empty());
+  StringPool::Name name = Names.find(ident);
   int d = 0;
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
-    ScopeId sc = ScopeIdsStack[i];
-    assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
+    if (findInScope(ScopeIdsStack[i], name) != NoSymbol)
       return d;
     ++d;
   }
   return -1;
 }
 
-// Adds a new symbol in the current scope.
-void SymTable::addLocalVar(const std::string & ident, TypesMgr::TypeId type) {
-  assert(not ScopeIdsStack.empty());
-  ScopeId currScope = ScopeIdsStack.back();
-  assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].addLocalVar(ident, type);
+// Returns the SymbolId of ident in the nearest scope of the stack
+// where it occurs, or NoSymbol if it is not found.
+SymTable::SymbolId SymTable::findSymbol(const std::string & ident) const {
+  return findSymbol(Names.find(ident));
 }
-void SymTable::addParameter(const std::string & ident, TypesMgr::TypeId type) {
+
+SymTable::SymbolId SymTable::findSymbol(StringPool::Name ident) const {
   assert(not ScopeIdsStack.empty());
-  ScopeId currScope = ScopeIdsStack.back();
-  assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].addParameter(ident, type);
+  for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
+    SymbolId sym = findInScope(ScopeIdsStack[i], ident);
+    if (sym != NoSymbol)
+      return sym;
+  }
+  return NoSymbol;
 }
 
-void SymTable::addFunction(const std::string & ident, TypesMgr::TypeId type) {
-  assert(not ScopeIdsStack.empty());
-  ScopeId currScope = ScopeIdsStack.back();
-  assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].addFunction(ident, type);
+// Adds a new symbol in the current scope.
+SymTable::SymbolId SymTable::addLocalVar(const std::string & ident, TypesMgr::TypeId type) {
+  return addLocalVar(Names.intern(ident), type);
+}
+
+SymTable::SymbolId SymTable::addParameter(const std::string & ident, TypesMgr::TypeId type) {
+  return addParameter(Names.intern(ident), type);
+}
+
+SymTable::SymbolId SymTable::addFunction(const std::string & ident, TypesMgr::TypeId type) {
+  return addFunction(Names.intern(ident), type);
+}
+
+SymTable::SymbolId SymTable::addLocalVar(StringPool::Name ident, TypesMgr::TypeId type) {
+  return addSymbol(SymbolInfo::createLocalVar(ident, type));
+}
+
+SymTable::SymbolId SymTable::addParameter(StringPool::Name ident, TypesMgr::TypeId type) {
+  return addSymbol(SymbolInfo::createParameter(ident, type));
+}
+
+SymTable::SymbolId SymTable::addFunction(StringPool::Name ident, TypesMgr::TypeId type) {
+  return addSymbol(SymbolInfo::createFunction(ident, type));
 }
 
 // Check the class of a symbol. If not found return false
 bool SymTable::isLocalVarClass(const std::string & ident) const {
-  assert(not ScopeIdsStack.empty());
-  for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
-    ScopeId sc = ScopeIdsStack[i];
-    assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].isLocalVarClass(ident);
-  }
-  return false;
+  return isLocalVarClass(findSymbol(ident));
 }
 
 bool SymTable::isParameterClass(const std::string & ident) const {
-  assert(not ScopeIdsStack.empty());
-  for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
-    ScopeId sc = ScopeIdsStack[i];
-    assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].isParameterClass(ident);
-  }
-  return false;
+  return isParameterClass(findSymbol(ident));
 }
 
 bool SymTable::isFunctionClass(const std::string & ident) const {
-  assert(not ScopeIdsStack.empty());
-  for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
-    ScopeId sc = ScopeIdsStack[i];
-    assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].isFunctionClass(ident);
-  }
-  return false;
+  return isFunctionClass(findSymbol(ident));
+}
+
+bool SymTable::isLocalVarClass(SymbolId sym) const {
+  return sym != NoSymbol and SymbolsVec[sym].isLocalVarClass();
+}
+
+bool SymTable::isParameterClass(SymbolId sym) const {
+  return sym != NoSymbol and SymbolsVec[sym].isParameterClass();
+}
+
+bool SymTable::isFunctionClass(SymbolId sym) const {
+  return sym != NoSymbol and SymbolsVec[sym].isFunctionClass();
 }
 
 // Get the TypeId of a symbol. If not found return type 'error'
 TypesMgr::TypeId SymTable::getType(const std::string & ident) const {
-  assert(not ScopeIdsStack.empty());
-  for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
-    ScopeId sc = ScopeIdsStack[i];
-    assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].getType(ident);
-  }
-  return Types.createErrorTy();
+  return getType(findSymbol(ident));
+}
+
+TypesMgr::TypeId SymTable::getType(SymbolId sym) const {
+  if (sym == NoSymbol)
+    return Types.createErrorTy();
+  return SymbolsVec[sym].getType();
+}
+
+// Get the name of a symbol
+const std::string & SymTable::getName(SymbolId sym) const {
+  assert(sym < SymbolsVec.size());
+  return *SymbolsVec[sym].getName();
 }
 
 // Accessor/Mutator to the attribute currFunctionType
@@ -178,30 +254,37 @@ void SymTable::setCurrentFunctionTy(TypesMgr::TypeId type) {
 // on the standard output.
 void SymTable::printCurrentScope() const {
   assert(not ScopeIdsStack.empty());
-  ScopeId currScope = ScopeIdsStack.back();
-  assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].print(Types);
+  printScope(ScopeIdsStack.back());
 }
 
 // Write the contents of the symbol table on the standard output
 void SymTable::print() const {
   std::cout << "Contents of symbol table:" << std::endl;
-  for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
-    ScopeId sc = ScopeIdsStack[i];
-    assert(sc < ScopesVec.size());
-    ScopesVec[sc].print(Types);
-  }
+  for (int i = ScopeIdsStack.size() - 1; i >= 0; --i)
+    printScope(ScopeIdsStack[i]);
   std::cout << "----------------" << std::endl;
 }
 
+// Writes the contents of a scope to the standard output.
+void SymTable::printScope(ScopeId sc) const {
+  assert(sc < ScopesVec.size());
+  std::cout << "---------------- scope name: " << ScopesVec[sc].getName() << std::endl;
+  for (SymbolId sym : ScopesVec[sc].IdentsList) {
+    const SymbolInfo & info = SymbolsVec[sym];
+    std::cout << *info.getName() << ":" << info.class2string();
+    if (not info.isErrorClass()) {
+      std::cout << "," << Types.to_string(info.getType());
+    }
+    std::cout << std::endl;
+  }
+}
+
 bool SymTable::noMainProperlyDeclared() const {
   assert(not ScopeIdsStack.empty());
-  ScopeId currScope = ScopeIdsStack.back();
-  assert(currScope < ScopesVec.size());
-  if ((not ScopesVec[currScope].findSymbol("main")) or
-      (not ScopesVec[currScope].isFunctionClass("main")))
+  SymbolId sym = findInScope(ScopeIdsStack.back(), Names.find("main"));
+  if (not isFunctionClass(sym))
     return true;
-  TypesMgr::TypeId tid = ScopesVec[currScope].getType("main");
+  TypesMgr::TypeId tid = getType(sym);
   if (Types.isFunctionTy(tid) and
       (Types.getNumOfParameters(tid) == 0) and
       Types.isVoidFunction(tid))
@@ -209,111 +292,64 @@ bool SymTable::noMainProperlyDeclared() const {
   return true;
 }
 
+std::size_t SymTable::getNumberOfScopes() const {
+  return ScopesVec.size();
+}
+
+std::size_t SymTable::getNumberOfSymbols() const {
+  return SymbolsVec.size();
+}
+
 
 // class SymTable::ScopeInfo ==============================================================
 
 // Constructor
 SymTable::ScopeInfo::ScopeInfo(const std::string & name)
-  : name{name} { }
+  : name{name}, Table(INITIAL_SLOTS, NoSymbol) { }
 
-// Accessors to work with the attributes: name, SymbolsMap, IdentsList
+// Accessors to work with the attributes: name, IdentsList
 std::string SymTable::ScopeInfo::getName() const {
   return name;
 }
 
-// Mutators to add symbols to the scope
-void SymTable::ScopeInfo::addLocalVar(const std::string & ident, TypesMgr::TypeId type) {
-  assert(SymbolsMap.find(ident) == SymbolsMap.end());
-  SymbolsMap[ident] = SymbolInfo::createLocalVar(type);
-  IdentsList.push_back(ident);
-}
-void SymTable::ScopeInfo::addParameter(const std::string & ident, TypesMgr::TypeId type) {
-  assert(SymbolsMap.find(ident) == SymbolsMap.end());
-  SymbolsMap[ident] = SymbolInfo::createParameter(type);
-  IdentsList.push_back(ident);
-}
-void SymTable::ScopeInfo::addFunction(const std::string & ident, TypesMgr::TypeId type) {
-  assert(SymbolsMap.find(ident) == SymbolsMap.end());
-  SymbolsMap[ident] = SymbolInfo::createFunction(type);
-  IdentsList.push_back(ident);
-}
-
-// Accessor to check the existence of a symbol
-bool SymTable::ScopeInfo::findSymbol(const std::string & ident) const {
-  return (SymbolsMap.find(ident) != SymbolsMap.end());
-}
-
-// Accessors to check the class of the symbol. If not found return false
-bool SymTable::ScopeInfo::isLocalVarClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
-    return false;
-  return it->second.isLocalVarClass();
-}
-bool SymTable::ScopeInfo::isParameterClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
-    return false;
-  return it->second.isParameterClass();
-}
-bool SymTable::ScopeInfo::isFunctionClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
-    return false;
-  return it->second.isFunctionClass();
-}
-
-// Accessor to get the TypeId of a symbol. The symbol MUST exist.
-TypesMgr::TypeId SymTable::ScopeInfo::getType(const std::string & ident) const {
-  assert(SymbolsMap.find(ident) != SymbolsMap.end());
-  auto const & it = SymbolsMap.find(ident);
-  return it->second.getType();
-}
-
-// Writes the contents of the scope to the standard output.
-void SymTable::ScopeInfo::print(TypesMgr & Types) const {
-  std::cout << "---------------- scope name: " << name << std::endl;
-  for (auto & id : IdentsList) {
-    auto const & it = SymbolsMap.find(id);
-    std::cout << id << ":" << it->second.class2string();
-    if (not it->second.isErrorClass()) {
-      std::cout << "," << Types.to_string(it->second.getType());
-    }
-    std::cout << std::endl;
-  }
+std::size_t SymTable::ScopeInfo::getNumberOfSymbols() const {
+  return IdentsList.size();
 }
 
 
-// class SymTable::ScopeInfo::SymbolInfo ==========================================================
+// class SymTable::SymbolInfo ==========================================================
 
 // Constructors
-SymTable::ScopeInfo::SymbolInfo::SymbolInfo()
-  : classId{ErrorClassId} {
+SymTable::SymbolInfo::SymbolInfo()
+  : name{nullptr}, classId{ErrorClassId} {
 }
-SymTable::ScopeInfo::SymbolInfo::SymbolInfo(SymClassId c, TypesMgr::TypeId tid)
-  : classId{c}, type{tid} {
+SymTable::SymbolInfo::SymbolInfo(StringPool::Name ident, SymClassId c, TypesMgr::TypeId tid)
+  : name{ident}, classId{c}, type{tid} {
     assert(FirstSymClassId < c and c < LastSymClassId);
 }
 
-// Accessors for working with the attributes: class and type
-bool SymTable::ScopeInfo::SymbolInfo::isLocalVarClass() const {
+// Accessors for working with the attributes: name, class and type
+StringPool::Name SymTable::SymbolInfo::getName() const {
+  return name;
+}
+bool SymTable::SymbolInfo::isLocalVarClass() const {
   return classId == LocalVarId;
 }
-bool SymTable::ScopeInfo::SymbolInfo::isParameterClass() const {
+bool SymTable::SymbolInfo::isParameterClass() const {
   return classId == ParameterId;
 }
-bool SymTable::ScopeInfo::SymbolInfo::isFunctionClass() const {
+bool SymTable::SymbolInfo::isFunctionClass() const {
   return classId == FunctionId;
 }
-bool SymTable::ScopeInfo::SymbolInfo::isErrorClass() const {
+bool SymTable::SymbolInfo::isErrorClass() const {
   return classId == ErrorClassId;
 }
-TypesMgr::TypeId SymTable::ScopeInfo::SymbolInfo::getType() const {
+TypesMgr::TypeId SymTable::SymbolInfo::getType() const {
   return type;
 }
 
 // Convert the symbol class to string
-std::string SymTable::ScopeInfo::SymbolInfo::class2string() const {
+std::string SymTable::SymbolInfo::class2string() const {
   switch (classId) {
   case LocalVarId:
     return "localVar";
@@ -327,12 +363,12 @@ std::string SymTable::ScopeInfo::SymbolInfo::class2string() const {
 }
 
 // Static methods to create SymbolInfo objects
-SymTable::ScopeInfo::SymbolInfo SymTable::ScopeInfo::SymbolInfo::createLocalVar(TypesMgr::TypeId type) {
-  return SymbolInfo(SymClassId::LocalVarId, type);
+SymTable::SymbolInfo SymTable::SymbolInfo::createLocalVar(StringPool::Name ident, TypesMgr::TypeId type) {
+  return SymbolInfo(ident, SymClassId::LocalVarId, type);
 }
-SymTable::ScopeInfo::SymbolInfo SymTable::ScopeInfo::SymbolInfo::createParameter(TypesMgr::TypeId type) {
-  return SymbolInfo(SymClassId::ParameterId, type);
+SymTable::SymbolInfo SymTable::SymbolInfo::createParameter(StringPool::Name ident, TypesMgr::TypeId type) {
+  return SymbolInfo(ident, SymClassId::ParameterId, type);
 }
-SymTable::ScopeInfo::SymbolInfo SymTable::ScopeInfo::SymbolInfo::createFunction(TypesMgr::TypeId type) {
-  return SymbolInfo(SymClassId::FunctionId, type);
+SymTable::SymbolInfo SymTable::SymbolInfo::createFunction(StringPool::Name ident, TypesMgr::TypeId type) {
+  return SymbolInfo(ident, SymClassId::FunctionId, type);
 }
@@ -29,9 +29,9 @@
 #pragma once
 
 #include "TypesMgr.h"
+#include "StringPool.h"
 
 #include <string>
-#include <map>
 #include <vector>
 
 #include <cstddef>    // std::size_t
@@ -57,6 +57,12 @@
 // scopes that determines which symbols are visible and
 // which are not. Entering in a function will push a new
 // scope to the stack and exiting will pop the stack.
+// Each symbol added gets a SymbolId, which never changes: once
+// an identifier has been found (with the right scopes in the
+// stack), its class and type can be asked for by its SymbolId,
+// with no lookup by name. The names of the symbols are kept in
+// a StringPool, so looking up a StringPool::Name compares and
+// hashes pointers, not strings.
 
 class SymTable {
 
@@ -64,9 +70,13 @@ public:
 
   // The ScopeId is an index in a vector
   typedef std::size_t ScopeId;
+  // The SymbolId is an index in another vector
+  typedef std::size_t SymbolId;
+  // SymbolId of an identifier that is not found
+  static const SymbolId NoSymbol;
 
   // Constructor
-  SymTable(TypesMgr & Types);
+  SymTable(TypesMgr & Types, StringPool & Names);
   // Destructor
   ~SymTable() = default;
 
@@ -83,22 +93,36 @@ public:
   // Methods to find an ident
   //   - in the current scope (top of the stack)
   bool    findInCurrentScope (const std::string & ident)             const;
+  bool    findInCurrentScope (StringPool::Name ident)                const;
   //   - in the whole stack. Returns the number of scopes skipped to
                           // find the symbol, or -1 if it is not found
   int     findInStack        (const std::string & ident)             const;
-
-  // Adds a new symbol in the current scope
-  void addLocalVar  (const std::string & ident, TypesMgr::TypeId type);
-  void addParameter (const std::string & ident, TypesMgr::TypeId type);
-  void addFunction  (const std::string & ident, TypesMgr::TypeId type);
+  //   - in the whole stack. Returns its SymbolId, or NoSymbol
+  SymbolId findSymbol        (const std::string & ident)             const;
+  SymbolId findSymbol        (StringPool::Name ident)                const;
+
+  // Adds a new symbol in the current scope, and returns its SymbolId
+  SymbolId addLocalVar  (const std::string & ident, TypesMgr::TypeId type);
+  SymbolId addParameter (const std::string & ident, TypesMgr::TypeId type);
+  SymbolId addFunction  (const std::string & ident, TypesMgr::TypeId type);
+  SymbolId addLocalVar  (StringPool::Name ident,    TypesMgr::TypeId type);
+  SymbolId addParameter (StringPool::Name ident,    TypesMgr::TypeId type);
+  SymbolId addFunction  (StringPool::Name ident,    TypesMgr::TypeId type);
 
   // Accessors to check the class of the symbol. If not found return false
   bool isLocalVarClass  (const std::string & ident) const;
   bool isParameterClass (const std::string & ident) const;
   bool isFunctionClass  (const std::string & ident) const;
+  //   - the same for a symbol already found (NoSymbol gives false)
+  bool isLocalVarClass  (SymbolId sym) const;
+  bool isParameterClass (SymbolId sym) const;
+  bool isFunctionClass  (SymbolId sym) const;
 
   // Accessor to get the TypeId of a symbol. If not found return type 'error'
   TypesMgr::TypeId getType (const std::string & ident) const;
+  TypesMgr::TypeId getType (SymbolId sym)              const;
+  // Accessor to get the name of a symbol
+  const std::string & getName (SymbolId sym)           const;
 
   // Accessor/Mutator to the type (TypeId) of the current function
   TypesMgr::TypeId getCurrentFunctionTy ()                      const;
@@ -107,6 +131,11 @@ public:
   // Check the existence of the "main" function
   bool noMainProperlyDeclared() const;
 
+  // Accessors to get the number of scopes and of symbols declared
+  // in all of them (statistics)
+  std::size_t getNumberOfScopes  () const;
+  std::size_t getNumberOfSymbols () const;
+
   // Print the symbols of a scope on the standard output
   //   - the symbols of the current scope (top of the stack)
   void printCurrentScope () const;
@@ -115,20 +144,35 @@ public:
 
 
 private:
-  // Forward declaration of class ScopeInfo
+  // Forward declaration of classes ScopeInfo and SymbolInfo
   class ScopeInfo;
+  class SymbolInfo;
 
   // Attributes:
-  TypesMgr               & Types;
-  std::vector<ScopeInfo>   ScopesVec;
-  std::vector<ScopeId>     ScopeIdsStack;
+  TypesMgr                & Types;
+  StringPool              & Names;
+  std::vector<ScopeInfo>    ScopesVec;
+  std::vector<ScopeId>      ScopeIdsStack;
+  // All the symbols, of all the scopes, indexed by SymbolId
+  std::vector<SymbolInfo>   SymbolsVec;
   // Current function type, established by TypeCheckListener
-  TypesMgr::TypeId         currFunctionType;
+  TypesMgr::TypeId          currFunctionType;
+
+  // Find an ident in one scope. Returns its SymbolId, or NoSymbol
+  SymbolId findInScope (ScopeId sc, StringPool::Name ident) const;
+  // Adds a new symbol in the current scope
+  SymbolId addSymbol   (const SymbolInfo & info);
+  // Writes the contents of a scope to the standard output
+  void     printScope  (ScopeId sc) const;
 
   //////////////////////////////////////////////////////////////////
   // Class ScopeInfo: is declared inside SymTable and is private,
   // so only the SymTable can operate with Scope objects.
-  // It keeps the information of the symbols declared is one scope.
+  // It keeps the symbols declared in one scope, in the order in
+  // which they were declared, and in a hash table (open addressing
+  // with linear probing) to find them by their StringPool::Name.
+  // The table is filled and searched by the SymTable, which has the
+  // names of the symbols.
 
   class ScopeInfo {
   public:
@@ -139,81 +183,64 @@ private:
     // Accessor to get the name of the scope
     std::string getName () const;
 
-    // Mutators to add symbols to the scope
-    void addLocalVar  (const std::string & ident, TypesMgr::TypeId type);
-    void addParameter (const std::string & ident, TypesMgr::TypeId type);
-    void addFunction  (const std::string & ident, TypesMgr::TypeId type);
+    // Accessor to get the number of symbols declared in the scope
+    std::size_t getNumberOfSymbols () const;
 
-    // Accessor to check the existence of a symbol
-    bool findSymbol (const std::string & ident) const;
-
-    // Accessors to check the class of the symbol. If not found return false
-    bool isLocalVarClass  (const std::string & ident) const;
-    bool isParameterClass (const std::string & ident) const;
-    bool isFunctionClass  (const std::string & ident) const;
+    // For the name of the scope
+    std::string name;
+    // For remember the order in which the Ids where introduced.
+    std::vector<SymbolId> IdentsList;
+    // The hash table: a SymbolId or NoSymbol in each slot. Its size
+    // is a power of two, and it is never more than half full.
+    std::vector<SymbolId> Table;
 
-    // Accessor to get the TypeId of a symbol. The symbol MUST exist
-    TypesMgr::TypeId getType (const std::string & ident) const;
+  };  // class ScopeInfo
 
-    // Writes the contents of the scope to the standard output
-    void print (TypesMgr & Types) const;
 
-  private:
+  //////////////////////////////////////////////////////////////////
+  // Class SymbolInfo: is declared inside SymTable and is private,
+  // so only the SymTable can operate with SymbolInfo objects.
+  // It keeps the information of one symbol: its name, its symbol
+  // class (function, parameter or local variable) and its type
+  // (TypeId)
 
-    // Formard decration of class SymbolInfo
-    class SymbolInfo;
+  class SymbolInfo {
+  public:
+    enum SymClassId {
+      FirstSymClassId = -2,
+      ErrorClassId    = -1,      // "error" symbol class
+      // Normal symbol classes:
+      LocalVarId      =  0,      // local variables
+      ParameterId     ,          // parameters
+      FunctionId      ,          // functions
+      LastSymClassId  ,
+    };
+
+    // Constructors
+    SymbolInfo ();
+    SymbolInfo (StringPool::Name ident, SymClassId c, TypesMgr::TypeId tid);
+
+    // Accessors for working with the symbol attributes: name, class and type
+    StringPool::Name    getName          () const;
+    bool                isLocalVarClass  () const;
+    bool                isParameterClass () const;
+    bool                isFunctionClass  () const;
+    bool                isErrorClass     () const;
+    TypesMgr::TypeId    getType          () const;
+
+    // Method to convert a symbol class to its string representation
+    std::string class2string () const;
+
+    // Static methods to create SymbolInfo objects
+    static SymbolInfo createLocalVar  (StringPool::Name ident, TypesMgr::TypeId type);
+    static SymbolInfo createParameter (StringPool::Name ident, TypesMgr::TypeId type);
+    static SymbolInfo createFunction  (StringPool::Name ident, TypesMgr::TypeId type);
 
-    // For the name of the scope
-    std::string name;
-    // The information associated to each identifier declared in this scope.
-    std::map<std::string, SymbolInfo> SymbolsMap;
-    // For remember the order in which the Ids where introduced.
-    std::vector<std::string> IdentsList;
-
-
-    //////////////////////////////////////////////////////////////////
-    // Class SymbolInfo: is declared inside ScopeInfo and is private,
-    // so only the ScopeInfo can operate with SymbolInfo objects.
-    // It keeps the information of one symbol: its symbol class
-    // (function, parameter or local variable) and its type (TypeId)
-
-    class SymbolInfo {
-    public:
-      enum SymClassId {
-	FirstSymClassId = -2,
-	ErrorClassId    = -1,      // "error" symbol class
-	// Normal symbol classes:
-	LocalVarId      =  0,      // local variables
-	ParameterId     ,          // parameters
-	FunctionId      ,          // functions
-	LastSymClassId  ,
-      };
-
-      // Constructors
-      SymbolInfo ();
-      SymbolInfo (SymClassId c, TypesMgr::TypeId tid);
-
-      // Accessors for working with the symbol attributes: class and type
-      bool             isLocalVarClass  () const;
-      bool             isParameterClass () const;
-      bool             isFunctionClass  () const;
-      bool             isErrorClass     () const;
-      TypesMgr::TypeId getType          () const;
-
-      // Method to convert a symbol class to its string representation
-      std::string class2string () const;
-
-      // Static methods to create SymbolInfo objects
-      static SymbolInfo createLocalVar  (TypesMgr::TypeId type);
-      static SymbolInfo createParameter (TypesMgr::TypeId type);
-      static SymbolInfo createFunction  (TypesMgr::TypeId type);
-
-    private:
-      SymClassId       classId;
-      TypesMgr::TypeId type;
-
-    };  // class SymbolInfo
+  private:
+    StringPool::Name name;
+    SymClassId       classId;
+    TypesMgr::TypeId type;
 
-  };  // class ScopeInfo
+  };  // class SymbolInfo
 
 };  // class SymTable
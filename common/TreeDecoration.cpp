@@ -33,58 +33,233 @@
 #include "SymTable.h"
 #include "code.h"
 
-#include "antlr4-runtime.h"
 #include "antlr4-runtime.h"
 
 #include <string>
+#include <vector>
+#include <utility>    // std::move
+#include <cstdint>    // std::uintptr_t
+
+
+namespace {
+
+  // initial size of the hash table of nodes (a power of two)
+  const std::size_t INITIAL_SLOTS = 1024;
+
+  // default values of the attributes returned by reference
+  const operand         noOperand;
+  const std::string     noString;
+  const instructionList noCode;
+
+  std::size_t numFlags(unsigned char has) {
+    std::size_t n = 0;
+    for (; has; has &= has - 1)
+      ++n;
+    return n;
+  }
+
+}
+
+const std::size_t TreeDecoration::NO_ID = std::size_t(-1);
+
+TreeDecoration::TreeDecoration() :
+  Nodes(INITIAL_SLOTS, nullptr),
+  NodeIds(INITIAL_SLOTS, NO_ID),
+  NumNodes{0},
+  NumEntries{0} {
+}
+
+// Ids of the nodes:
+std::size_t TreeDecoration::home(antlr4::ParserRuleContext *ctx) const {
+  // nodes are aligned, so the low bits of their address are useless
+  std::uint64_t h = (reinterpret_cast<std::uintptr_t>(ctx) >> 4) * 0x9E3779B97F4A7C15ull;
+  return std::size_t(h ^ (h >> 32)) & (Nodes.size() - 1);
+}
+
+std::size_t TreeDecoration::slot(antlr4::ParserRuleContext *ctx) const {
+  std::size_t mask = Nodes.size() - 1;
+  std::size_t i = home(ctx);
+  while (Nodes[i] != nullptr and Nodes[i] != ctx)
+    i = (i + 1) & mask;
+  return i;
+}
 
+std::size_t TreeDecoration::find(antlr4::ParserRuleContext *ctx) const {
+  std::size_t i = slot(ctx);
+  return (Nodes[i] == ctx ? NodeIds[i] : NO_ID);
+}
+
+std::size_t TreeDecoration::getId(antlr4::ParserRuleContext *ctx) {
+  std::size_t i = slot(ctx);
+  if (Nodes[i] == ctx)
+    return NodeIds[i];
+  if (2 * (NumNodes + 1) > Nodes.size()) {
+    std::vector<antlr4::ParserRuleContext *> oldNodes(2 * Nodes.size(), nullptr);
+    std::vector<std::size_t>                 oldIds(2 * Nodes.size(), NO_ID);
+    oldNodes.swap(Nodes);
+    oldIds.swap(NodeIds);
+    for (std::size_t k = 0; k < oldNodes.size(); ++k) {
+      if (oldNodes[k] == nullptr) continue;
+      std::size_t j = slot(oldNodes[k]);
+      Nodes[j] = oldNodes[k];
+      NodeIds[j] = oldIds[k];
+    }
+    i = slot(ctx);
+  }
+  std::size_t id;
+  if (not FreeIds.empty()) {
+    id = FreeIds.back();
+    FreeIds.pop_back();
+  }
+  else {
+    id = Has.size();
+    Has.push_back(0);
+    ScopeDecor.push_back(0);
+    TypeDecor.push_back(0);
+    SymbolDecor.push_back(SymTable::NoSymbol);
+    IsLValueDecor.push_back(false);
+    AddrDecor.emplace_back();
+    OffsetDecor.emplace_back();
+    CodeDecor.emplace_back();
+  }
+  Nodes[i] = ctx;
+  NodeIds[i] = id;
+  ++NumNodes;
+  return id;
+}
+
+void TreeDecoration::mark(std::size_t id, unsigned char flag) {
+  if (not (Has[id] & flag)) {
+    Has[id] |= flag;
+    ++NumEntries;
+  }
+}
 
 // Getters:
-SymTable::ScopeId TreeDecoration::getScope(antlr4::ParserRuleContext *ctx) {
-  return ScopeDecor.get(ctx);
+SymTable::ScopeId TreeDecoration::getScope(antlr4::ParserRuleContext *ctx) const {
+  std::size_t id = find(ctx);
+  return (id == NO_ID ? 0 : ScopeDecor[id]);
+}
+
+TypesMgr::TypeId TreeDecoration::getType(antlr4::ParserRuleContext *ctx) const {
+  std::size_t id = find(ctx);
+  return (id == NO_ID ? 0 : TypeDecor[id]);
 }
 
-TypesMgr::TypeId TreeDecoration::getType(antlr4::ParserRuleContext *ctx) {
-  return TypeDecor.get(ctx);
+bool TreeDecoration::getIsLValue(antlr4::ParserRuleContext *ctx) const {
+  std::size_t id = find(ctx);
+  return (id == NO_ID ? false : IsLValueDecor[id]);
 }
 
-bool TreeDecoration::getIsLValue(antlr4::ParserRuleContext *ctx) {
-  return IsLValueDecor.get(ctx);
+SymTable::SymbolId TreeDecoration::getSymbol(antlr4::ParserRuleContext *ctx) const {
+  std::size_t id = find(ctx);
+  return (id == NO_ID ? SymTable::NoSymbol : SymbolDecor[id]);
 }
 
-std::string TreeDecoration::getAddr(antlr4::ParserRuleContext *ctx) {
-  return AddrDecor.get(ctx);
+const operand & TreeDecoration::getAddr(antlr4::ParserRuleContext *ctx) const {
+  std::size_t id = find(ctx);
+  return (id == NO_ID ? noOperand : AddrDecor[id]);
 }
 
-std::string TreeDecoration::getOffset(antlr4::ParserRuleContext *ctx) {
-  return OffsetDecor.get(ctx);
+const std::string & TreeDecoration::getOffset(antlr4::ParserRuleContext *ctx) const {
+  std::size_t id = find(ctx);
+  return (id == NO_ID ? noString : OffsetDecor[id]);
 }
 
-instructionList TreeDecoration::getCode(antlr4::ParserRuleContext *ctx) {
-  return CodeDecor.get(ctx);
+const instructionList & TreeDecoration::getCode(antlr4::ParserRuleContext *ctx) const {
+  std::size_t id = find(ctx);
+  return (id == NO_ID ? noCode : CodeDecor[id]);
+}
+
+instructionList TreeDecoration::takeCode(antlr4::ParserRuleContext *ctx) {
+  std::size_t id = find(ctx);
+  if (id == NO_ID or not (Has[id] & HAS_CODE))
+    return instructionList();
+  Has[id] &= ~HAS_CODE;
+  --NumEntries;
+  instructionList code = std::move(CodeDecor[id]);
+  CodeDecor[id].clear();
+  return code;
 }
 
 // Setters:
 void TreeDecoration::putScope(antlr4::ParserRuleContext *ctx, SymTable::ScopeId s) {
-  ScopeDecor.put(ctx, s);
+  std::size_t id = getId(ctx);
+  mark(id, HAS_SCOPE);
+  ScopeDecor[id] = s;
 }
 
 void TreeDecoration::putType(antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t) {
-  TypeDecor.put(ctx, t);
+  std::size_t id = getId(ctx);
+  mark(id, HAS_TYPE);
+  TypeDecor[id] = t;
+}
+
+void TreeDecoration::putSymbol(antlr4::ParserRuleContext *ctx, SymTable::SymbolId s) {
+  std::size_t id = getId(ctx);
+  mark(id, HAS_SYMBOL);
+  SymbolDecor[id] = s;
 }
 
 void TreeDecoration::putIsLValue(antlr4::ParserRuleContext *ctx, bool b) {
-  IsLValueDecor.put(ctx, b);
+  std::size_t id = getId(ctx);
+  mark(id, HAS_ISLVALUE);
+  IsLValueDecor[id] = b;
+}
+
+void TreeDecoration::putAddr(antlr4::ParserRuleContext *ctx, operand a) {
+  std::size_t id = getId(ctx);
+  mark(id, HAS_ADDR);
+  AddrDecor[id] = a;
+}
+
+void TreeDecoration::putOffset(antlr4::ParserRuleContext *ctx, std::string o) {
+  std::size_t id = getId(ctx);
+  mark(id, HAS_OFFSET);
+  OffsetDecor[id] = std::move(o);
 }
 
-void TreeDecoration::putAddr(antlr4::ParserRuleContext *ctx, const std::string & a) {
-  AddrDecor.put(ctx, a);
+void TreeDecoration::putCode(antlr4::ParserRuleContext *ctx, instructionList c) {
+  std::size_t id = getId(ctx);
+  mark(id, HAS_CODE);
+  CodeDecor[id] = std::move(c);
 }
 
-void TreeDecoration::putOffset(antlr4::ParserRuleContext *ctx, const std::string & o) {
-  OffsetDecor.put(ctx, o);
+void TreeDecoration::removeDecorations(antlr4::ParserRuleContext *ctx) {
+  std::size_t i = slot(ctx);
+  if (Nodes[i] != ctx)
+    return;
+  // free the attributes (and the memory they hold), and the id
+  std::size_t id = NodeIds[i];
+  NumEntries -= numFlags(Has[id]);
+  Has[id] = 0;
+  ScopeDecor[id] = 0;
+  TypeDecor[id] = 0;
+  SymbolDecor[id] = SymTable::NoSymbol;
+  IsLValueDecor[id] = false;
+  AddrDecor[id] = operand();
+  std::string().swap(OffsetDecor[id]);
+  instructionList().swap(CodeDecor[id]);
+  FreeIds.push_back(id);
+  // remove the node from the hash table, moving back the nodes after
+  // it that could not be in their home slot because of it
+  std::size_t mask = Nodes.size() - 1;
+  Nodes[i] = nullptr;
+  NodeIds[i] = NO_ID;
+  --NumNodes;
+  for (std::size_t j = (i + 1) & mask; Nodes[j] != nullptr; j = (j + 1) & mask) {
+    std::size_t h = home(Nodes[j]);
+    bool inPlace = (i <= j ? (i < h and h <= j) : (i < h or h <= j));
+    if (inPlace) continue;
+    Nodes[i] = Nodes[j];
+    NodeIds[i] = NodeIds[j];
+    Nodes[j] = nullptr;
+    NodeIds[j] = NO_ID;
+    i = j;
+  }
 }
 
-void TreeDecoration::putCode(antlr4::ParserRuleContext *ctx, const instructionList & c) {
-  CodeDecor.put(ctx, c);
+// Statistics:
+std::size_t TreeDecoration::getNumberOfEntries() const {
+  return NumEntries;
 }
@@ -34,7 +34,10 @@
 #include "code.h"
 
 #include "antlr4-runtime.h"
-#include "tree/ParseTreeProperty.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>    // std::size_t
 
 // using namespace std;
 
@@ -43,13 +46,15 @@
 // Class TreeDecoration: the nodes of the parser tree generated
 // by the antlr4 parser, whose base type is
 // antlr4::ParserRuleContext *, can have different attributes.
-// TreeDecoration groups all of them, and uses different
-// ParseTreeProperty to save this information.
-// Currently six kinds of attributes may be present:
+// TreeDecoration groups all of them. Each decorated node is given a
+// dense integer id (the first time it gets an attribute), and the
+// attributes are kept in one vector per kind, indexed by that id.
+// Currently seven kinds of attributes may be present:
 //   - scope, for nodes like the program, or functions
 //   - type, for expressions or type especification
+//   - symbol, for identifiers (the SymbolId they refer to)
 //   - isLValue, for expressions
-//   - addr, for expressions
+//   - addr, for expressions (the operand that holds their value)
 //   - offset, for expressions
 //   - code, for practicaly any node
 // Different listeners set and access these attributes:
@@ -58,40 +63,93 @@
 //       * set and access the type attribute (in type declarations)
 //   - TypeCheckListener   [TypeCheck phase 2]
 //       * access the scope attribute
+//       * set the symbol attribute (in identifiers)
 //       * set and access the type attribute (in expressions)
 //       * set and access the isLValue attribute (in expressions)
 //   - CodeGenListener     [Code Generation]
 //       * access the scope attribute
-//       * access the type attribute
+//       * access the type and symbol attributes
 //       * set and access the addr, offset and code attributes
+// Getting an attribute that a node does not have gives its default
+// value (0, false, SymTable::NoSymbol, an empty operand, or an empty
+// string or list).
 
 class TreeDecoration {
 
 public:
-  TreeDecoration() = default;
+  TreeDecoration();
+
+  // Getters (addr, offset and code by reference: valid until the
+  // next put or remove):
+  SymTable::ScopeId       getScope    (antlr4::ParserRuleContext *ctx) const;
+  TypesMgr::TypeId        getType     (antlr4::ParserRuleContext *ctx) const;
+  SymTable::SymbolId      getSymbol   (antlr4::ParserRuleContext *ctx) const;
+  bool                    getIsLValue (antlr4::ParserRuleContext *ctx) const;
+  const operand         & getAddr     (antlr4::ParserRuleContext *ctx) const;
+  const std::string     & getOffset   (antlr4::ParserRuleContext *ctx) const;
+  const instructionList & getCode     (antlr4::ParserRuleContext *ctx) const;
 
-  // Getters:
-  SymTable::ScopeId getScope    (antlr4::ParserRuleContext *ctx);
-  TypesMgr::TypeId  getType     (antlr4::ParserRuleContext *ctx);
-  bool              getIsLValue (antlr4::ParserRuleContext *ctx);
-  std::string       getAddr     (antlr4::ParserRuleContext *ctx);
-  std::string       getOffset   (antlr4::ParserRuleContext *ctx);
-  instructionList   getCode     (antlr4::ParserRuleContext *ctx);
+  // Move the code out of a node, which is left with no code (when
+  // the code of a node is used only once, it need not be copied)
+  instructionList takeCode (antlr4::ParserRuleContext *ctx);
 
-  // Setters:
+  // Setters (addr, offset and code are taken by value, and moved
+  // in: they can be attributes of another node, got by reference):
   void putScope    (antlr4::ParserRuleContext *ctx, SymTable::ScopeId s);
   void putType     (antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t);
+  void putSymbol   (antlr4::ParserRuleContext *ctx, SymTable::SymbolId s);
   void putIsLValue (antlr4::ParserRuleContext *ctx, bool b);
-  void putAddr     (antlr4::ParserRuleContext *ctx, const std::string & a);
-  void putOffset   (antlr4::ParserRuleContext *ctx, const std::string & o);
-  void putCode     (antlr4::ParserRuleContext *ctx, const instructionList & c);
+  void putAddr     (antlr4::ParserRuleContext *ctx, operand a);
+  void putOffset   (antlr4::ParserRuleContext *ctx, std::string o);
+  void putCode     (antlr4::ParserRuleContext *ctx, instructionList c);
+
+  // Remove all the attributes of a node (once they are no longer
+  // needed, to save memory). Its id will be given to another node.
+  void removeDecorations (antlr4::ParserRuleContext *ctx);
+
+  // Accessor to get the number of (node, attribute) entries stored
+  // so far, adding up all the attributes (statistics)
+  std::size_t getNumberOfEntries () const;
 
 private:
-  antlr4::tree::ParseTreeProperty<SymTable::ScopeId> ScopeDecor;
-  antlr4::tree::ParseTreeProperty<TypesMgr::TypeId>  TypeDecor;
-  antlr4::tree::ParseTreeProperty<bool>              IsLValueDecor;
-  antlr4::tree::ParseTreeProperty<std::string>       AddrDecor;
-  antlr4::tree::ParseTreeProperty<std::string>       OffsetDecor;
-  antlr4::tree::ParseTreeProperty<instructionList>   CodeDecor;
+  // Id of a node that has no attributes
+  static const std::size_t NO_ID;
+
+  // Flags of the attributes that a node has
+  enum : unsigned char {
+    HAS_SCOPE = 1, HAS_TYPE = 2, HAS_ISLVALUE = 4,
+    HAS_ADDR = 8, HAS_OFFSET = 16, HAS_CODE = 32, HAS_SYMBOL = 64
+  };
+
+  // Ids of the nodes: an open addressing hash table (with linear
+  // probing) from the node to its id. Its size is a power of two,
+  // and it is never more than half full.
+  std::vector<antlr4::ParserRuleContext *> Nodes;
+  std::vector<std::size_t>                 NodeIds;
+  std::size_t                              NumNodes;
+  // ids of removed nodes, to be reused
+  std::vector<std::size_t>                 FreeIds;
+
+  // The attributes, indexed by id
+  std::vector<unsigned char>     Has;
+  std::vector<SymTable::ScopeId> ScopeDecor;
+  std::vector<TypesMgr::TypeId>  TypeDecor;
+  std::vector<SymTable::SymbolId> SymbolDecor;
+  std::vector<unsigned char>     IsLValueDecor;
+  std::vector<operand>           AddrDecor;
+  std::vector<std::string>       OffsetDecor;
+  std::vector<instructionList>   CodeDecor;
+  std::size_t                    NumEntries;
+
+  // Slot of the hash table where the search of a node begins, and
+  // slot where it is (or where it would be inserted)
+  std::size_t home  (antlr4::ParserRuleContext *ctx) const;
+  std::size_t slot  (antlr4::ParserRuleContext *ctx) const;
+  // Id of a node, or NO_ID
+  std::size_t find  (antlr4::ParserRuleContext *ctx) const;
+  // Id of a node, which is given one if it has none
+  std::size_t getId (antlr4::ParserRuleContext *ctx);
+  // Set the flag of an attribute of node 'id'
+  void        mark  (std::size_t id, unsigned char flag);
 
 };  // class TreeDecoration
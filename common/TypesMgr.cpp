@@ -32,6 +32,8 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <unordered_map>
+#include <utility>    // std::pair
 
 #include <cstddef>    // std::size_t
 // uncomment to disable assert()
@@ -87,16 +89,38 @@ TypesMgr::TypeId TypesMgr::createVoidTy() {
 
 TypesMgr::TypeId TypesMgr::createFunctionTy(const std::vector<TypeId> & paramsTypes,
 					    TypeId returnType) {
-  TypesVec.push_back(Type(paramsTypes, returnType));
+  std::vector<TypeId> key(paramsTypes);
+  key.push_back(returnType);
+  auto it = FunctionTypes.find(key);
+  if (it != FunctionTypes.end())
+    return it->second;
+  FuncParamsVec.push_back(paramsTypes);
+  TypesVec.push_back(Type(TypeKind::FunctionKind, FuncParamsVec.size()-1, returnType));
+  FunctionTypes.emplace(std::move(key), TypesVec.size()-1);
   return TypesVec.size()-1;
 }
 
 TypesMgr::TypeId TypesMgr::createArrayTy(unsigned int size,
 					 TypeId elemType) {
-  TypesVec.push_back(Type{size, elemType});
+  auto it = ArrayTypes.find(std::make_pair(size, elemType));
+  if (it != ArrayTypes.end())
+    return it->second;
+  TypesVec.push_back(Type(TypeKind::ArrayKind, size, elemType));
+  ArrayTypes.emplace(std::make_pair(size, elemType), TypesVec.size()-1);
   return TypesVec.size()-1;
 }
 
+std::size_t TypesMgr::ArrayKeyHash::operator()(const std::pair<unsigned int, TypeId> & k) const {
+  return std::hash<TypeId>()(k.second * 0x9E3779B97F4A7C15ull ^ k.first);
+}
+
+std::size_t TypesMgr::FunctionKeyHash::operator()(const std::vector<TypeId> & k) const {
+  std::size_t h = k.size();
+  for (TypeId t : k)
+    h = h * 31 + t;
+  return std::hash<std::size_t>()(h);
+}
+
 // ----------------------------------------------------------------------
 // accessors for working with primitive types
 
@@ -149,7 +173,7 @@ bool TypesMgr::isFunctionTy(TypeId tid) const {
 const std::vector<TypesMgr::TypeId> & TypesMgr::getFuncParamsTypes(TypeId tid) const {
   const Type & t = TypesVec.at(tid);
   assert(t.isFunctionTy());
-  return t.getFuncParamsTypes();
+  return FuncParamsVec[t.getFuncParamsIndex()];
 }
 
 TypesMgr::TypeId TypesMgr::getFuncReturnType(TypeId tid) const {
@@ -159,15 +183,13 @@ TypesMgr::TypeId TypesMgr::getFuncReturnType(TypeId tid) const {
 }
 
 std::size_t TypesMgr::getNumOfParameters(TypeId tid) const {
-  const Type & t = TypesVec.at(tid);
-  assert(t.isFunctionTy());
-  return t.getNumOfParameters();
+  return getFuncParamsTypes(tid).size();
 }
 
 TypesMgr::TypeId TypesMgr::getParameterType(TypeId tid, unsigned int i) const {
-  const Type & t = TypesVec.at(tid);
-  assert(t.isFunctionTy() and i < t.getNumOfParameters());
-  return t.getParameterType(i);
+  const std::vector<TypeId> & params = getFuncParamsTypes(tid);
+  assert(i < params.size());
+  return params[i];
 }
 
 bool TypesMgr::isVoidFunction(TypeId tid) const {
@@ -201,38 +223,8 @@ TypesMgr::TypeId TypesMgr::getArrayElemType(TypeId tid) const {
 // methods for checking different compatibilities of Types
 
 bool TypesMgr::equalTypes(TypeId tid1, TypeId tid2) const {
-  if (tid1 == tid2)
-    return true;
-  const Type & t1 = TypesVec.at(tid1);
-  const Type & t2 = TypesVec.at(tid2);
-  if (t1.getTypeKind() != t2.getTypeKind())
-    return false;
-  if (t1.isPrimitiveTy() and t2.isPrimitiveTy())
-    return true;
-  if (t1.isFunctionTy()) {  // or: if (t2.isFunctionTy()) {
-    if (t1.getNumOfParameters() != t2.getNumOfParameters())
-      return false;
-    TypeId tid1_aux;
-    TypeId tid2_aux;
-    for (unsigned int i = 0; i < t1.getNumOfParameters(); ++i) {
-      tid1_aux = t1.getParameterType(i);
-      tid2_aux = t2.getParameterType(i);
-      if (not equalTypes(tid1_aux, tid2_aux))
-	return false;
-    }
-    tid1_aux = t1.getFuncReturnType();
-    tid2_aux = t2.getFuncReturnType();
-    return equalTypes(tid1_aux, tid2_aux);
-  }
-  if (t1.isArrayTy()) {  // or: if (t2.isArrayTy()) {
-    if (t1.getArraySize() != t2.getArraySize()) {
-      return false;
-    }
-    TypeId tid1_aux = t1.getArrayElemType();
-    TypeId tid2_aux = t2.getArrayElemType();
-    return equalTypes(tid1_aux, tid2_aux);
-  }
-  return false;
+  // equal compound types are created only once
+  return tid1 == tid2;
 }
 
 bool TypesMgr::comparableTypes(TypeId tid1, TypeId tid2,
@@ -273,6 +265,10 @@ std::size_t TypesMgr::getSizeOfType (TypeId tid) const {
 // ----------------------------------------------------------------------
 // methods to convert to string and print types
 
+std::size_t TypesMgr::getNumberOfTypes () const {
+  return TypesVec.size();
+}
+
 std::string TypesMgr::to_string(TypeId tid) const {
   if (isPrimitiveTy(tid) or isErrorTy(tid)) {
     switch (tid) {
@@ -288,12 +284,13 @@ std::string TypesMgr::to_string(TypeId tid) const {
   if (t.isFunctionTy()) {
     TypeId tid1;
     std::string s = "function<";
-    if (t.getNumOfParameters() > 0) {
-      tid1 = t.getParameterType(0);
+    const std::vector<TypeId> & params = FuncParamsVec[t.getFuncParamsIndex()];
+    if (params.size() > 0) {
+      tid1 = params[0];
       s = s + to_string(tid1);
     }
-    for (unsigned int i = 1; i < t.getNumOfParameters(); ++i) {
-      tid1 = t.getParameterType(i);
+    for (unsigned int i = 1; i < params.size(); ++i) {
+      tid1 = params[i];
       s = s + "," + to_string(tid1);
     }
     tid1 = t.getFuncReturnType();
@@ -323,21 +320,16 @@ void TypesMgr::dump(TypeId tid, std::ostream & os) const {
 // ----------------------------------------------------------------------
 // constructors
 
-TypesMgr::Type::Type(TypeKind tid) : ID{tid} {
+TypesMgr::Type::Type(TypeKind tid) : ID{tid}, info{0}, subTy{0} {
   assert(TypeKind::FirstPrimitiveKind < ID and
 	 ID < TypeKind::LastPrimitiveKind);
 }
 
-TypesMgr::Type::Type(const std::vector<TypeId> & paramsTypes, TypeId returnType) :
-  ID{TypesMgr::TypeKind::FunctionKind},
-  funcParamsTy{paramsTypes},
-  funcReturnTy{returnType} {
-  }
-
-TypesMgr::Type::Type(unsigned int arraySize, TypeId arrayElemType) :
-  ID{TypesMgr::TypeKind::ArrayKind},
-  arraySize{arraySize},
-  arrayElemTy{arrayElemType} {
+TypesMgr::Type::Type(TypeKind tid, std::size_t info, TypeId subType) :
+  ID{tid},
+  info{info},
+  subTy{subType} {
+  assert(ID == TypeKind::FunctionKind or ID == TypeKind::ArrayKind);
   }
 
 // ----------------------------------------------------------------------
@@ -398,21 +390,12 @@ bool TypesMgr::Type::isFunctionTy() const {
   return ID == TypeKind::FunctionKind;
 }
 
-const std::vector<TypesMgr::TypeId> & TypesMgr::Type::getFuncParamsTypes() const {
-  return funcParamsTy;
+std::size_t TypesMgr::Type::getFuncParamsIndex() const {
+  return info;
 }
 
 TypesMgr::TypeId TypesMgr::Type::getFuncReturnType() const {
-  return funcReturnTy;
-}
-
-std::size_t TypesMgr::Type::getNumOfParameters() const {
-  return getFuncParamsTypes().size();
-}
-
-TypesMgr::TypeId TypesMgr::Type::getParameterType(unsigned int i) const {
-  assert(i < getNumOfParameters());
-  return getFuncParamsTypes()[i];
+  return subTy;
 }
 
 bool TypesMgr::Type::isVoidFunction() const {
@@ -427,9 +410,9 @@ bool TypesMgr::Type::isArrayTy() const {
 }
 
 unsigned int TypesMgr::Type::getArraySize() const {
-  return arraySize;
+  return info;
 }
 
 TypesMgr::TypeId TypesMgr::Type::getArrayElemType() const {
-  return arrayElemTy;
+  return subTy;
 }
@@ -31,6 +31,8 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <unordered_map>
+#include <utility>    // std::pair
 
 #include <cstddef>    // std::size_t
 
@@ -46,6 +48,9 @@
 // integer, float, boolean, character and void. Also it
 // recognizes two compound types: functions and fixed-size
 // arrays. Finally there exist a special type 'error'.
+// Compound types are created only once: creating a type equal
+// to an existing one gives the TypeId of the existing one, so
+// two types are structurally equal iff their TypeId's are.
 
 class TypesMgr {
 
@@ -97,7 +102,7 @@ public:
   TypeId       getArrayElemType (TypeId tid) const;
 
   // Methods to check different compatibilities of types
-  //   - structurally equal?
+  //   - structurally equal? (the same TypeId)
   bool equalTypes      (TypeId tid1, TypeId tid2)     const;
   //   - comparable with the relational operator op?
   bool comparableTypes (TypeId tid1, TypeId tid2,
@@ -108,6 +113,9 @@ public:
   // Method to compute the size of a type (primitive type size = 1)
   std::size_t getSizeOfType (TypeId tid) const;
 
+  // Accessor to get the number of types created so far (statistics)
+  std::size_t getNumberOfTypes () const;
+
   // Methods to convert to string and print types
   std::string to_string (TypeId         tid)            const;
   void        dump      (TypeId         tid,
@@ -118,9 +126,24 @@ private:
   // Forward declaration of class Type
   class Type;
 
+  // Hash functions for the structure of compound types
+  struct ArrayKeyHash {
+    std::size_t operator() (const std::pair<unsigned int, TypeId> & k) const;
+  };
+  struct FunctionKeyHash {
+    std::size_t operator() (const std::vector<TypeId> & k) const;
+  };
+
   // Attributes:
   //   - vector to save the Types
   std::vector<Type> TypesVec;
+  //   - the types of the parameters of each function type
+  std::vector<std::vector<TypeId>> FuncParamsVec;
+  //   - the TypeId of each compound type, by its structure: the
+  //     size and element type of arrays, and the types of the
+  //     parameters followed by the return type of functions
+  std::unordered_map<std::pair<unsigned int, TypeId>, TypeId, ArrayKeyHash> ArrayTypes;
+  std::unordered_map<std::vector<TypeId>, TypeId, FunctionKeyHash>         FunctionTypes;
 
   // There are eight kinds of types:
   //   - an especial kind error,
@@ -160,18 +183,21 @@ private:
   // Class Type: is declared inside TypeMgr and is private,
   // so only the TypeMgr can operate with Type objects.
   // It keeps the information of any type. When a type is
-  // compound, the subtypes (for example the types of the parameters
-  // of a function, or the type of the elements of an array) are
-  // referenced by their respective TypeId's.
+  // compound, the subtypes (the return type of a function, or the
+  // type of the elements of an array) are referenced by their
+  // respective TypeId's. The types of the parameters of a function
+  // are kept by the TypesMgr (in FuncParamsVec), so that primitive
+  // and array Types are small.
   class Type {
 
   public:
-    // Constructors for primitive, function and array Types
+    // Constructors for primitive and compound (function and array)
+    // Types. For functions 'info' is the index of their parameters
+    // in FuncParamsVec, and for arrays their size.
     Type (TypeKind                    tid = TypeKind::VoidKind);
-    Type (const std::vector<TypeId> & paramsTypes,
-	  TypeId                      returnType);
-    Type (unsigned int                arraySize,
-	  TypeId                      arrayElemType);
+    Type (TypeKind                    tid,
+	  std::size_t                 info,
+	  TypeId                      subType);
 
     // Destructor
     ~Type () = default;
@@ -191,12 +217,10 @@ private:
     bool isPrimitiveNonVoidTy () const;
 
     // Accessors to work with function types
-    bool                        isFunctionTy       ()               const;
-    const std::vector<TypeId> & getFuncParamsTypes ()               const;
-    TypeId                      getFuncReturnType  ()               const;
-    std::size_t                 getNumOfParameters ()               const;
-    TypeId                      getParameterType   (unsigned int i) const;
-    bool                        isVoidFunction     ()               const;
+    bool        isFunctionTy       () const;
+    std::size_t getFuncParamsIndex () const;
+    TypeId      getFuncReturnType  () const;
+    bool        isVoidFunction     () const;
 
     // Accessors to work with array types
     bool         isArrayTy        () const;
@@ -208,12 +232,12 @@ private:
     // Atributes:
     //   - the kind of type
     TypeKind ID;
-    //   - to represent the type of a function:
-    std::vector<TypeId> funcParamsTy;
-    TypeId funcReturnTy;
-    //   - to represent the type of an array:
-    unsigned int arraySize;
-    TypeId arrayElemTy;
+    //   - to represent the type of a function: the index of its
+    //     parameters, and its return type
+    //   - to represent the type of an array: its size, and the
+    //     type of its elements
+    std::size_t info;
+    TypeId subTy;
 
   };  // class Type
 
@@ -0,0 +1,161 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "cfg.h"
+
+#include <algorithm>  // sort, lower_bound, reverse
+#include <utility>    // pair
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'flowGraph'
+
+flowGraph::flowGraph(const instructionList &lins) : blockOf(lins.size()) {
+  // leaders: the first instruction, the first of each run of LABELs,
+  // and the instruction after each jump or return
+  block b;
+  b.first = 0;
+  for (size_t i = 0; i < lins.size(); ++i) {
+    bool leader = (lins[i].oper == instruction::_LABEL and i > 0 and
+                   lins[i-1].oper != instruction::_LABEL);
+    if (i > 0) {
+      instruction::Operation prev = lins[i-1].oper;
+      leader = leader or prev == instruction::_UJUMP or prev == instruction::_FJUMP or
+               prev == instruction::_RETURN;
+    }
+    if (leader and i > b.first) {
+      b.last = i;
+      blocks.push_back(b);
+      b.first = i;
+    }
+    blockOf[i] = blocks.size();
+    if (lins[i].oper == instruction::_LABEL)
+      labelBlocks.push_back(make_pair(lins[i].arg1.value, blocks.size()));
+  }
+  b.last = lins.size();
+  blocks.push_back(b);
+  sort(labelBlocks.begin(), labelBlocks.end());
+
+  // edges
+  for (size_t k = 0; k < blocks.size(); ++k) {
+    block &bk = blocks[k];
+    vector<size_t> &succs = bk.succs;
+    instruction::Operation last = (bk.first < bk.last ? lins[bk.last-1].oper : instruction::_NOOP);
+    if (last == instruction::_UJUMP or last == instruction::_FJUMP) {
+      const operand &lab = (last == instruction::_UJUMP ? lins[bk.last-1].arg1 : lins[bk.last-1].arg2);
+      size_t target = block_of_label(lab);
+      if (target < blocks.size()) succs.push_back(target);
+    }
+    if (last != instruction::_UJUMP and last != instruction::_RETURN and k+1 < blocks.size() and
+        (succs.empty() or succs[0] != k+1))
+      succs.push_back(k+1);
+    for (size_t s : succs) blocks[s].preds.push_back(k);
+  }
+  order();
+  dominators();
+}
+
+size_t flowGraph::size() const { return blocks.size(); }
+const flowGraph::block & flowGraph::operator[](size_t b) const { return blocks[b]; }
+size_t flowGraph::block_of(size_t pc) const { return blockOf[pc]; }
+
+size_t flowGraph::block_of_label(const operand &lab) const {
+  auto it = lower_bound(labelBlocks.begin(), labelBlocks.end(), make_pair(lab.value, size_t(0)));
+  if (lab.kind != operand::_LABEL or it == labelBlocks.end() or it->first != lab.value)
+    return blocks.size();
+  return it->second;
+}
+
+const vector<size_t> & flowGraph::reverse_postorder() const { return rpo; }
+bool flowGraph::reachable(size_t b) const { return isReachable[b]; }
+size_t flowGraph::idom(size_t b) const { return idoms[b]; }
+const vector<size_t> & flowGraph::dominated(size_t b) const { return children[b]; }
+
+/// depth first search from the entry (with an explicit stack: graphs
+/// can be large), numbering the blocks as they are finished
+void flowGraph::order() {
+  isReachable.assign(blocks.size(), false);
+  vector<pair<size_t, size_t>> stack;     // block, next successor to visit
+  stack.push_back(make_pair(0, 0));
+  isReachable[0] = true;
+  while (not stack.empty()) {
+    pair<size_t, size_t> &top = stack.back();
+    const vector<size_t> &succs = blocks[top.first].succs;
+    if (top.second < succs.size()) {
+      size_t s = succs[top.second++];
+      if (not isReachable[s]) {
+        isReachable[s] = true;
+        stack.push_back(make_pair(s, 0));
+      }
+    }
+    else {
+      rpo.push_back(top.first);
+      stack.pop_back();
+    }
+  }
+  reverse(rpo.begin(), rpo.end());
+}
+
+/// the iterative algorithm of Cooper, Harvey and Kennedy ("A simple,
+/// fast dominance algorithm"): the dominators of a block are found
+/// by intersecting those of its predecessors, walking up the tree
+/// built so far, until nothing changes. In reverse postorder it takes
+/// a couple of passes for the graphs of structured code.
+void flowGraph::dominators() {
+  size_t n = blocks.size();
+  vector<size_t> number(n, n);           // position in reverse postorder
+  for (size_t k = 0; k < rpo.size(); ++k) number[rpo[k]] = k;
+  idoms.assign(n, n);
+  idoms[0] = 0;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t k = 1; k < rpo.size(); ++k) {
+      size_t b = rpo[k], dom = n;
+      for (size_t p : blocks[b].preds) {
+        if (idoms[p] == n) continue;       // not reached yet (or never)
+        if (dom == n) {
+          dom = p;
+          continue;
+        }
+        size_t x = p;
+        while (x != dom) {
+          while (number[x] > number[dom]) x = idoms[x];
+          while (number[dom] > number[x]) dom = idoms[dom];
+        }
+      }
+      if (idoms[b] != dom) {
+        idoms[b] = dom;
+        changed = true;
+      }
+    }
+  }
+  children.assign(n, vector<size_t>());
+  for (size_t k = 1; k < rpo.size(); ++k) children[idoms[rpo[k]]].push_back(rpo[k]);
+}
@@ -0,0 +1,104 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "code.h"
+
+////////////////////////////////////////////////////////////////////
+/// Class flowGraph: the control flow graph of the instructions of a
+/// subroutine, split in basic blocks.
+///
+/// A block starts at the first instruction, at a LABEL (several
+/// LABELs in a row start a single block) and after each UJUMP, FJUMP
+/// and RETURN, which end their block. A block jumps to the blocks of
+/// its labels, and falls through to the next one unless it ends in a
+/// UJUMP or a RETURN. Blocks with no successors are the exits of the
+/// subroutine: those that return, and the last one (falling off the
+/// end of a subroutine returns from it). A jump to a label that is
+/// not in the subroutine has no successor either.
+///
+/// The graph only keeps positions in the instruction list, so it must
+/// be built again after any change of the list.
+
+class flowGraph {
+ public:
+  /// a basic block: instructions [first, last) of the list, and the
+  /// blocks it can go to and come from
+  struct block {
+    std::size_t first, last;
+    std::vector<std::size_t> succs;
+    std::vector<std::size_t> preds;
+  };
+
+  /// build the graph of given instructions. There is always at least
+  /// one block (empty if there are no instructions): the entry, 0.
+  flowGraph(const instructionList &lins);
+
+  /// number of blocks
+  std::size_t size() const;
+  /// block number b
+  const block & operator[](std::size_t b) const;
+  /// block of the instruction at given position
+  std::size_t block_of(std::size_t pc) const;
+  /// block whose first instruction is the LABEL of given operand, or
+  /// size() if there is none
+  std::size_t block_of_label(const operand &lab) const;
+
+  /// blocks reachable from the entry, in reverse postorder (each
+  /// block before its successors, except along back edges)
+  const std::vector<std::size_t> & reverse_postorder() const;
+  /// whether block b can be reached from the entry
+  bool reachable(std::size_t b) const;
+
+  /// immediate dominator of block b: the last block before b in every
+  /// path from the entry to b (the entry for itself, and size() for
+  /// blocks that cannot be reached)
+  std::size_t idom(std::size_t b) const;
+  /// blocks whose immediate dominator is b (its children in the
+  /// dominator tree), in reverse postorder
+  const std::vector<std::size_t> & dominated(std::size_t b) const;
+
+ private:
+  std::vector<block> blocks;
+  std::vector<std::size_t> blockOf;       // block of each instruction
+  std::vector<std::size_t> rpo;
+  std::vector<bool> isReachable;
+  std::vector<std::size_t> idoms;
+  std::vector<std::vector<std::size_t>> children;
+  /// label (Id of its name) -> block, as a sorted vector of pairs
+  std::vector<std::pair<unsigned int, std::size_t>> labelBlocks;
+
+  // order the reachable blocks
+  void order();
+  // find the dominator tree
+  void dominators();
+};
@@ -27,64 +27,95 @@
 ////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <sstream>
+#include <iterator>   // make_move_iterator
+#include <utility>    // move
 #include "code.h"
 
 using namespace std;
 
 ////////////////////////////////////////////////////////////////////
-/// Implementation for class 'instruction'
+/// Implementation for class 'operand'
 
-/// Constructor
-instruction::instruction(Operation op,
-                         const std::string &a1, const std::string &a2, const std::string &a3) {
-  oper = op;
-  arg1 = a1;
-  arg2 = a2;
-  arg3 = a3;
+operand::operand() : kind(_NONE), value(0) {}
+operand::operand(Kind k, unsigned int v) : kind(k), value(v) {}
+
+operand operand::TEMP(unsigned int n) { return operand(_TEMP, n); }
+operand operand::NAME(StringPool::Id id) { return operand(_NAME, id); }
+operand operand::LABEL(StringPool::Id id) { return operand(_LABEL, id); }
+operand operand::INT(StringPool::Id id) { return operand(_INT, id); }
+operand operand::FLOAT(StringPool::Id id) { return operand(_FLOAT, id); }
+operand operand::CHAR(StringPool::Id id) { return operand(_CHAR, id); }
+
+bool operand::empty() const { return kind == _NONE; }
+bool operand::is_text() const { return kind != _NONE and kind != _TEMP; }
+
+bool operand::operator==(const operand &op) const { return kind == op.kind and value == op.value; }
+bool operand::operator!=(const operand &op) const { return not (*this == op); }
+
+string operand::dump(const StringPool &pool) const {
+  ostringstream os;
+  emit(os, pool);
+  return os.str();
+}
+
+void operand::emit(std::ostream &os, const StringPool &pool) const {
+  switch (kind) {
+  case _NONE : break;
+  case _TEMP : { os << '%' << value; break; }
+  default :    { os << *pool.name(value); break; }
+  }
 }
 
-instruction instruction::LABEL(const std::string &a1) { return instruction(_LABEL, a1); }
-instruction instruction::UJUMP(const std::string &a1) { return instruction(_UJUMP, a1); }
-instruction instruction::FJUMP(const std::string &a1, const std::string &a2) { return instruction(_FJUMP, a1, a2); }
-instruction instruction::PUSH(const std::string &a1) { return instruction(_PUSH, a1); }
-instruction instruction::POP(const std::string &a1) { return instruction(_POP, a1); }
-instruction instruction::CALL(const std::string &a1) { return instruction(_CALL, a1); }
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'instruction'
+
+/// Constructor
+instruction::instruction(Operation op, const operand &a1, const operand &a2, const operand &a3)
+  : oper(op), arg1(a1), arg2(a2), arg3(a3) {}
+
+instruction instruction::LABEL(const operand &a1) { return instruction(_LABEL, a1); }
+instruction instruction::UJUMP(const operand &a1) { return instruction(_UJUMP, a1); }
+instruction instruction::FJUMP(const operand &a1, const operand &a2) { return instruction(_FJUMP, a1, a2); }
+instruction instruction::PUSH(const operand &a1) { return instruction(_PUSH, a1); }
+instruction instruction::POP(const operand &a1) { return instruction(_POP, a1); }
+instruction instruction::CALL(const operand &a1) { return instruction(_CALL, a1); }
 instruction instruction::RETURN() { return instruction(_RETURN); }
-instruction instruction::ADD(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_ADD, a1, a2, a3); }
-instruction instruction::SUB(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_SUB, a1, a2, a3); }
-instruction instruction::MUL(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_MUL, a1, a2, a3); }
-instruction instruction::DIV(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_DIV, a1, a2, a3); }
-instruction instruction::EQ(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_EQ, a1, a2, a3); }
-instruction instruction::LT(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_LT, a1, a2, a3); }
-instruction instruction::LE(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_LE, a1, a2, a3); }
-instruction instruction::AND(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_AND, a1, a2, a3); }
-instruction instruction::OR(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_OR, a1, a2, a3); }
-instruction instruction::FADD(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FADD, a1, a2, a3); }
-instruction instruction::FSUB(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FSUB, a1, a2, a3); }
-instruction instruction::FMUL(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FMUL, a1, a2, a3); }
-instruction instruction::FDIV(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FDIV, a1, a2, a3); }
-instruction instruction::FEQ(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FEQ, a1, a2, a3); }
-instruction instruction::FLT(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FLT, a1, a2, a3); }
-instruction instruction::FLE(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FLE, a1, a2, a3); }
-instruction instruction::NOT(const std::string &a1, const std::string &a2) { return instruction(_NOT, a1, a2); }
-instruction instruction::NEG(const std::string &a1, const std::string &a2) { return instruction(_NEG, a1, a2); }
-instruction instruction::FNEG(const std::string &a1, const std::string &a2) { return instruction(_FNEG, a1, a2); }
-instruction instruction::FLOAT(const std::string &a1, const std::string &a2) { return instruction(_FLOAT, a1, a2); }  
-instruction instruction::LOAD(const std::string &a1, const std::string &a2) { return instruction(_LOAD, a1, a2); }
-instruction instruction::ILOAD(const std::string &a1, const std::string &a2) { return instruction(_ILOAD, a1, a2); }
-instruction instruction::CHLOAD(const std::string &a1, const std::string &a2) { return instruction(_CHLOAD, a1, a2); }
-instruction instruction::FLOAD(const std::string &a1, const std::string &a2) { return instruction(_FLOAD, a1, a2); }
-instruction instruction::XLOAD(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_XLOAD, a1, a2, a3); }
-instruction instruction::LOADX(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_LOADX, a1, a2, a3); }
-instruction instruction::ALOAD(const std::string &a1, const std::string &a2) { return instruction(_ALOAD, a1, a2); }
-instruction instruction::LOADC(const std::string &a1, const std::string &a2) { return instruction(_LOADC, a1, a2); }
-instruction instruction::CLOAD(const std::string &a1, const std::string &a2) { return instruction(_CLOAD, a1, a2); }
-instruction instruction::READI(const std::string &a1) { return instruction(_READI, a1); }
-instruction instruction::READF(const std::string &a1) { return instruction(_READF, a1); }
-instruction instruction::READC(const std::string &a1) { return instruction(_READC, a1); }
-instruction instruction::WRITEI(const std::string &a1) { return instruction(_WRITEI, a1); }
-instruction instruction::WRITEF(const std::string &a1) { return instruction(_WRITEF, a1); }
-instruction instruction::WRITEC(const std::string &a1) { return instruction(_WRITEC, a1); }
+instruction instruction::ADD(const operand &a1, const operand &a2, const operand &a3) { return instruction(_ADD, a1, a2, a3); }
+instruction instruction::SUB(const operand &a1, const operand &a2, const operand &a3) { return instruction(_SUB, a1, a2, a3); }
+instruction instruction::MUL(const operand &a1, const operand &a2, const operand &a3) { return instruction(_MUL, a1, a2, a3); }
+instruction instruction::DIV(const operand &a1, const operand &a2, const operand &a3) { return instruction(_DIV, a1, a2, a3); }
+instruction instruction::EQ(const operand &a1, const operand &a2, const operand &a3) { return instruction(_EQ, a1, a2, a3); }
+instruction instruction::LT(const operand &a1, const operand &a2, const operand &a3) { return instruction(_LT, a1, a2, a3); }
+instruction instruction::LE(const operand &a1, const operand &a2, const operand &a3) { return instruction(_LE, a1, a2, a3); }
+instruction instruction::AND(const operand &a1, const operand &a2, const operand &a3) { return instruction(_AND, a1, a2, a3); }
+instruction instruction::OR(const operand &a1, const operand &a2, const operand &a3) { return instruction(_OR, a1, a2, a3); }
+instruction instruction::FADD(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FADD, a1, a2, a3); }
+instruction instruction::FSUB(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FSUB, a1, a2, a3); }
+instruction instruction::FMUL(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FMUL, a1, a2, a3); }
+instruction instruction::FDIV(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FDIV, a1, a2, a3); }
+instruction instruction::FEQ(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FEQ, a1, a2, a3); }
+instruction instruction::FLT(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FLT, a1, a2, a3); }
+instruction instruction::FLE(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FLE, a1, a2, a3); }
+instruction instruction::NOT(const operand &a1, const operand &a2) { return instruction(_NOT, a1, a2); }
+instruction instruction::NEG(const operand &a1, const operand &a2) { return instruction(_NEG, a1, a2); }
+instruction instruction::FNEG(const operand &a1, const operand &a2) { return instruction(_FNEG, a1, a2); }
+instruction instruction::FLOAT(const operand &a1, const operand &a2) { return instruction(_FLOAT, a1, a2); }  
+instruction instruction::LOAD(const operand &a1, const operand &a2) { return instruction(_LOAD, a1, a2); }
+instruction instruction::ILOAD(const operand &a1, const operand &a2) { return instruction(_ILOAD, a1, a2); }
+instruction instruction::CHLOAD(const operand &a1, const operand &a2) { return instruction(_CHLOAD, a1, a2); }
+instruction instruction::FLOAD(const operand &a1, const operand &a2) { return instruction(_FLOAD, a1, a2); }
+instruction instruction::XLOAD(const operand &a1, const operand &a2, const operand &a3) { return instruction(_XLOAD, a1, a2, a3); }
+instruction instruction::LOADX(const operand &a1, const operand &a2, const operand &a3) { return instruction(_LOADX, a1, a2, a3); }
+instruction instruction::ALOAD(const operand &a1, const operand &a2) { return instruction(_ALOAD, a1, a2); }
+instruction instruction::LOADC(const operand &a1, const operand &a2) { return instruction(_LOADC, a1, a2); }
+instruction instruction::CLOAD(const operand &a1, const operand &a2) { return instruction(_CLOAD, a1, a2); }
+instruction instruction::READI(const operand &a1) { return instruction(_READI, a1); }
+instruction instruction::READF(const operand &a1) { return instruction(_READF, a1); }
+instruction instruction::READC(const operand &a1) { return instruction(_READC, a1); }
+instruction instruction::WRITEI(const operand &a1) { return instruction(_WRITEI, a1); }
+instruction instruction::WRITEF(const operand &a1) { return instruction(_WRITEF, a1); }
+instruction instruction::WRITEC(const operand &a1) { return instruction(_WRITEC, a1); }
 instruction instruction::WRITELN() { return instruction(_WRITELN); }
 instruction instruction::NOOP() { return instruction(_NOOP); }
 
@@ -92,58 +123,74 @@ instruction instruction::NOOP() { return instruction(_NOOP); }
 /// Destructor
 instruction::~instruction() {}
 
-string instruction::dump() const {
-  string s;
-  string ind="   ";
+string instruction::dump(const StringPool &pool) const {
+  ostringstream os;
+  emit(os, pool);
+  return os.str();
+}
+
+namespace {
+  // an operand, to be written with the pool of its code
+  struct inPool {
+    const operand &op;
+    const StringPool &pool;
+  };
+  std::ostream & operator<<(std::ostream &os, const inPool &x) {
+    x.op.emit(os, x.pool);
+    return os;
+  }
+}
+
+void instruction::emit(std::ostream &os, const StringPool &pool) const {
+  inPool a1{arg1, pool}, a2{arg2, pool}, a3{arg3, pool};
+  if (oper != instruction::_LABEL) os << "   ";
   switch (oper) {
-  case instruction::_LABEL : { s = "label " + arg1 + " :"; ind = ""; break; }
-  case instruction::_UJUMP : { s = "goto " + arg1; break; }
-  case instruction::_FJUMP : { s = "ifFalse " + arg1 + " goto " +arg2; break; }
+  case instruction::_LABEL : { os << "label " << a1 << " :"; break; }
+  case instruction::_UJUMP : { os << "goto " << a1; break; }
+  case instruction::_FJUMP : { os << "ifFalse " << a1 << " goto " << a2; break; }
   case instruction::_LOAD : 
   case instruction::_FLOAD : 
-  case instruction::_ILOAD : { s = arg1 + " = " + arg2; break; } 
-  case instruction::_CHLOAD : { s = arg1 + " = '" + arg2 +"'"; break; } 
-  case instruction::_PUSH : { s = "pushparam " + (arg1.empty()? "" : arg1); break; }
-  case instruction::_POP : { s = "popparam " + (arg1.empty()? "" : arg1); break; }
-  case instruction::_CALL : { s = "call " + arg1; break; }
-  case instruction::_RETURN : { s = "return"; break; }
-  case instruction::_XLOAD : { s = arg1 + "[" + arg2 + "] = " + arg3; break; }
-  case instruction::_LOADX : { s = arg1 + " = " + arg2 + "[" + arg3 + "]"; break; }
-  case instruction::_ALOAD : { s = arg1 + " = &" + arg2; break; }
-  case instruction::_LOADC : { s = arg1 + " = *" + arg2; break; }
-  case instruction::_CLOAD : { s = "*" + arg1 + " = " + arg2; break; }
-  case instruction::_READI : { s = "readi " + arg1; break; }
-  case instruction::_READF : { s = "readf " + arg1; break; }
-  case instruction::_READC : { s = "readc " + arg1; break; }
-  case instruction::_WRITEI : { s = "writei " + arg1; break; }
-  case instruction::_WRITEF : { s = "writef " + arg1; break; }
-  case instruction::_WRITEC : { s = "writec " + arg1; break; }
-  case instruction::_WRITELN : { s = "writeln"; break; }
-  case instruction::_ADD : { s = arg1 + " = " + arg2 + " + " + arg3; break; }
-  case instruction::_SUB : { s = arg1 + " = " + arg2 + " - " + arg3; break; }
-  case instruction::_MUL : { s = arg1 + " = " + arg2 + " * " + arg3; break; }
-  case instruction::_DIV : { s = arg1 + " = " + arg2 + " / " + arg3; break; }
-  case instruction::_AND : { s = arg1 + " = " + arg2 + " and " + arg3; break; }
-  case instruction::_OR : { s = arg1 + " = " + arg2 + " or " + arg3; break; }
-  case instruction::_EQ : { s = arg1 + " = " + arg2 + " == " + arg3; break; }
-  case instruction::_LT : { s = arg1 + " = " + arg2 + " < " + arg3; break; }
-  case instruction::_LE : { s = arg1 + " = " + arg2 + " <= " + arg3; break; }
-  case instruction::_NOT : { s = arg1 + " = not " + arg2; break; }
-  case instruction::_NEG : { s = arg1 + " = - " + arg2; break; }
-  case instruction::_FADD : { s = arg1 + " = " + arg2 + " +. " + arg3; break; }
-  case instruction::_FSUB : { s = arg1 + " = " + arg2 + " -. " + arg3; break; }
-  case instruction::_FMUL : { s = arg1 + " = " + arg2 + " *. " + arg3; break; }
-  case instruction::_FDIV : { s = arg1 + " = " + arg2 + " /. " + arg3; break; }
-  case instruction::_FEQ : { s = arg1 + " = " + arg2 + " ==. " + arg3; break; }
-  case instruction::_FLT : { s = arg1 + " = " + arg2 + " <. " + arg3; break; }
-  case instruction::_FLE : { s =  arg1 + " = " + arg2 + " <=. " + arg3; break; }
-  case instruction::_FNEG : { s =  arg1 + " = -. " + arg2; break; }
-  case instruction::_FLOAT : { s = arg1 + " = float " + arg2; break; }
-  case instruction::_NOOP : { s = "noop"; break; }
-  default : { s = "????"; break; }
+  case instruction::_ILOAD : { os << a1 << " = " << a2; break; } 
+  case instruction::_CHLOAD : { os << a1 << " = '" << a2 << "'"; break; } 
+  case instruction::_PUSH : { os << "pushparam " << a1; break; }
+  case instruction::_POP : { os << "popparam " << a1; break; }
+  case instruction::_CALL : { os << "call " << a1; break; }
+  case instruction::_RETURN : { os << "return"; break; }
+  case instruction::_XLOAD : { os << a1 << "[" << a2 << "] = " << a3; break; }
+  case instruction::_LOADX : { os << a1 << " = " << a2 << "[" << a3 << "]"; break; }
+  case instruction::_ALOAD : { os << a1 << " = &" << a2; break; }
+  case instruction::_LOADC : { os << a1 << " = *" << a2; break; }
+  case instruction::_CLOAD : { os << "*" << a1 << " = " << a2; break; }
+  case instruction::_READI : { os << "readi " << a1; break; }
+  case instruction::_READF : { os << "readf " << a1; break; }
+  case instruction::_READC : { os << "readc " << a1; break; }
+  case instruction::_WRITEI : { os << "writei " << a1; break; }
+  case instruction::_WRITEF : { os << "writef " << a1; break; }
+  case instruction::_WRITEC : { os << "writec " << a1; break; }
+  case instruction::_WRITELN : { os << "writeln"; break; }
+  case instruction::_ADD : { os << a1 << " = " << a2 << " + " << a3; break; }
+  case instruction::_SUB : { os << a1 << " = " << a2 << " - " << a3; break; }
+  case instruction::_MUL : { os << a1 << " = " << a2 << " * " << a3; break; }
+  case instruction::_DIV : { os << a1 << " = " << a2 << " / " << a3; break; }
+  case instruction::_AND : { os << a1 << " = " << a2 << " and " << a3; break; }
+  case instruction::_OR : { os << a1 << " = " << a2 << " or " << a3; break; }
+  case instruction::_EQ : { os << a1 << " = " << a2 << " == " << a3; break; }
+  case instruction::_LT : { os << a1 << " = " << a2 << " < " << a3; break; }
+  case instruction::_LE : { os << a1 << " = " << a2 << " <= " << a3; break; }
+  case instruction::_NOT : { os << a1 << " = not " << a2; break; }
+  case instruction::_NEG : { os << a1 << " = - " << a2; break; }
+  case instruction::_FADD : { os << a1 << " = " << a2 << " +. " << a3; break; }
+  case instruction::_FSUB : { os << a1 << " = " << a2 << " -. " << a3; break; }
+  case instruction::_FMUL : { os << a1 << " = " << a2 << " *. " << a3; break; }
+  case instruction::_FDIV : { os << a1 << " = " << a2 << " /. " << a3; break; }
+  case instruction::_FEQ : { os << a1 << " = " << a2 << " ==. " << a3; break; }
+  case instruction::_FLT : { os << a1 << " = " << a2 << " <. " << a3; break; }
+  case instruction::_FLE : { os << a1 << " = " << a2 << " <=. " << a3; break; }
+  case instruction::_FNEG : { os << a1 << " = -. " << a2; break; }
+  case instruction::_FLOAT : { os << a1 << " = float " << a2; break; }
+  case instruction::_NOOP : { os << "noop"; break; }
+  default : { os << "????"; break; }
   }
-
-  return ind + s;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -152,6 +199,9 @@ string instruction::dump() const {
 instructionList instruction::operator||(const instructionList &lst) const {
   return instructionList(*this) || lst;
 }
+instructionList instruction::operator||(instructionList &&lst) const {
+  return instructionList(*this) || std::move(lst);
+}
 
 
 ////////////////////////////////////////////////////////////////////
@@ -161,21 +211,44 @@ instructionList instruction::operator||(const instructionList &lst) const {
 instructionList::instructionList() {}
 // constructor from a single instruction
 instructionList::instructionList(const instruction &inst) { this->push_back(inst); }
+instructionList::instructionList(instruction &&inst) { this->push_back(std::move(inst)); }
 // destructor
 instructionList::~instructionList() {}
 
 // concatenation of lists (or list+instruction, via automatic coertion)
-instructionList instructionList::operator||(const instructionList &lst) const {
-  instructionList newlist = (*this);
+instructionList instructionList::operator||(const instructionList &lst) const & {
+  instructionList newlist;
+  newlist.reserve(size() + lst.size());
+  newlist.insert(newlist.end(), begin(), end());
   newlist.insert(newlist.end(), lst.begin(), lst.end());
   return newlist;
 }
+instructionList instructionList::operator||(instructionList &&lst) const & {
+  instructionList newlist;
+  newlist.reserve(size() + lst.size());
+  newlist.insert(newlist.end(), begin(), end());
+  newlist.insert(newlist.end(), make_move_iterator(lst.begin()), make_move_iterator(lst.end()));
+  return newlist;
+}
+// the left operand is a temporary: append to it (amortized O(|lst|))
+instructionList instructionList::operator||(const instructionList &lst) && {
+  insert(end(), lst.begin(), lst.end());
+  return std::move(*this);
+}
+instructionList instructionList::operator||(instructionList &&lst) && {
+  if (empty()) return std::move(lst);
+  insert(end(), make_move_iterator(lst.begin()), make_move_iterator(lst.end()));
+  return std::move(*this);
+}
 
 // print instructionList (for debugging)
-string instructionList::dump() const {
-  string s;  
-  for (auto i : *this ) s += i.dump() + "\n";
-  return s;
+string instructionList::dump(const StringPool &pool) const {
+  ostringstream os;
+  emit(os, pool);
+  return os.str();
+}
+void instructionList::emit(std::ostream &os, const StringPool &pool) const {
+  for (auto & i : *this ) { i.emit(os, pool); os << '\n'; }
 }
 
 
@@ -183,7 +256,7 @@ string instructionList::dump() const {
 /// Implementation for class 'var'
 
 /// constructor
-var::var(const std::string &n, size_t s) {
+var::var(StringPool::Id n, size_t s) {
   name = n;
   size = s;
 }
@@ -192,10 +265,14 @@ var::var(const std::string &n, size_t s) {
 var::~var() {}
 
 /// print (for debugging)
-string var::dump() const {
+string var::dump(const StringPool &pool) const {
   if (size != 0)
-    return name + " " + std::to_string(size);
-  return name;
+    return *pool.name(name) + " " + std::to_string(size);
+  return *pool.name(name);
+}
+void var::emit(std::ostream &os, const StringPool &pool) const {
+  os << *pool.name(name);
+  if (size != 0) os << ' ' << size;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -208,51 +285,69 @@ subroutine::~subroutine() {}
 /// get subroutine name
 string subroutine::get_name() const { return name; };
 /// add new variable
-void subroutine::add_var(const std::string &name, size_t sz) { vars.push_back(var(name,sz)); }
+void subroutine::add_var(StringPool::Id name, size_t sz) { vars.push_back(var(name,sz)); }
 /// add new parameter
-void subroutine::add_param(const std::string &name) { params.push_back(var(name,0)); }
+void subroutine::add_param(StringPool::Id name) { params.push_back(var(name,0)); }
 /// add new instruction
 void subroutine::add_instruction(const instruction &inst) {
-  if (inst.oper == instruction::_LABEL) labels.insert(make_pair(inst.arg1,instructions.size()));
+  if (inst.oper == instruction::_LABEL) labels.insert(make_pair(inst.arg1.value,instructions.size()));
   instructions.push_back(inst);
 }
 /// add instruction list to current instructions
 void subroutine::add_instructions(const instructionList &lins) {
-  for (auto i : lins)
+  instructions.reserve(instructions.size() + lins.size());
+  for (auto & i : lins)
     this->add_instruction(i);
 }
 /// set instruction list (overwritting current instructions)
 void subroutine::set_instructions(const instructionList &lins) {
   instructions.clear();
+  labels.clear();
   this->add_instructions(lins);
 }
+/// set instruction list, taking ownership of it
+void subroutine::set_instructions(instructionList &&lins) {
+  instructions = std::move(lins);
+  labels.clear();
+  for (size_t pc = 0; pc < instructions.size(); ++pc)
+    if (instructions[pc].oper == instruction::_LABEL)
+      labels.insert(make_pair(instructions[pc].arg1.value, pc));
+}
+/// get all instructions
+const instructionList & subroutine::get_instructions() const { return instructions; }
 /// get instruction at given program counter
 instruction subroutine::get_instruction_at(size_t pc) const {
   if (pc>=instructions.size()) return instruction(instruction::_INVALID);
   return instructions[pc];
 }
 /// get program counter for given label
-size_t subroutine::get_label_pc(std::string &lab) const { return labels.find(lab)->second; }
+size_t subroutine::get_label_pc(StringPool::Id lab) const {
+  return labels.find(lab)->second;
+}
 /// print (for debugging)
-string subroutine::dump() const {
-  string s;
-  s = "function " + name + "\n";
+string subroutine::dump(const StringPool &pool) const {
+  ostringstream os;
+  emit(os, pool);
+  return os.str();
+}
+/// write params, vars and instructions to given stream
+void subroutine::emit(std::ostream &os, const StringPool &pool) const {
+  os << "function " << name << "\n";
   if (not params.empty()) {
-    s += "  params\n" ;
-    for (auto p : params) s += "    " + p.dump() + "\n";
-    s += "  endparams\n\n";
+    os << "  params\n" ;
+    for (auto & p : params) { os << "    "; p.emit(os, pool); os << "\n"; }
+    os << "  endparams\n\n";
   }
   if (not vars.empty()) {
-    s += "  vars\n";
-    for (auto v : vars) s += "    " + v.dump() + "\n";
-    s += "  endvars\n\n";
+    os << "  vars\n";
+    for (auto & v : vars) { os << "    "; v.emit(os, pool); os << "\n"; }
+    os << "  endvars\n\n";
   }
 
-  string ind = "  ";
+  const char *ind = "  ";
   if (labels.empty()) ind="";
-  for (auto i : instructions) s += ind + i.dump() + "\n";  
-  s += "endfunction\n\n";
-  return s;
+  for (auto & i : instructions) { os << ind; i.emit(os, pool); os << "\n"; }
+  os << "endfunction\n\n";
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -263,6 +358,9 @@ code::code() {};
 /// destructor
 code::~code() {};
 
+/// get the pool of the operands
+StringPool & code::get_pool() { return pool; }
+const StringPool & code::get_pool() const { return pool; }
 /// get most recently added subroutine 
 subroutine& code::get_last_subroutine() { return subs[subs.size()-1]; }
 /// get subroutine by name
@@ -272,26 +370,35 @@ const subroutine& code::get_subroutine(const string &name) const {
 }
 /// add subroutine
 void code::add_subroutine(const subroutine &s) {
+  pool.intern(s.get_name());
   subs.push_back(s);
   names.insert(make_pair(s.get_name(), subs.size()-1));
 }
+void code::add_subroutine(subroutine &&s) {
+  pool.intern(s.get_name());
+  names.insert(make_pair(s.get_name(), subs.size()));
+  subs.push_back(std::move(s));
+}
+/// get all subroutines
+const std::vector<subroutine> & code::get_subroutines() const { return subs; }
+std::vector<subroutine> & code::get_subroutines() { return subs; }
 /// print (for debugging)
 string code::dump() const {
-  string c;
-  for (auto s : subs) c += s.dump();
-  return c;
+  ostringstream os;
+  emit(os);
+  return os.str();
+}
+/// write all subroutines to given stream
+void code::emit(std::ostream &os) const {
+  for (auto & s : subs) s.emit(os, pool);
 }
 
 
 ////////////////////////////////////////////////////////////////////
-/// Static methods to manage counters
-int counters::countIF = 0;
-int counters::countWHILE = 0;
-int counters::countTEMP = 0;
-
+/// Methods to manage counters
 string counters::newLabelIF() { return std::to_string(++countIF); }
 string counters::newLabelWHILE() { return std::to_string(++countWHILE); }
-string counters::newTEMP() { return std::to_string(++countTEMP); }
+operand counters::newTEMP() { return operand::TEMP(++countTEMP); }
 
 void counters::resetLabelIF() { countIF = 0; }
 void counters::resetLabelWHILE() { countWHILE = 0; }
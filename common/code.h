@@ -29,12 +29,63 @@
 #pragma once
 
 #include <map>
+#include <ostream>
 #include <list>
 #include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+
+#include "StringPool.h"
 
 /// predeclaration
 class instructionList;
 
+////////////////////////////////////////////////////////////////////
+/// Class operand stores one instruction argument as a typed handle:
+/// a temporary (%n), a name or label (its StringPool::Id in the pool
+/// of its code), or a constant (Id of its interned text, so that it is printed exactly
+/// as written, and an integer that does not fit in an int is kept
+/// as it is for the VM to deal with).
+
+class operand {
+
+ public:
+  /// operand kinds
+  typedef enum {_NONE, _TEMP, _NAME, _LABEL, _INT, _FLOAT, _CHAR} Kind;
+
+  /// operand kind
+  Kind kind;
+  /// temp number or StringPool::Id (depending on kind)
+  unsigned int value;
+
+  /// constructors (default is an empty operand)
+  operand();
+  operand(Kind k, unsigned int v);
+
+  /// ------ specific constructors for each kind -------
+  /// (all but TEMP take the Id of the name, label or text)
+  static operand TEMP(unsigned int n);
+  static operand NAME(StringPool::Id id);
+  static operand LABEL(StringPool::Id id);
+  static operand INT(StringPool::Id id);
+  static operand FLOAT(StringPool::Id id);
+  static operand CHAR(StringPool::Id id);
+
+  /// true for the empty operand (e.g. "pushparam" with no argument)
+  bool empty() const;
+  /// true for the kinds whose value is an Id (all but _NONE and _TEMP)
+  bool is_text() const;
+
+  bool operator==(const operand &op) const;
+  bool operator!=(const operand &op) const;
+
+  // print operand (textual t-code form), with the pool of its code
+  std::string dump(const StringPool &pool) const;
+  // write operand to given stream
+  void emit(std::ostream &os, const StringPool &pool) const;
+};
+
 ////////////////////////////////////////////////////////////////////
 /// Class instruction stores a VM instruction code with its operands
 
@@ -51,115 +102,130 @@ class instruction {
   /// instruction code
   Operation oper;
   /// arguments
-  std::string arg1, arg2, arg3;
+  operand arg1, arg2, arg3;
   
   /// constructor
-  instruction(Operation op,
-              const std::string &a1="", const std::string &a2="", const std::string &a3="");
+  instruction(Operation op, const operand &a1=operand(), const operand &a2=operand(), const operand &a3=operand());
+
+  /// copy and move (declared explicitly, since the destructor would
+  /// otherwise suppress the implicit move operations)
+  instruction(const instruction &) = default;
+  instruction(instruction &&) = default;
+  instruction & operator=(const instruction &) = default;
+  instruction & operator=(instruction &&) = default;
 
   /// destructor
   ~instruction();
 
   // concatenation of instruction+list (or instruction+instruction, via automatic coertion)
   instructionList operator||(const instructionList &lst) const;
+  instructionList operator||(instructionList &&lst) const;
 
   /// ------ specific constructors for each instruction -------
 
   // create new instruction "a1 :"
-  static instruction LABEL(const std::string &a1);
+  static instruction LABEL(const operand &a1);
   // create new instruction "goto a1"
-  static instruction UJUMP(const std::string &a1);
+  static instruction UJUMP(const operand &a1);
   // create new instruction "ifFalse a1 goto a2"
-  static instruction FJUMP(const std::string &a1, const std::string &a2);
+  static instruction FJUMP(const operand &a1, const operand &a2);
   // create new instruction "pushparam a1"
-  static instruction PUSH(const std::string &a1="");
+  static instruction PUSH(const operand &a1=operand());
   // create new instruction "popparam a1"
-  static instruction POP(const std::string &a1="");
+  static instruction POP(const operand &a1=operand());
   // create new instruction "call a1"
-  static instruction CALL(const std::string &a1);
+  static instruction CALL(const operand &a1);
   // create new instruction "return"
   static instruction RETURN();
   // create new instruction "a1 = a2 + a3"
-  static instruction ADD(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction ADD(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 - a3"
-  static instruction SUB(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction SUB(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 * a3"
-  static instruction MUL(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction MUL(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 / a3"
-  static instruction DIV(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction DIV(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 == a3"
-  static instruction EQ(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction EQ(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 < a3"
-  static instruction LT(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction LT(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 <= a3"
-  static instruction LE(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction LE(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 and a3"
-  static instruction AND(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction AND(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 or a3"
-  static instruction OR(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction OR(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 +. a3"
-  static instruction FADD(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FADD(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 -. a3"
-  static instruction FSUB(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FSUB(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 *. a3"
-  static instruction FMUL(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FMUL(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 /. a3"
-  static instruction FDIV(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FDIV(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 ==. a3"
-  static instruction FEQ(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FEQ(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 <. a3"
-  static instruction FLT(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FLT(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 <=. a3"
-  static instruction FLE(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FLE(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = not a2"
-  static instruction NOT(const std::string &a1, const std::string &a2);
+  static instruction NOT(const operand &a1, const operand &a2);
   // create new instruction "a1 = - a2"
-  static instruction NEG(const std::string &a1, const std::string &a2);
+  static instruction NEG(const operand &a1, const operand &a2);
   // create new instruction "a1 = -. a2"
-  static instruction FNEG(const std::string &a1, const std::string &a2);
+  static instruction FNEG(const operand &a1, const operand &a2);
   // create new instruction "a1 = float a2"
-  static instruction FLOAT(const std::string &a1, const std::string &a2);  
+  static instruction FLOAT(const operand &a1, const operand &a2);  
   // create new instruction "a1 = a2"
-  static instruction LOAD(const std::string &a1, const std::string &a2);
+  static instruction LOAD(const operand &a1, const operand &a2);
   // create new instruction "a1 = a2" (where a2 is an integer constant)
-  static instruction ILOAD(const std::string &a1, const std::string &a2);
+  static instruction ILOAD(const operand &a1, const operand &a2);
   // create new instruction "a1 = a2" (where a2 is a character constant)
-  static instruction CHLOAD(const std::string &a1, const std::string &a2);
+  static instruction CHLOAD(const operand &a1, const operand &a2);
   // create new instruction "a1 = a2" (where a2 is a float constant)
-  static instruction FLOAD(const std::string &a1, const std::string &a2);
+  static instruction FLOAD(const operand &a1, const operand &a2);
   // create new instruction "a1[a2] = a3" 
-  static instruction XLOAD(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction XLOAD(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2[a3]" 
-  static instruction LOADX(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction LOADX(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = &a2" 
-  static instruction ALOAD(const std::string &a1, const std::string &a2);
+  static instruction ALOAD(const operand &a1, const operand &a2);
   // create new instruction "a1 = *a2" 
-  static instruction LOADC(const std::string &a1, const std::string &a2);
+  static instruction LOADC(const operand &a1, const operand &a2);
   // create new instruction "*a1 = a2" 
-  static instruction CLOAD(const std::string &a1, const std::string &a2);
+  static instruction CLOAD(const operand &a1, const operand &a2);
   // create new instruction "readi a1" 
-  static instruction READI(const std::string &a1);
+  static instruction READI(const operand &a1);
   // create new instruction "readf a1" 
-  static instruction READF(const std::string &a1);
+  static instruction READF(const operand &a1);
   // create new instruction "readc a1" 
-  static instruction READC(const std::string &a1);
+  static instruction READC(const operand &a1);
   // create new instruction "writei a1" 
-  static instruction WRITEI(const std::string &a1); 
+  static instruction WRITEI(const operand &a1); 
   // create new instruction "writef a1" 
-  static instruction WRITEF(const std::string &a1);
+  static instruction WRITEF(const operand &a1);
   // create new instruction "writec a1" 
-  static instruction WRITEC(const std::string &a1);
+  static instruction WRITEC(const operand &a1);
   // create new instruction "writeln" 
   static instruction WRITELN();
   // create new instruction "noop" (not really needed) 
   static instruction NOOP();
   
   // print instruction
-  std::string dump() const;   
+  std::string dump(const StringPool &pool) const;
+  // write instruction to given stream (with its indentation, no newline)
+  void emit(std::ostream &os, const StringPool &pool) const;
 };
 
 ////////////////////////////////////////////////////////////////////
-/// Class instructionList stores a list of instructions
+/// Class instructionList stores a list of instructions.
+/// Concatenation with || copies both operands only when both are
+/// lvalues. When the left operand is an rvalue (a temporary, or a
+/// list passed through std::move) the right one is appended in place,
+/// so chains like  std::move(code) || code1 || code2 || inst  and
+/// accumulation loops  code = std::move(code) || ...  are linear in
+/// the total number of instructions.
 
 class instructionList : public std::vector<instruction> {
  public:
@@ -167,31 +233,45 @@ class instructionList : public std::vector<instruction> {
    instructionList();
    // constructor from a single instruction
    instructionList(const instruction &);
+   instructionList(instruction &&);
+   // copy and move
+   instructionList(const instructionList &) = default;
+   instructionList(instructionList &&) = default;
+   instructionList & operator=(const instructionList &) = default;
+   instructionList & operator=(instructionList &&) = default;
    // destructor
    ~instructionList();
 
    // concatenation of lists (or list+instruction, via automatic coertion)
-   instructionList operator||(const instructionList &lst) const;
+   instructionList operator||(const instructionList &lst) const &;
+   instructionList operator||(instructionList &&lst) const &;
+   // concatenation reusing the storage of the left operand
+   instructionList operator||(const instructionList &lst) &&;
+   instructionList operator||(instructionList &&lst) &&;
 
    // print instructionList
-   std::string dump() const;   
+   std::string dump(const StringPool &pool) const;
+   // write instructionList to given stream
+   void emit(std::ostream &os, const StringPool &pool) const;
 };
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// Class var stores a variable name and size
+/// Class var stores a variable name (its Id) and size
 
 class var {
  public:
-  std::string name;
+  StringPool::Id name;
   size_t size;
 
-  var(const std::string &n, size_t s);
+  var(StringPool::Id n, size_t s);
   ~var();
 
   // print var
-  std::string dump() const; 
+  std::string dump(const StringPool &pool) const;
+  // write var to given stream
+  void emit(std::ostream &os, const StringPool &pool) const;
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -204,8 +284,8 @@ class subroutine {
   std::string name;
   /// instructions
   instructionList instructions;
-  /// map label name -> position in instructions
-  std::map<std::string, size_t> labels;
+  /// map label (Id of its name) -> position in instructions
+  std::unordered_map<unsigned int, size_t> labels;
 
  public:
   /// list of local variables
@@ -215,32 +295,42 @@ class subroutine {
 
   /// constructor and destructor
   subroutine(const std::string &sname);
+  subroutine(const subroutine &) = default;
+  subroutine(subroutine &&) = default;
+  subroutine & operator=(const subroutine &) = default;
+  subroutine & operator=(subroutine &&) = default;
   ~subroutine();
 
   /// get subroutine name
   std::string get_name() const;
-  /// add a local var to subroutine
-  void add_var(const std::string &name, size_t sz);
+  /// add a local var to subroutine (name is the Id of its name)
+  void add_var(StringPool::Id name, size_t sz);
   /// add a parameter (size is always 1)
-  void add_param(const std::string &name);
+  void add_param(StringPool::Id name);
   /// add an instruction
   void add_instruction(const instruction &inst);
   /// add instruction list to current instructions
   void add_instructions(const instructionList &lins);
   /// set instruction list (overwritting current instructions)
   void set_instructions(const instructionList &lins);
+  void set_instructions(instructionList &&lins);
   
+  /// get all instructions
+  const instructionList & get_instructions() const;
   /// get instruction at given program counter in subroutine
   instruction get_instruction_at(size_t pc) const;
   /// get program counter in subroutine for given label
-  size_t get_label_pc(std::string &lab) const;
+  size_t get_label_pc(StringPool::Id lab) const;
 
   // print subroutine (params, vars, and instructions)
-  std::string dump() const;
+  std::string dump(const StringPool &pool) const;
+  // write subroutine to given stream
+  void emit(std::ostream &os, const StringPool &pool) const;
 };
 
 ////////////////////////////////////////////////////////////////////
-/// Class code stores a whole program (main plus subroutines)
+/// Class code stores a whole program (main plus subroutines), and
+/// the pool of the names and constants of its operands
 
 class code {
  private:
@@ -248,48 +338,64 @@ class code {
   std::vector<subroutine> subs;
   /// index to access subroutines by name
   std::map<std::string, size_t> names;
+  /// names and constants of the operands
+  StringPool pool;
   
  public:
   /// constructor and destructor
   code();
   ~code();
 
+  /// get the pool of the operands of the code
+  StringPool & get_pool();
+  const StringPool & get_pool() const;
+
   /// get most recently added subroutine (i.e. the one currently being processed)
   subroutine& get_last_subroutine();
   /// get subroutine by name
   const subroutine& get_subroutine(const std::string &name) const;
-  /// add new subroutine
+  /// add new subroutine (its name is added to the pool)
   void add_subroutine(const subroutine &s);
+  void add_subroutine(subroutine &&s);
+  /// get all subroutines, in the order they were added
+  const std::vector<subroutine> & get_subroutines() const;
+  std::vector<subroutine> & get_subroutines();
 
-  // print code (all info for all subroutines)
+  // print code (all info for all subroutines). For large programs
+  // prefer emit(), which does not build the whole text in memory
   std::string dump() const;
+  // write code to given stream
+  void emit(std::ostream &os) const;
 };
 
 
 ////////////////////////////////////////////////////////////////////
-/// Class counters manages temporal and labels counters
+/// Class counters manages temporal and labels counters. Each
+/// compilation has its own (the code generator keeps one), so
+/// several programs can be compiled at the same time.
 
 class counters {
  private:
-   static int countIF;
-   static int countWHILE;
-   static int countTEMP;
+   int countIF = 0;
+   int countWHILE = 0;
+   int countTEMP = 0;
   
  public:
-   // return id for new label or temp (id is a number, but returned as string
+   // return id for new label (id is a number, but returned as string
    // to ease concatenation with other literals (e.g. "labelIF" + "4" -> "LabelIF4")
-   static std::string newLabelIF();
-   static std::string newLabelWHILE();
-   static std::string newTEMP();
+   std::string newLabelIF();
+   std::string newLabelWHILE();
+   // return a new temp (%1, %2, ...)
+   operand newTEMP();
 
    // reset individual counters 
-   static void resetLabelIF();
-   static void resetLabelWHILE();
-   static void resetTEMP();
+   void resetLabelIF();
+   void resetLabelWHILE();
+   void resetTEMP();
 
    // reset label counters (IF and WHILE)
-   static void resetLabels();
+   void resetLabels();
    // reset all counters (IF, WHILE, and TEMP)
-   static void reset();
+   void reset();
 };
 
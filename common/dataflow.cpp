@@ -0,0 +1,493 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "dataflow.h"
+
+#include <deque>
+#include <unordered_set>
+#include <algorithm>  // reverse
+#include <utility>    // swap
+#include <cassert>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'bitSet'
+
+bitSet::bitSet() : n(0) {}
+bitSet::bitSet(size_t n, bool full) : n(n), words((n + 63) / 64, 0) {
+  if (full) fill();
+}
+
+size_t bitSet::size() const { return n; }
+bool bitSet::test(size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+void bitSet::set(size_t i) { words[i / 64] |= uint64_t(1) << (i % 64); }
+void bitSet::reset(size_t i) { words[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+
+void bitSet::clear() {
+  for (auto &w : words) w = 0;
+}
+
+void bitSet::fill() {
+  for (auto &w : words) w = ~uint64_t(0);
+  // keep the bits past the end clear, so that == and count() work
+  if (n % 64) words.back() = (uint64_t(1) << (n % 64)) - 1;
+}
+
+size_t bitSet::count() const {
+  size_t c = 0;
+  for (auto w : words) c += __builtin_popcountll(w);
+  return c;
+}
+
+bool bitSet::unite(const bitSet &s) {
+  uint64_t changed = 0;
+  for (size_t w = 0; w < words.size(); ++w) {
+    uint64_t old = words[w];
+    words[w] |= s.words[w];
+    changed |= old ^ words[w];
+  }
+  return changed != 0;
+}
+
+void bitSet::intersect(const bitSet &s) {
+  for (size_t w = 0; w < words.size(); ++w) words[w] &= s.words[w];
+}
+
+void bitSet::subtract(const bitSet &s) {
+  for (size_t w = 0; w < words.size(); ++w) words[w] &= ~s.words[w];
+}
+
+bool bitSet::operator==(const bitSet &s) const { return n == s.n and words == s.words; }
+bool bitSet::operator!=(const bitSet &s) const { return not (*this == s); }
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'varTable'
+
+const size_t varTable::NONE;
+
+uint64_t varTable::key(const operand &op) { return (uint64_t(op.kind) << 32) | op.value; }
+
+size_t varTable::add(const operand &op) {
+  auto it = ids.find(key(op));
+  if (it != ids.end()) return it->second;
+  ids[key(op)] = vars.size();
+  vars.push_back(op);
+  return vars.size() - 1;
+}
+
+varTable::varTable(const subroutine &s) {
+  // variables in memory: local arrays, local variables indexed as
+  // arrays, and any variable whose address is taken
+  unordered_set<unsigned int> locals;   // names of the local vars (Ids in the StringPool)
+  for (auto &v : s.vars) {
+    operand name = operand::NAME(v.name);
+    locals.insert(name.value);
+    if (v.size > 1) ids[key(name)] = NONE;
+  }
+  for (auto &ins : s.get_instructions()) {
+    if (ins.oper == instruction::_ALOAD and ins.arg2.kind == operand::_NAME)
+      ids[key(ins.arg2)] = NONE;
+    if (ins.oper == instruction::_XLOAD or ins.oper == instruction::_LOADX) {
+      const operand &base = (ins.oper == instruction::_XLOAD ? ins.arg1 : ins.arg2);
+      if (base.kind == operand::_NAME and locals.count(base.value))
+        ids[key(base)] = NONE;
+    }
+  }
+  // then the params, the local vars and every other variable used
+  for (auto &p : s.params) add(operand::NAME(p.name));
+  numParams = vars.size();
+  for (auto &v : s.vars) add(operand::NAME(v.name));
+  for (auto &ins : s.get_instructions()) {
+    const operand *args[3] = {&ins.arg1, &ins.arg2, &ins.arg3};
+    for (int k = 0; k < 3; ++k)
+      if (ins.oper != instruction::_CALL and
+          (args[k]->kind == operand::_TEMP or args[k]->kind == operand::_NAME))
+        add(*args[k]);
+  }
+}
+
+size_t varTable::size() const { return vars.size(); }
+size_t varTable::num_params() const { return numParams; }
+
+size_t varTable::id(const operand &op) const {
+  if (op.kind != operand::_TEMP and op.kind != operand::_NAME) return NONE;
+  auto it = ids.find(key(op));
+  return (it == ids.end() ? NONE : it->second);
+}
+
+bool varTable::in_memory(const operand &op) const {
+  if (op.kind != operand::_TEMP and op.kind != operand::_NAME) return false;
+  auto it = ids.find(key(op));
+  return it != ids.end() and it->second == NONE;
+}
+
+const operand & varTable::var(size_t v) const { return vars[v]; }
+
+varTable::effects varTable::effects_of(const instruction &ins) const {
+  effects e = {NONE, {NONE, NONE, NONE}, false, false, false};
+  int numUses = 0;
+  auto use = [&](const operand &op) {
+    size_t v = id(op);
+    if (v != NONE) e.uses[numUses++] = v;
+    else if (in_memory(op)) e.readsMemory = true;
+  };
+  auto def = [&](const operand &op) {
+    size_t v = id(op);
+    if (v != NONE) e.def = v;
+    else if (in_memory(op)) e.writesMemory = true;
+  };
+  switch (ins.oper) {
+  case instruction::_LABEL:
+  case instruction::_UJUMP:
+  case instruction::_NOOP:
+    break;
+  case instruction::_FJUMP:
+    use(ins.arg1);
+    break;
+  case instruction::_PUSH:
+    use(ins.arg1);
+    e.sideEffects = true;
+    break;
+  case instruction::_POP:
+    def(ins.arg1);
+    e.sideEffects = true;
+    break;
+  case instruction::_CALL:
+    e.readsMemory = e.writesMemory = e.sideEffects = true;
+    break;
+  case instruction::_RETURN:
+  case instruction::_WRITELN:
+    e.sideEffects = true;
+    break;
+  case instruction::_ILOAD:
+  case instruction::_FLOAD:
+  case instruction::_CHLOAD:
+  case instruction::_ALOAD:
+    def(ins.arg1);
+    break;
+  case instruction::_XLOAD:     // a1[a2] = a3
+    use(ins.arg1);
+    use(ins.arg2);
+    use(ins.arg3);
+    e.writesMemory = true;
+    break;
+  case instruction::_LOADX:     // a1 = a2[a3]
+    use(ins.arg2);
+    use(ins.arg3);
+    def(ins.arg1);
+    e.readsMemory = true;
+    break;
+  case instruction::_LOADC:     // a1 = *a2
+    use(ins.arg2);
+    def(ins.arg1);
+    e.readsMemory = true;
+    break;
+  case instruction::_CLOAD:     // *a1 = a2
+    use(ins.arg1);
+    use(ins.arg2);
+    e.writesMemory = true;
+    break;
+  case instruction::_READI:
+  case instruction::_READF:
+  case instruction::_READC:
+    def(ins.arg1);
+    e.sideEffects = true;
+    break;
+  case instruction::_WRITEI:
+  case instruction::_WRITEF:
+  case instruction::_WRITEC:
+    use(ins.arg1);
+    e.sideEffects = true;
+    break;
+  default:                      // a1 = a2 op a3, a1 = op a2, a1 = a2
+    use(ins.arg2);
+    use(ins.arg3);
+    def(ins.arg1);
+    break;
+  }
+  return e;
+}
+
+void varTable::globals(const flowGraph &g, const instructionList &lins,
+                       vector<size_t> &index, vector<size_t> &list) const {
+  index.assign(vars.size(), NONE);
+  list.clear();
+  for (size_t v = 0; v < numParams; ++v) {
+    index[v] = list.size();
+    list.push_back(v);
+  }
+  vector<size_t> defined(vars.size(), g.size());   // last block writing each variable
+  for (size_t b = 0; b < g.size(); ++b)
+    for (size_t i = g[b].first; i < g[b].last; ++i) {
+      effects e = effects_of(lins[i]);
+      for (size_t u : e.uses)
+        if (u != NONE and defined[u] != b and index[u] == NONE) {
+          index[u] = list.size();
+          list.push_back(u);
+        }
+      if (e.def != NONE) defined[e.def] = b;
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+/// Implementation of the dataflow solver
+
+void dataflow::solve(const flowGraph &g, const problem &p, solution &s) {
+  size_t n = g.size();
+  bool forward = (p.direction == FORWARD);
+  bitSet top(p.universe, p.meet == INTERSECTION);
+  s.in.assign(n, top);
+  s.out.assign(n, top);
+
+  // the reachable blocks in reverse postorder (postorder backwards),
+  // and then the rest
+  vector<size_t> order = g.reverse_postorder();
+  for (size_t b = 0; b < n; ++b)
+    if (not g.reachable(b)) order.push_back(b);
+  if (not forward) reverse(order.begin(), order.end());
+
+  deque<size_t> worklist(order.begin(), order.end());
+  vector<bool> listed(n, true);
+  bitSet value(p.universe);
+  while (not worklist.empty()) {
+    size_t b = worklist.front();
+    worklist.pop_front();
+    listed[b] = false;
+
+    // meet of the values coming into the block
+    const vector<size_t> &from = (forward ? g[b].preds : g[b].succs);
+    bool boundary = (forward ? b == 0 : g[b].succs.empty());
+    bitSet &entry = (forward ? s.in[b] : s.out[b]);
+    if (p.meet == UNION) entry.clear();
+    else entry.fill();
+    for (size_t f : from) {
+      const bitSet &v = (forward ? s.out[f] : s.in[f]);
+      if (p.meet == UNION) entry.unite(v);
+      else entry.intersect(v);
+    }
+    if (boundary) {
+      if (p.meet == UNION) entry.unite(p.boundary);
+      else if (from.empty()) entry = p.boundary;
+      else entry.intersect(p.boundary);
+    }
+
+    // transfer through the block
+    value = entry;
+    value.subtract(p.kill[b]);
+    value.unite(p.gen[b]);
+    bitSet &exit = (forward ? s.out[b] : s.in[b]);
+    if (value == exit) continue;
+    swap(exit, value);
+    for (size_t t : (forward ? g[b].succs : g[b].preds))
+      if (not listed[t]) {
+        listed[t] = true;
+        worklist.push_back(t);
+      }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'liveness'
+
+liveness::liveness(const flowGraph &g, const instructionList &lins, const varTable &vars) {
+  vars.globals(g, lins, globalIndex, globals);
+  dataflow::problem p;
+  p.direction = dataflow::BACKWARD;
+  p.meet = dataflow::UNION;
+  p.universe = globals.size();
+  p.gen.assign(g.size(), bitSet(p.universe));
+  p.kill.assign(g.size(), bitSet(p.universe));
+  p.boundary = bitSet(p.universe);
+  for (size_t v = 0; v < vars.num_params(); ++v) p.boundary.set(globalIndex[v]);
+  // walking each block backwards: gen are the variables read before
+  // they are written, kill those written
+  for (size_t b = 0; b < g.size(); ++b)
+    for (size_t i = g[b].last; i-- > g[b].first; ) {
+      varTable::effects e = vars.effects_of(lins[i]);
+      if (e.def != varTable::NONE and globalIndex[e.def] != varTable::NONE) {
+        p.kill[b].set(globalIndex[e.def]);
+        p.gen[b].reset(globalIndex[e.def]);
+      }
+      for (size_t u : e.uses)
+        if (u != varTable::NONE and globalIndex[u] != varTable::NONE) p.gen[b].set(globalIndex[u]);
+    }
+  dataflow::solve(g, p, sol);
+}
+
+bool liveness::live_in(size_t b, size_t v) const {
+  return globalIndex[v] != varTable::NONE and sol.in[b].test(globalIndex[v]);
+}
+
+bool liveness::live_out(size_t b, size_t v) const {
+  return globalIndex[v] != varTable::NONE and sol.out[b].test(globalIndex[v]);
+}
+
+bitSet liveness::live_out(size_t b) const {
+  bitSet live(globalIndex.size());
+  sol.out[b].for_each([&](size_t gv) { live.set(globals[gv]); });
+  return live;
+}
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'reachingDefs'
+
+reachingDefs::reachingDefs(const flowGraph &g, const instructionList &lins, const varTable &vars)
+  : defsOf(vars.size()) {
+  vector<size_t> globalIndex, globals;
+  vars.globals(g, lins, globalIndex, globals);
+  vector<size_t> defAt(lins.size(), varTable::NONE);   // definition at each position
+  for (size_t i = 0; i < lins.size(); ++i) {
+    size_t v = vars.effects_of(lins[i]).def;
+    if (v == varTable::NONE or globalIndex[v] == varTable::NONE) continue;
+    defAt[i] = positions.size();
+    defsOf[v].push_back(positions.size());
+    positions.push_back(i);
+  }
+
+  dataflow::problem p;
+  p.direction = dataflow::FORWARD;
+  p.meet = dataflow::UNION;
+  p.universe = positions.size();
+  p.gen.assign(g.size(), bitSet(p.universe));
+  p.kill.assign(g.size(), bitSet(p.universe));
+  p.boundary = bitSet(p.universe);
+  // gen: the last definition of each variable in the block; kill:
+  // all the definitions of the variables defined in the block (as a
+  // union of sets, not def by def: a variable may have thousands)
+  vector<bitSet> defsMask(vars.size());
+  vector<size_t> seen(vars.size(), g.size());   // last block defining each variable
+  for (size_t b = 0; b < g.size(); ++b)
+    for (size_t i = g[b].last; i-- > g[b].first; ) {
+      if (defAt[i] == varTable::NONE) continue;
+      size_t v = vars.effects_of(lins[i]).def;
+      if (seen[v] == b) continue;
+      seen[v] = b;
+      if (defsMask[v].size() == 0) {
+        defsMask[v] = bitSet(p.universe);
+        for (size_t d : defsOf[v]) defsMask[v].set(d);
+      }
+      p.kill[b].unite(defsMask[v]);
+      p.gen[b].set(defAt[i]);
+    }
+  dataflow::solve(g, p, sol);
+}
+
+size_t reachingDefs::size() const { return positions.size(); }
+size_t reachingDefs::position(size_t d) const { return positions[d]; }
+const bitSet & reachingDefs::reach_in(size_t b) const { return sol.in[b]; }
+const bitSet & reachingDefs::reach_out(size_t b) const { return sol.out[b]; }
+const vector<size_t> & reachingDefs::defs_of(size_t v) const { return defsOf[v]; }
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'availableExprs'
+
+bool availableExprs::is_expression(const instruction &ins) {
+  switch (ins.oper) {
+  case instruction::_ADD:  case instruction::_SUB:  case instruction::_MUL:  case instruction::_DIV:
+  case instruction::_EQ:   case instruction::_LT:   case instruction::_LE:
+  case instruction::_AND:  case instruction::_OR:
+  case instruction::_FADD: case instruction::_FSUB: case instruction::_FMUL: case instruction::_FDIV:
+  case instruction::_FEQ:  case instruction::_FLT:  case instruction::_FLE:
+  case instruction::_NOT:  case instruction::_NEG:  case instruction::_FNEG: case instruction::_FLOAT:
+    return true;
+  default:
+    return false;
+  }
+}
+
+uint64_t availableExprs::key(const instruction &ins) const {
+  uint64_t a = vars.id(ins.arg2), b = (ins.arg3.empty() ? 0 : vars.id(ins.arg3) + 1);
+  assert(a < (uint64_t(1) << 28) and b < (uint64_t(1) << 28));
+  bool commutative = (ins.oper == instruction::_ADD or ins.oper == instruction::_MUL or
+                      ins.oper == instruction::_EQ or ins.oper == instruction::_AND or
+                      ins.oper == instruction::_OR or ins.oper == instruction::_FADD or
+                      ins.oper == instruction::_FMUL or ins.oper == instruction::_FEQ);
+  if (commutative and b != 0 and b - 1 < a) {
+    uint64_t t = a;
+    a = b - 1;
+    b = t + 1;
+  }
+  return (uint64_t(ins.oper) << 56) | (a << 28) | b;
+}
+
+size_t availableExprs::expr_of(const instruction &ins) const {
+  if (not is_expression(ins) or vars.id(ins.arg2) == varTable::NONE or
+      (not ins.arg3.empty() and vars.id(ins.arg3) == varTable::NONE))
+    return varTable::NONE;
+  auto it = exprs.find(key(ins));
+  return (it == exprs.end() ? varTable::NONE : it->second);
+}
+
+availableExprs::availableExprs(const flowGraph &g, const instructionList &lins, const varTable &vars)
+  : vars(vars) {
+  vector<size_t> globalIndex, globals;
+  vars.globals(g, lins, globalIndex, globals);
+  // the expressions over global variables, and those using each one
+  vector<vector<size_t>> usedBy(vars.size());
+  for (size_t i = 0; i < lins.size(); ++i) {
+    const instruction &ins = lins[i];
+    if (not is_expression(ins)) continue;
+    size_t a = vars.id(ins.arg2), b = (ins.arg3.empty() ? a : vars.id(ins.arg3));
+    if (a == varTable::NONE or b == varTable::NONE or
+        globalIndex[a] == varTable::NONE or globalIndex[b] == varTable::NONE)
+      continue;
+    auto ins_ok = exprs.insert(make_pair(key(ins), positions.size()));
+    if (not ins_ok.second) continue;
+    usedBy[a].push_back(positions.size());
+    if (b != a) usedBy[b].push_back(positions.size());
+    positions.push_back(i);
+  }
+
+  dataflow::problem p;
+  p.direction = dataflow::FORWARD;
+  p.meet = dataflow::INTERSECTION;
+  p.universe = positions.size();
+  p.gen.assign(g.size(), bitSet(p.universe));
+  p.kill.assign(g.size(), bitSet(p.universe));
+  p.boundary = bitSet(p.universe);
+  // gen: expressions computed in the block and not killed after;
+  // kill: expressions with some operand written in the block
+  for (size_t b = 0; b < g.size(); ++b)
+    for (size_t i = g[b].first; i < g[b].last; ++i) {
+      size_t e = expr_of(lins[i]);
+      if (e != varTable::NONE) p.gen[b].set(e);
+      size_t v = vars.effects_of(lins[i]).def;
+      if (v == varTable::NONE) continue;
+      for (size_t k : usedBy[v]) {
+        p.gen[b].reset(k);
+        p.kill[b].set(k);
+      }
+    }
+  dataflow::solve(g, p, sol);
+}
+
+size_t availableExprs::size() const { return positions.size(); }
+size_t availableExprs::position(size_t e) const { return positions[e]; }
+const bitSet & availableExprs::avail_in(size_t b) const { return sol.in[b]; }
+const bitSet & availableExprs::avail_out(size_t b) const { return sol.out[b]; }
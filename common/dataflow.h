@@ -0,0 +1,276 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "code.h"
+#include "cfg.h"
+
+////////////////////////////////////////////////////////////////////
+/// Class bitSet: a set of integers in [0, size), one bit each, with
+/// the operations of the dataflow equations done a word at a time.
+
+class bitSet {
+ public:
+  /// empty set of given size (or full, if 'full')
+  bitSet();
+  explicit bitSet(std::size_t n, bool full = false);
+
+  std::size_t size() const;
+  bool test(std::size_t i) const;
+  void set(std::size_t i);
+  void reset(std::size_t i);
+  /// make it empty, or full
+  void clear();
+  void fill();
+  /// number of elements in the set
+  std::size_t count() const;
+
+  /// this = this U s. Returns whether this changed.
+  bool unite(const bitSet &s);
+  /// this = this ^ s
+  void intersect(const bitSet &s);
+  /// this = this - s
+  void subtract(const bitSet &s);
+
+  bool operator==(const bitSet &s) const;
+  bool operator!=(const bitSet &s) const;
+
+  /// call f(i) for each element i, in increasing order
+  template <class F> void for_each(F f) const {
+    for (std::size_t w = 0; w < words.size(); ++w)
+      for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1)
+        f(w * 64 + __builtin_ctzll(bits));
+  }
+
+ private:
+  std::size_t n;
+  std::vector<uint64_t> words;
+};
+
+////////////////////////////////////////////////////////////////////
+/// Class varTable numbers the variables of a subroutine (its params,
+/// local vars and temps) and tells what each instruction does with
+/// them.
+///
+/// Local arrays, and any variable whose address is taken (&x), are
+/// in memory: they can be read and written through pointers (here,
+/// or in the subroutines called from here), so they are not tracked
+/// one by one. Instructions that may read or write them are marked
+/// instead. All other variables are tracked, and get a number in
+/// [0, size()): first the params, in order, then the rest.
+
+class varTable {
+ public:
+  /// no variable
+  static const std::size_t NONE = std::size_t(-1);
+
+  /// what an instruction does: the tracked variable it writes (if
+  /// any), those it reads (NONE in unused places), whether it may
+  /// read or write variables in memory, and whether it has effects
+  /// outside the subroutine (calls, input and output, parameter
+  /// passing, return), so it cannot be removed even if the value it
+  /// writes is never used
+  struct effects {
+    std::size_t def;
+    std::size_t uses[3];
+    bool readsMemory;
+    bool writesMemory;
+    bool sideEffects;
+  };
+
+  /// number the variables of given subroutine
+  varTable(const subroutine &s);
+
+  /// number of tracked variables, and of params among them
+  std::size_t size() const;
+  std::size_t num_params() const;
+  /// number of a variable (NONE if it is not a tracked variable:
+  /// a constant, a label, a variable in memory, or empty)
+  std::size_t id(const operand &op) const;
+  /// whether the operand is a variable in memory
+  bool in_memory(const operand &op) const;
+  /// the operand of variable number v
+  const operand & var(std::size_t v) const;
+
+  /// effects of given instruction
+  effects effects_of(const instruction &ins) const;
+
+  /// the 'global' variables of the instructions: the params, and
+  /// those read in some block before being written in it (the only
+  /// ones whose value can flow from a block to another). Gives their
+  /// list, in the order they are found, and the position in it of
+  /// each variable (NONE if not global).
+  void globals(const flowGraph &g, const instructionList &lins,
+               std::vector<std::size_t> &index, std::vector<std::size_t> &list) const;
+
+ private:
+  std::vector<operand> vars;
+  std::size_t numParams;
+  /// operand (kind and value) -> number, or NONE for those in memory
+  std::unordered_map<uint64_t, std::size_t> ids;
+
+  static uint64_t key(const operand &op);
+  std::size_t add(const operand &op);
+};
+
+////////////////////////////////////////////////////////////////////
+/// Generic solver of dataflow problems of the gen/kill form on the
+/// blocks of a flowGraph, with sets as bitSets.
+///
+/// For each block b, out[b] = gen[b] U (in[b] - kill[b]) when going
+/// forward (in[b] = gen[b] U (out[b] - kill[b]) when going backward),
+/// and the value where the block is entered is the union, or the
+/// intersection, of the values of its predecessors (successors). The
+/// entry (the exits, going backward) also gets the 'boundary' value.
+/// Blocks are visited from a worklist, first in reverse postorder
+/// (postorder going backward), so most problems settle in a couple
+/// of passes.
+
+namespace dataflow {
+
+  typedef enum {FORWARD, BACKWARD} Direction;
+  typedef enum {UNION, INTERSECTION} Meet;
+
+  struct problem {
+    Direction direction;
+    Meet meet;
+    std::size_t universe;          // size of the sets
+    std::vector<bitSet> gen;       // for each block
+    std::vector<bitSet> kill;
+    bitSet boundary;
+  };
+
+  /// values at the entry (in) and at the exit (out) of each block
+  struct solution {
+    std::vector<bitSet> in;
+    std::vector<bitSet> out;
+  };
+
+  /// solve the problem on given graph
+  void solve(const flowGraph &g, const problem &p, solution &s);
+
+}  // namespace dataflow
+
+////////////////////////////////////////////////////////////////////
+/// Liveness of the tracked variables of a subroutine. Params are live
+/// when it returns (the caller pops them: that is how '_result' and
+/// other values get back).
+///
+/// Only variables that are read in some block before being written in
+/// it can be live between blocks, so the sets are over those alone
+/// (the 'global' variables); the liveness of the others, inside their
+/// block, is found by walking the block backwards from live_out().
+
+class liveness {
+ public:
+  liveness(const flowGraph &g, const instructionList &lins, const varTable &vars);
+
+  /// whether variable v is live at the entry / at the exit of block b
+  bool live_in(std::size_t b, std::size_t v) const;
+  bool live_out(std::size_t b, std::size_t v) const;
+  /// the variables live at the exit of block b, as a set over all
+  /// the tracked variables
+  bitSet live_out(std::size_t b) const;
+
+ private:
+  std::vector<std::size_t> globalIndex;   // variable -> global, or NONE
+  std::vector<std::size_t> globals;       // global -> variable
+  dataflow::solution sol;
+};
+
+////////////////////////////////////////////////////////////////////
+/// Reaching definitions: which instructions writing a tracked
+/// variable may have written its value at each point. Only the
+/// definitions of 'global' variables (see liveness) are in the sets.
+/// Its sets take (definitions x blocks) bits, the most of the three
+/// analyses: passes that only need to know what is live should use
+/// liveness instead.
+
+class reachingDefs {
+ public:
+  reachingDefs(const flowGraph &g, const instructionList &lins, const varTable &vars);
+
+  /// number of definitions in the sets, and the position of each one
+  /// in the instruction list
+  std::size_t size() const;
+  std::size_t position(std::size_t d) const;
+  /// definitions that reach the entry / the exit of block b
+  const bitSet & reach_in(std::size_t b) const;
+  const bitSet & reach_out(std::size_t b) const;
+  /// the definitions of variable v
+  const std::vector<std::size_t> & defs_of(std::size_t v) const;
+
+ private:
+  std::vector<std::size_t> positions;
+  std::vector<std::vector<std::size_t>> defsOf;
+  dataflow::solution sol;
+};
+
+////////////////////////////////////////////////////////////////////
+/// Available expressions: the computations a2 op a3 (or op a2) of the
+/// arithmetic, relational and logical instructions whose value is
+/// known to be in some variable at each point, because they have been
+/// computed on every path to it and their operands have not changed
+/// since. Only expressions whose operands are all 'global' variables
+/// (see liveness) can be available at the entry of a block where they
+/// are used, so the sets are over those alone.
+
+class availableExprs {
+ public:
+  availableExprs(const flowGraph &g, const instructionList &lins, const varTable &vars);
+
+  /// number of expressions in the sets, and the position of an
+  /// instruction that computes each one
+  std::size_t size() const;
+  std::size_t position(std::size_t e) const;
+  /// expression computed by given instruction, or varTable::NONE
+  std::size_t expr_of(const instruction &ins) const;
+  /// expressions available at the entry / at the exit of block b
+  const bitSet & avail_in(std::size_t b) const;
+  const bitSet & avail_out(std::size_t b) const;
+
+  /// whether the instruction computes an expression of this kind
+  static bool is_expression(const instruction &ins);
+
+ private:
+  const varTable &vars;
+  std::vector<std::size_t> positions;
+  /// (operation, operands) -> expression
+  std::unordered_map<uint64_t, std::size_t> exprs;
+  dataflow::solution sol;
+
+  // the operation and the numbers of the operands, in one word (in
+  // the same order for a2 op a3 and a3 op a2, if op is commutative)
+  uint64_t key(const instruction &ins) const;
+};
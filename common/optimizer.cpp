@@ -0,0 +1,911 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "optimizer.h"
+#include "cfg.h"
+#include "dataflow.h"
+#include "tcode.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <algorithm>  // sort, binary_search
+#include <cstdint>
+#include <cstdio>     // snprintf
+#include <cstdlib>    // strtof
+#include <cstring>    // memcpy
+#include <cmath>      // isfinite, fpclassify, fabs, signbit
+
+using namespace std;
+
+namespace {
+
+  ////////////////////////////////////////////////////////////////////
+  /// A value in the lattice of constant propagation: not known yet
+  /// (no path to here has been found to set it), a constant, or not
+  /// a constant. Constants are kept as the bits of a VM cell.
+
+  struct value {
+    enum State {TOP, CONST, BOTTOM} state;
+    bool isFloat;                 // a float (else an int, a char or a bool)
+    int32_t bits;
+
+    static value top() { return value{TOP, false, 0}; }
+    static value bottom() { return value{BOTTOM, false, 0}; }
+    static value integer(int32_t i) { return value{CONST, false, i}; }
+    static value real(float f) {
+      // no text for it in t-code, or none that tvm can read
+      if (not std::isfinite(f) or std::fpclassify(f) == FP_SUBNORMAL) return bottom();
+      value v{CONST, true, 0};
+      memcpy(&v.bits, &f, sizeof(float));
+      return v;
+    }
+
+    float f() const {
+      float r;
+      memcpy(&r, &bits, sizeof(float));
+      return r;
+    }
+    bool operator==(const value &v) const {
+      return state == v.state and (state != CONST or (bits == v.bits and isFloat == v.isFloat));
+    }
+    bool operator!=(const value &v) const { return not (*this == v); }
+  };
+
+  value meet(const value &x, const value &y) {
+    if (x.state == value::TOP) return y;
+    if (y.state == value::TOP) return x;
+    if (x == y) return x;
+    return value::bottom();
+  }
+
+  /// shortest text of a non-negative float, as digits.digits (the
+  /// only form t-code has), that reads back as the same float
+  string float_text(float f) {
+    char buf[64];
+    for (int precision = 1; precision <= 50; ++precision) {
+      snprintf(buf, sizeof(buf), "%.*f", precision, f);
+      if (strtof(buf, nullptr) == f) break;
+    }
+    return buf;
+  }
+
+  bool is_negative(const value &v) {
+    return v.isFloat ? std::signbit(v.f()) : v.bits < 0;
+  }
+
+  /// instructions that load constant v into x. t-code has no negative
+  /// constants (tvm rejects them), so those are loaded and negated.
+  /// Returns false for INT_MIN, which has no such form.
+  bool load_constant(const operand &x, const value &v, StringPool &pool, instructionList &out) {
+    if (v.isFloat) {
+      float f = v.f();
+      out.push_back(instruction(instruction::_FLOAD, x, operand::FLOAT(pool.id(pool.intern(float_text(std::fabs(f)))))));
+      if (std::signbit(f)) out.push_back(instruction(instruction::_FNEG, x, x));
+      return true;
+    }
+    if (v.bits == INT32_MIN) return false;
+    out.push_back(instruction(instruction::_ILOAD, x, operand::INT(pool.id(pool.intern(to_string(v.bits < 0 ? -v.bits : v.bits))))));
+    if (v.bits < 0) out.push_back(instruction(instruction::_NEG, x, x));
+    return true;
+  }
+
+  bool is_folded(const instruction &ins) {
+    return ins.oper == instruction::_LOAD or availableExprs::is_expression(ins);
+  }
+
+  ////////////////////////////////////////////////////////////////////
+  /// Constant propagation over the blocks of a subroutine: the value
+  /// of each variable as the instructions are simulated, and that of
+  /// the global ones at the entry of each block.
+
+  class constantPropagation {
+   public:
+    constantPropagation(const flowGraph &g, const instructionList &lins, const varTable &vars,
+                        const StringPool &pool);
+
+    /// whether some path from the entry reaches block b
+    bool executable(size_t b) const { return isExecutable[b]; }
+    /// set the values at the entry of block b, and simulate the
+    /// instructions of the block one by one
+    void enter(size_t b);
+    void step(const instruction &ins);
+    /// value of an operand now, and result of an instruction
+    value get(const operand &op) const;
+    value eval(const instruction &ins) const;
+
+   private:
+    const flowGraph &g;
+    const instructionList &lins;
+    const varTable &vars;
+    const StringPool &pool;
+    vector<size_t> globalIndex, globals;
+    vector<value> in;             // globals.size() values per block
+    vector<bool> isExecutable;
+    vector<value> current;        // value of every variable
+
+    // blocks where the current block (b) can go, given current values
+    void targets(size_t b, vector<size_t> &t) const;
+  };
+
+  constantPropagation::constantPropagation(const flowGraph &g, const instructionList &lins,
+                                           const varTable &vars, const StringPool &pool)
+    : g(g), lins(lins), vars(vars), pool(pool), isExecutable(g.size(), false),
+      current(vars.size(), value::top()) {
+    vars.globals(g, lins, globalIndex, globals);
+    size_t n = globals.size();
+    in.assign(g.size() * n, value::top());
+    // at the entry nothing is known: params come from the caller, and
+    // the rest are not initialized
+    for (size_t k = 0; k < n; ++k) in[k] = value::bottom();
+    isExecutable[0] = true;
+
+    deque<size_t> worklist(1, 0);
+    vector<bool> listed(g.size(), false);
+    listed[0] = true;
+    vector<size_t> t;
+    while (not worklist.empty()) {
+      size_t b = worklist.front();
+      worklist.pop_front();
+      listed[b] = false;
+      enter(b);
+      for (size_t i = g[b].first; i < g[b].last; ++i) step(lins[i]);
+      targets(b, t);
+      for (size_t s : t) {
+        bool changed = not isExecutable[s];
+        isExecutable[s] = true;
+        for (size_t k = 0; k < n; ++k) {
+          value v = meet(in[s*n + k], current[globals[k]]);
+          if (v != in[s*n + k]) {
+            in[s*n + k] = v;
+            changed = true;
+          }
+        }
+        if (changed and not listed[s]) {
+          listed[s] = true;
+          worklist.push_back(s);
+        }
+      }
+    }
+  }
+
+  void constantPropagation::enter(size_t b) {
+    // variables that are not global are always written in a block
+    // before they are read, so their values can be left as they were
+    size_t n = globals.size();
+    for (size_t k = 0; k < n; ++k) current[globals[k]] = in[b*n + k];
+  }
+
+  void constantPropagation::step(const instruction &ins) {
+    size_t d = vars.effects_of(ins).def;
+    if (d != varTable::NONE) current[d] = eval(ins);
+  }
+
+  value constantPropagation::get(const operand &op) const {
+    size_t v = vars.id(op);
+    return (v == varTable::NONE ? value::bottom() : current[v]);
+  }
+
+  value constantPropagation::eval(const instruction &ins) const {
+    switch (ins.oper) {
+    case instruction::_ILOAD:  {
+      // a constant that does not fit in an int is left for the VM
+      int n;
+      return tcode::int_value(*pool.name(ins.arg2.value), n) ? value::integer(n) : value::bottom();
+    }
+    case instruction::_FLOAD:  return value::real(strtof(pool.name(ins.arg2.value)->c_str(), nullptr));
+    case instruction::_CHLOAD: return value::integer(tcode::char_value(*pool.name(ins.arg2.value)));
+    case instruction::_LOAD:   return get(ins.arg2);
+    default: break;
+    }
+    if (not availableExprs::is_expression(ins)) return value::bottom();
+
+    value x = get(ins.arg2), y = (ins.arg3.empty() ? value::integer(0) : get(ins.arg3));
+    // a false operand of AND (or a true one of OR) is enough
+    if (ins.oper == instruction::_AND and ((x.state == value::CONST and x.bits == 0) or
+                                           (y.state == value::CONST and y.bits == 0)))
+      return value::integer(0);
+    if (ins.oper == instruction::_OR and ((x.state == value::CONST and x.bits != 0) or
+                                          (y.state == value::CONST and y.bits != 0)))
+      return value::integer(1);
+    if (x.state == value::BOTTOM or y.state == value::BOTTOM) return value::bottom();
+    if (x.state == value::TOP or y.state == value::TOP) return value::top();
+
+    // as in the VM: integers wrap around
+    uint32_t a = uint32_t(x.bits), b = uint32_t(y.bits);
+    switch (ins.oper) {
+    case instruction::_ADD:  return value::integer(int32_t(a + b));
+    case instruction::_SUB:  return value::integer(int32_t(a - b));
+    case instruction::_MUL:  return value::integer(int32_t(a * b));
+    case instruction::_DIV:
+      if (y.bits == 0 or (y.bits == -1 and x.bits == INT32_MIN)) return value::bottom();
+      return value::integer(x.bits / y.bits);
+    case instruction::_EQ:   return value::integer(x.bits == y.bits);
+    case instruction::_LT:   return value::integer(x.bits < y.bits);
+    case instruction::_LE:   return value::integer(x.bits <= y.bits);
+    case instruction::_NEG:  return value::integer(int32_t(0u - a));
+    case instruction::_NOT:  return value::integer(x.bits == 0);
+    case instruction::_AND:  return value::integer(x.bits != 0 and y.bits != 0);
+    case instruction::_OR:   return value::integer(x.bits != 0 or y.bits != 0);
+    case instruction::_FLOAT: return value::real(float(x.bits));
+    case instruction::_FADD: return value::real(x.f() + y.f());
+    case instruction::_FSUB: return value::real(x.f() - y.f());
+    case instruction::_FMUL: return value::real(x.f() * y.f());
+    case instruction::_FDIV: return value::real(x.f() / y.f());
+    case instruction::_FEQ:  return value::integer(x.f() == y.f());
+    case instruction::_FLT:  return value::integer(x.f() < y.f());
+    case instruction::_FLE:  return value::integer(x.f() <= y.f());
+    case instruction::_FNEG: return value::real(-x.f());
+    default: return value::bottom();
+    }
+  }
+
+  void constantPropagation::targets(size_t b, vector<size_t> &t) const {
+    t.clear();
+    const flowGraph::block &bk = g[b];
+    if (bk.first == bk.last or lins[bk.last-1].oper != instruction::_FJUMP) {
+      t = bk.succs;
+      return;
+    }
+    // an FJUMP jumps if its condition is false
+    value cond = get(lins[bk.last-1].arg1);
+    if (cond.state == value::TOP) return;           // not known yet
+    if (cond.state == value::BOTTOM or cond.bits == 0) {
+      size_t target = g.block_of_label(lins[bk.last-1].arg2);
+      if (target < g.size()) t.push_back(target);
+    }
+    if ((cond.state == value::BOTTOM or cond.bits != 0) and b+1 < g.size() and
+        (t.empty() or t[0] != b+1))
+      t.push_back(b+1);
+  }
+
+  /// positions (1, 2, 4 for arg1, arg2, arg3) of the operands read by
+  /// an instruction, and of those that are the base of an array
+  /// access (LOCAL if a local var, PTR otherwise, in the VM)
+  int read_args(const instruction &ins) {
+    switch (ins.oper) {
+    case instruction::_FJUMP: case instruction::_PUSH:
+    case instruction::_WRITEI: case instruction::_WRITEF: case instruction::_WRITEC:
+      return 1;
+    case instruction::_XLOAD: return 1 | 2 | 4;
+    case instruction::_LOADX: return 2 | 4;
+    case instruction::_LOADC: return 2;
+    case instruction::_CLOAD: return 1 | 2;
+    case instruction::_LOAD: return 2;
+    default:
+      return (availableExprs::is_expression(ins) ? 2 | 4 : 0);
+    }
+  }
+
+  int base_args(const instruction &ins) {
+    return (ins.oper == instruction::_XLOAD ? 1 : ins.oper == instruction::_LOADX ? 2 : 0);
+  }
+
+  /// whether the result of an instruction (in arg1) can be written to
+  /// another variable just by changing arg1
+  bool is_retargetable(const instruction &ins) {
+    switch (ins.oper) {
+    case instruction::_LOAD:  case instruction::_ILOAD: case instruction::_FLOAD:
+    case instruction::_CHLOAD: case instruction::_LOADX: case instruction::_LOADC:
+    case instruction::_ALOAD: case instruction::_POP:
+    case instruction::_READI: case instruction::_READF: case instruction::_READC:
+      return not ins.arg1.empty();
+    default:
+      return availableExprs::is_expression(ins);
+    }
+  }
+
+  /// whether an instruction is a copy between two tracked variables
+  bool is_copy(const instruction &ins, const varTable &vars) {
+    return ins.oper == instruction::_LOAD and vars.id(ins.arg1) != varTable::NONE and
+           vars.id(ins.arg2) != varTable::NONE;
+  }
+
+  ////////////////////////////////////////////////////////////////////
+  /// Value numbering over the dominator tree. Every value computed
+  /// gets a number, and so does every expression: the operation and
+  /// the numbers of its operands (and, for loads through memory, the
+  /// current memory state, which changes on every write to memory).
+  /// The state of a block is that of its immediate dominator, with
+  /// the changes of the region between them applied, and changes are
+  /// logged so they can be undone when leaving a subtree.
+
+  class valueNumbering {
+   public:
+    valueNumbering(const flowGraph &g, instructionList &lins, const varTable &vars,
+                   vector<bool> &removed);
+    /// how many instructions were replaced or removed
+    size_t reused() const { return numReused; }
+
+   private:
+    struct key {
+      uint64_t oper, a, b, memory;
+      bool operator==(const key &k) const {
+        return oper == k.oper and a == k.a and b == k.b and memory == k.memory;
+      }
+    };
+    struct keyHash {
+      size_t operator()(const key &k) const {
+        uint64_t h = k.oper;
+        h = h * 0x9E3779B97F4A7C15ull ^ k.a;
+        h = h * 0x9E3779B97F4A7C15ull ^ k.b;
+        h = h * 0x9E3779B97F4A7C15ull ^ k.memory;
+        return size_t(h ^ (h >> 29));
+      }
+    };
+    // a change to the state, to be undone
+    struct change {
+      enum {VAR, HOLDER, EXPR, MEMORY} what;
+      size_t slot;
+      size_t old;
+      key k;
+    };
+
+    // blocks visited when looking for writes between a block and its
+    // dominator; beyond that, all values are forgotten
+    static const size_t MAX_REGION = 4096;
+
+    const flowGraph &g;
+    instructionList &lins;
+    const varTable &vars;
+    vector<bool> &removed;
+    size_t numReused = 0;
+
+    size_t numValues = 1;              // 0 is "no number yet"
+    vector<size_t> valueOf;            // value held by each variable
+    vector<size_t> holder;             // a variable that held each value
+    unordered_map<key, size_t, keyHash> exprs;
+    size_t memory = 0;                 // state of memory (changes on writes)
+    vector<change> log;
+
+    vector<vector<size_t>> blockDefs;  // variables written in each block
+    vector<bool> blockWrites;          // ... and whether it writes memory
+    vector<size_t> seen;               // last region search that saw each block
+    size_t searches = 0;
+
+    size_t fresh();
+    size_t value_of(const operand &op);
+    void set_value(size_t v, size_t val);
+    void set_memory(size_t m);
+    bool make_key(const instruction &ins, key &k);
+    void enter(size_t b);
+    void visit(size_t b);
+    void undo(size_t mark);
+  };
+
+  bool is_commutative(instruction::Operation op) {
+    return op == instruction::_ADD or op == instruction::_MUL or op == instruction::_EQ or
+           op == instruction::_AND or op == instruction::_OR or op == instruction::_FADD or
+           op == instruction::_FMUL or op == instruction::_FEQ;
+  }
+
+  valueNumbering::valueNumbering(const flowGraph &g, instructionList &lins, const varTable &vars,
+                                 vector<bool> &removed)
+    : g(g), lins(lins), vars(vars), removed(removed), valueOf(vars.size(), 0), holder(1, varTable::NONE),
+      blockDefs(g.size()), blockWrites(g.size(), false), seen(g.size(), 0) {
+    for (size_t b = 0; b < g.size(); ++b)
+      for (size_t i = g[b].first; i < g[b].last; ++i) {
+        varTable::effects e = vars.effects_of(lins[i]);
+        if (e.def != varTable::NONE) blockDefs[b].push_back(e.def);
+        blockWrites[b] = blockWrites[b] or e.writesMemory;
+      }
+
+    // depth first over the dominator tree: block, next child, and
+    // the log position to go back to when leaving it
+    struct frame { size_t block, child, mark; };
+    vector<frame> stack;
+    stack.push_back(frame{0, 0, log.size()});
+    visit(0);
+    while (not stack.empty()) {
+      frame &top = stack.back();
+      const vector<size_t> &children = g.dominated(top.block);
+      if (top.child == children.size()) {
+        undo(top.mark);
+        stack.pop_back();
+        continue;
+      }
+      size_t b = children[top.child++];
+      stack.push_back(frame{b, 0, log.size()});
+      enter(b);
+      visit(b);
+    }
+  }
+
+  size_t valueNumbering::fresh() {
+    holder.push_back(varTable::NONE);
+    return numValues++;
+  }
+
+  size_t valueNumbering::value_of(const operand &op) {
+    size_t v = vars.id(op);
+    if (v == varTable::NONE) return fresh();     // in memory: could be anything
+    if (valueOf[v] == 0) set_value(v, fresh());
+    return valueOf[v];
+  }
+
+  void valueNumbering::set_value(size_t v, size_t val) {
+    log.push_back(change{change::VAR, v, valueOf[v], key()});
+    valueOf[v] = val;
+    size_t h = holder[val];
+    if (h == varTable::NONE or valueOf[h] != val) {
+      log.push_back(change{change::HOLDER, val, h, key()});
+      holder[val] = v;
+    }
+  }
+
+  void valueNumbering::set_memory(size_t m) {
+    log.push_back(change{change::MEMORY, 0, memory, key()});
+    memory = m;
+  }
+
+  bool valueNumbering::make_key(const instruction &ins, key &k) {
+    k = key{uint64_t(ins.oper), 0, 0, 0};
+    switch (ins.oper) {
+    case instruction::_ILOAD: case instruction::_FLOAD: case instruction::_CHLOAD:
+    case instruction::_ALOAD:
+      k.a = ins.arg2.value;
+      return true;
+    case instruction::_LOADX: {
+      // a local array by its name, a pointer by its value
+      size_t base = vars.id(ins.arg2);
+      k.a = (base == varTable::NONE ? (uint64_t(1) << 40) | ins.arg2.value : value_of(ins.arg2));
+      k.b = value_of(ins.arg3);
+      k.memory = memory;
+      return true;
+    }
+    case instruction::_LOADC:
+      k.a = value_of(ins.arg2);
+      k.memory = memory;
+      return true;
+    default:
+      break;
+    }
+    if (not availableExprs::is_expression(ins)) return false;
+    k.a = value_of(ins.arg2);
+    k.b = (ins.arg3.empty() ? 0 : value_of(ins.arg3));
+    if (is_commutative(ins.oper) and k.b < k.a) std::swap(k.a, k.b);
+    return true;
+  }
+
+  void valueNumbering::enter(size_t b) {
+    // the variables (and memory) that may be written after leaving
+    // the dominator: in the blocks that reach b without going through
+    // it (b included, if it is in a loop)
+    size_t dom = g.idom(b);
+    bool alone = true;
+    for (size_t p : g[b].preds)
+      alone = alone and p == dom;
+    if (alone) return;
+
+    ++searches;
+    vector<size_t> pending;
+    for (size_t p : g[b].preds)
+      if (p != dom and g.reachable(p) and seen[p] != searches) {
+        seen[p] = searches;
+        pending.push_back(p);
+      }
+    size_t visited = 0;
+    while (not pending.empty()) {
+      size_t x = pending.back();
+      pending.pop_back();
+      if (++visited > MAX_REGION) {
+        for (size_t v = 0; v < vars.size(); ++v) set_value(v, fresh());
+        set_memory(fresh());
+        return;
+      }
+      for (size_t v : blockDefs[x]) set_value(v, fresh());
+      if (blockWrites[x]) set_memory(fresh());
+      for (size_t p : g[x].preds)
+        if (p != dom and g.reachable(p) and seen[p] != searches) {
+          seen[p] = searches;
+          pending.push_back(p);
+        }
+    }
+  }
+
+  void valueNumbering::visit(size_t b) {
+    for (size_t i = g[b].first; i < g[b].last; ++i) {
+      instruction &ins = lins[i];
+      varTable::effects e = vars.effects_of(ins);
+      size_t d = e.def;
+      key k;
+      if (d != varTable::NONE and ins.oper == instruction::_LOAD and vars.id(ins.arg2) != varTable::NONE)
+        set_value(d, value_of(ins.arg2));
+      else if (d != varTable::NONE and make_key(ins, k)) {
+        auto it = exprs.find(k);
+        if (it == exprs.end()) {
+          size_t val = fresh();
+          exprs.insert(make_pair(k, val));
+          log.push_back(change{change::EXPR, 0, 0, k});
+          set_value(d, val);
+        }
+        else {
+          size_t val = it->second, h = holder[val];
+          if (h != varTable::NONE and valueOf[h] == val) {
+            ++numReused;
+            if (h == d) {
+              removed[i] = true;
+              continue;
+            }
+            ins = instruction(instruction::_LOAD, ins.arg1, vars.var(h));
+          }
+          set_value(d, val);
+        }
+      }
+      else if (d != varTable::NONE)
+        set_value(d, fresh());
+      if (e.writesMemory) set_memory(fresh());
+    }
+  }
+
+  void valueNumbering::undo(size_t mark) {
+    while (log.size() > mark) {
+      const change &c = log.back();
+      switch (c.what) {
+      case change::VAR:    valueOf[c.slot] = c.old; break;
+      case change::HOLDER: holder[c.slot] = c.old; break;
+      case change::EXPR:   exprs.erase(c.k); break;
+      case change::MEMORY: memory = c.old; break;
+      }
+      log.pop_back();
+    }
+  }
+
+  /// keep the instructions not marked as removed
+  void keep(subroutine &s, instructionList &lins, const vector<bool> &removed, size_t numRemoved) {
+    instructionList kept;
+    kept.reserve(lins.size() - numRemoved);
+    for (size_t i = 0; i < lins.size(); ++i)
+      if (not removed[i]) kept.push_back(std::move(lins[i]));
+    s.set_instructions(std::move(kept));
+  }
+
+  /// whether an instruction only writes its result: nothing else
+  /// happens if it is removed
+  bool is_pure(const instruction &ins) {
+    switch (ins.oper) {
+    case instruction::_LOAD:  case instruction::_ILOAD: case instruction::_FLOAD:
+    case instruction::_CHLOAD: case instruction::_ALOAD:
+      return true;
+    case instruction::_DIV:     // may divide by zero
+      return false;
+    default:
+      return availableExprs::is_expression(ins);
+    }
+  }
+
+  /// remove the loads of constants into variables that are not live
+  /// afterwards. Returns how many were removed.
+  size_t remove_dead_loads(subroutine &s) {
+    const instructionList &lins = s.get_instructions();
+    flowGraph g(lins);
+    varTable vars(s);
+    liveness live(g, lins, vars);
+    vector<bool> dead(lins.size(), false);
+    size_t removed = 0;
+    for (size_t b = 0; b < g.size(); ++b) {
+      bitSet l = live.live_out(b);
+      for (size_t i = g[b].last; i-- > g[b].first; ) {
+        instruction::Operation op = lins[i].oper;
+        varTable::effects e = vars.effects_of(lins[i]);
+        if ((op == instruction::_ILOAD or op == instruction::_FLOAD or op == instruction::_CHLOAD) and
+            e.def != varTable::NONE and not l.test(e.def)) {
+          dead[i] = true;
+          ++removed;
+          continue;
+        }
+        if (e.def != varTable::NONE) l.reset(e.def);
+        for (size_t u : e.uses)
+          if (u != varTable::NONE) l.set(u);
+      }
+    }
+    if (removed == 0) return 0;
+    instructionList kept;
+    kept.reserve(lins.size() - removed);
+    for (size_t i = 0; i < lins.size(); ++i)
+      if (not dead[i]) kept.push_back(lins[i]);
+    s.set_instructions(std::move(kept));
+    return removed;
+  }
+
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation of the passes
+
+optimizer::counts & optimizer::counts::operator+=(const counts &c) {
+  constantsFolded += c.constantsFolded;
+  branchesFolded += c.branchesFolded;
+  loadsRemoved += c.loadsRemoved;
+  movesRemoved += c.movesRemoved;
+  valuesReused += c.valuesReused;
+  unreachableRemoved += c.unreachableRemoved;
+  jumpsRemoved += c.jumpsRemoved;
+  labelsRemoved += c.labelsRemoved;
+  deadStoresRemoved += c.deadStoresRemoved;
+  return *this;
+}
+
+void optimizer::propagate_constants(subroutine &s, StringPool &pool, counts &c) {
+  const instructionList &lins = s.get_instructions();
+  flowGraph g(lins);
+  varTable vars(s);
+  constantPropagation cp(g, lins, vars, pool);
+
+  // rewrite the blocks that can be executed, simulating them again
+  instructionList out;
+  out.reserve(lins.size());
+  bool changed = false;
+  for (size_t b = 0; b < g.size(); ++b) {
+    if (not cp.executable(b)) {
+      out.insert(out.end(), lins.begin() + g[b].first, lins.begin() + g[b].last);
+      continue;
+    }
+    cp.enter(b);
+    for (size_t i = g[b].first; i < g[b].last; ++i) {
+      const instruction &ins = lins[i];
+      if (ins.oper == instruction::_FJUMP and cp.get(ins.arg1).state == value::CONST) {
+        if (cp.get(ins.arg1).bits == 0) out.push_back(instruction(instruction::_UJUMP, ins.arg2));
+        ++c.branchesFolded;
+        changed = true;
+        continue;
+      }
+      value v = cp.eval(ins);
+      cp.step(ins);
+      // (a negation with a negative result is already the way to load it)
+      bool negation = (ins.oper == instruction::_NEG or ins.oper == instruction::_FNEG);
+      if (is_folded(ins) and v.state == value::CONST and not (negation and is_negative(v)) and
+          vars.effects_of(ins).def != varTable::NONE and load_constant(ins.arg1, v, pool, out)) {
+        ++c.constantsFolded;
+        changed = true;
+        continue;
+      }
+      out.push_back(ins);
+    }
+  }
+  if (changed) s.set_instructions(std::move(out));
+  c.loadsRemoved += remove_dead_loads(s);
+}
+
+void optimizer::number_values(subroutine &s, counts &c) {
+  instructionList lins = s.get_instructions();
+  flowGraph g(lins);
+  varTable vars(s);
+  vector<bool> removed(lins.size(), false);
+  valueNumbering vn(g, lins, vars, removed);
+  if (vn.reused() == 0) return;
+  keep(s, lins, removed, 0);
+  c.valuesReused += vn.reused();
+}
+
+void optimizer::propagate_copies(subroutine &s, counts &c) {
+  instructionList lins = s.get_instructions();
+  flowGraph g(lins);
+  varTable vars(s);
+  liveness live(g, lins, vars);
+  const long NONE = -1;
+  vector<bool> removed(lins.size(), false);
+  size_t numRemoved = 0;
+  // last position where each variable was written and read in the
+  // current block (reset for those touched, at the end of the block)
+  vector<long> lastDef(vars.size(), NONE), lastUse(vars.size(), NONE);
+  vector<size_t> touched;
+  // copies in effect: copyOf[x] = y after x = y (NONE if none)
+  vector<size_t> copyOf(vars.size(), varTable::NONE);
+  vector<size_t> copies;
+  vector<bool> deadSource;
+
+  for (size_t b = 0; b < g.size(); ++b) {
+    size_t first = g[b].first, last = g[b].last;
+
+    // which copies are the last use of their source
+    deadSource.assign(last - first, false);
+    bitSet l = live.live_out(b);
+    for (size_t i = last; i-- > first; ) {
+      varTable::effects e = vars.effects_of(lins[i]);
+      if (is_copy(lins[i], vars)) deadSource[i - first] = not l.test(vars.id(lins[i].arg2));
+      if (e.def != varTable::NONE) l.reset(e.def);
+      for (size_t u : e.uses)
+        if (u != varTable::NONE) l.set(u);
+    }
+
+    // coalescing: %t = ...; x = %t  ==>  x = ...
+    for (size_t i = first; i < last; ++i) {
+      const instruction &ins = lins[i];
+      if (is_copy(ins, vars) and deadSource[i - first]) {
+        size_t d = vars.id(ins.arg1), src = vars.id(ins.arg2);
+        long j = lastDef[src];
+        if (d != src and j != NONE and is_retargetable(lins[j]) and
+            lastUse[src] <= j and lastUse[d] <= j and lastDef[d] < j) {
+          lins[j].arg1 = ins.arg1;
+          lastDef[d] = j;
+          lastDef[src] = NONE;
+          removed[i] = true;
+          ++numRemoved;
+          continue;
+        }
+      }
+      varTable::effects e = vars.effects_of(ins);
+      for (size_t u : e.uses)
+        if (u != varTable::NONE) {
+          lastUse[u] = i;
+          touched.push_back(u);
+        }
+      if (e.def != varTable::NONE) {
+        lastDef[e.def] = i;
+        touched.push_back(e.def);
+      }
+    }
+    for (size_t v : touched) lastDef[v] = lastUse[v] = NONE;
+    touched.clear();
+
+    // copy propagation: x = y; ... x ...  ==>  x = y; ... y ...
+    for (size_t i = first; i < last; ++i) {
+      if (removed[i]) continue;
+      instruction &ins = lins[i];
+      operand *args[3] = {&ins.arg1, &ins.arg2, &ins.arg3};
+      int reads = read_args(ins), bases = base_args(ins);
+      for (int k = 0; k < 3; ++k) {
+        size_t v = ((reads >> k) & 1 ? vars.id(*args[k]) : varTable::NONE);
+        if (v == varTable::NONE or copyOf[v] == varTable::NONE) continue;
+        const operand &y = vars.var(copyOf[v]);
+        // a name as the base of an array access is a local array (also
+        // for tvm), so only a temp may replace a temp base
+        if (((bases >> k) & 1) and (args[k]->kind != operand::_TEMP or y.kind != operand::_TEMP))
+          continue;
+        *args[k] = y;
+      }
+      size_t d = vars.effects_of(ins).def;
+      if (d != varTable::NONE) {
+        copyOf[d] = varTable::NONE;
+        for (size_t x : copies)
+          if (copyOf[x] == d) copyOf[x] = varTable::NONE;
+      }
+      if (is_copy(ins, vars) and vars.id(ins.arg1) != vars.id(ins.arg2)) {
+        copyOf[d] = vars.id(ins.arg2);
+        copies.push_back(d);
+      }
+    }
+    for (size_t x : copies) copyOf[x] = varTable::NONE;
+    copies.clear();
+
+    // copies whose result is not live, or to the same variable
+    l = live.live_out(b);
+    for (size_t i = last; i-- > first; ) {
+      if (removed[i]) continue;
+      varTable::effects e = vars.effects_of(lins[i]);
+      if (is_copy(lins[i], vars) and (not l.test(e.def) or e.def == e.uses[0])) {
+        removed[i] = true;
+        ++numRemoved;
+        continue;
+      }
+      if (e.def != varTable::NONE) l.reset(e.def);
+      for (size_t u : e.uses)
+        if (u != varTable::NONE) l.set(u);
+    }
+  }
+
+  keep(s, lins, removed, numRemoved);
+  c.movesRemoved += numRemoved;
+}
+
+void optimizer::remove_dead_code(subroutine &s, counts &c) {
+  // blocks that cannot be reached
+  {
+    instructionList lins = s.get_instructions();
+    flowGraph g(lins);
+    vector<bool> removed(lins.size(), false);
+    size_t numRemoved = 0;
+    for (size_t b = 0; b < g.size(); ++b)
+      if (not g.reachable(b))
+        for (size_t i = g[b].first; i < g[b].last; ++i) {
+          removed[i] = true;
+          ++numRemoved;
+        }
+    if (numRemoved > 0) keep(s, lins, removed, numRemoved);
+    c.unreachableRemoved += numRemoved;
+  }
+
+  // jumps to the next instruction (maybe through some labels), and
+  // then the labels no jump goes to
+  {
+    instructionList lins = s.get_instructions();
+    vector<bool> removed(lins.size(), false);
+    size_t numRemoved = 0;
+    for (size_t i = 0; i < lins.size(); ++i) {
+      if (lins[i].oper != instruction::_UJUMP and lins[i].oper != instruction::_FJUMP) continue;
+      const operand &target = (lins[i].oper == instruction::_UJUMP ? lins[i].arg1 : lins[i].arg2);
+      for (size_t j = i+1; j < lins.size() and lins[j].oper == instruction::_LABEL; ++j)
+        if (lins[j].arg1 == target) {
+          removed[i] = true;
+          ++numRemoved;
+          ++c.jumpsRemoved;
+          break;
+        }
+    }
+    // labels (Ids of their names) some jump goes to, sorted
+    vector<unsigned int> used;
+    for (size_t i = 0; i < lins.size(); ++i)
+      if (not removed[i] and lins[i].oper == instruction::_UJUMP) used.push_back(lins[i].arg1.value);
+      else if (not removed[i] and lins[i].oper == instruction::_FJUMP) used.push_back(lins[i].arg2.value);
+    sort(used.begin(), used.end());
+    for (size_t i = 0; i < lins.size(); ++i)
+      if (lins[i].oper == instruction::_LABEL and
+          not binary_search(used.begin(), used.end(), lins[i].arg1.value)) {
+        removed[i] = true;
+        ++numRemoved;
+        ++c.labelsRemoved;
+      }
+    if (numRemoved > 0) keep(s, lins, removed, numRemoved);
+  }
+
+  // instructions writing variables that are not live, until there
+  // are no more (removing one can leave dead those it read)
+  size_t numRemoved;
+  do {
+    instructionList lins = s.get_instructions();
+    flowGraph g(lins);
+    varTable vars(s);
+    liveness live(g, lins, vars);
+    vector<bool> removed(lins.size(), false);
+    numRemoved = 0;
+    size_t numChanged = 0;
+    for (size_t b = 0; b < g.size(); ++b) {
+      bitSet l = live.live_out(b);
+      for (size_t i = g[b].last; i-- > g[b].first; ) {
+        varTable::effects e = vars.effects_of(lins[i]);
+        if (e.def != varTable::NONE and not l.test(e.def)) {
+          if (is_pure(lins[i])) {
+            removed[i] = true;
+            ++numRemoved;
+            continue;
+          }
+          if (lins[i].oper == instruction::_POP) {
+            lins[i].arg1 = operand();
+            ++numChanged;
+          }
+        }
+        if (e.def != varTable::NONE) l.reset(e.def);
+        for (size_t u : e.uses)
+          if (u != varTable::NONE) l.set(u);
+      }
+    }
+    if (numRemoved > 0) keep(s, lins, removed, numRemoved);
+    else if (numChanged > 0) s.set_instructions(std::move(lins));
+    c.deadStoresRemoved += numRemoved + numChanged;
+  } while (numRemoved > 0);
+}
+
+void optimizer::optimize(subroutine &s, StringPool &pool, counts &c) {
+  propagate_constants(s, pool, c);
+  number_values(s, c);
+  propagate_copies(s, c);
+  remove_dead_code(s, c);
+}
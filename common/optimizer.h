@@ -0,0 +1,115 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+#include "code.h"
+
+////////////////////////////////////////////////////////////////////
+/// Optimization passes over the t-code of a subroutine. Each one
+/// rewrites the instructions of the subroutine (leaving its params and
+/// vars as they were), keeps the output of the program the same, and
+/// adds what it did to the given counts. The constants they write
+/// are interned in the pool of the code the subroutine belongs to.
+
+namespace optimizer {
+
+  /// what the passes did to a subroutine
+  struct counts {
+    /// instructions computed at compile time, now loading a constant
+    std::size_t constantsFolded = 0;
+    /// FJUMPs with a known condition, now a UJUMP or nothing
+    std::size_t branchesFolded = 0;
+    /// loads of constants no longer used, removed
+    std::size_t loadsRemoved = 0;
+    /// copies (LOAD x = y) removed
+    std::size_t movesRemoved = 0;
+    /// values computed again, now copied from where they were (or
+    /// not computed at all, if already there)
+    std::size_t valuesReused = 0;
+    /// instructions in blocks that cannot be reached, removed
+    std::size_t unreachableRemoved = 0;
+    /// jumps to the next instruction, and labels no jump goes to, removed
+    std::size_t jumpsRemoved = 0;
+    std::size_t labelsRemoved = 0;
+    /// instructions writing a variable that is not read afterwards, removed
+    std::size_t deadStoresRemoved = 0;
+
+    counts & operator+=(const counts &c);
+  };
+
+  /// Sparse conditional constant propagation: finds the variables
+  /// with a known constant value at each point, following only the
+  /// branches that can be taken with the values known so far, and
+  /// replaces the operations (and copies) whose result is a constant
+  /// by a load of that constant. Folds integer, float and boolean
+  /// operations as the VM computes them (integers wrap around; a DIV
+  /// that would fail is left for run time), and so also the
+  /// DIV/MUL/SUB sequence of a MOD. FJUMPs on a known condition
+  /// become a UJUMP or disappear. The loads of constants left unused
+  /// are then removed.
+  void propagate_constants(subroutine &s, StringPool &pool, counts &c);
+
+  /// Value numbering: operations (and loads of constants, and of
+  /// array elements) that compute a value already held by some
+  /// variable are replaced by a copy of it. Done in each basic block
+  /// with what is known from its dominators: a block starts with the
+  /// values of its immediate dominator, except for the variables that
+  /// may be written on the way from there (in the blocks that can reach
+  /// it without going through the dominator). Loads through memory
+  /// (LOADX, LOADC) are only reused while nothing can have written to
+  /// memory since: any XLOAD, CLOAD, CALL or write to a variable in
+  /// memory forgets all of them.
+  void number_values(subroutine &s, counts &c);
+
+  /// Copy propagation and coalescing, inside each basic block. A
+  /// value computed into a variable that is only copied to another
+  /// one (%t = a + b; x = %t, or popparam %t; x = %t) is computed
+  /// straight into the second one, if the first one is not live
+  /// after the copy and the second one is not read or written in
+  /// between. The copies left are propagated to the instructions that
+  /// follow (x = y; ... x ... reads y while neither changes), and
+  /// then removed if what they write is not live.
+  void propagate_copies(subroutine &s, counts &c);
+
+  /// Dead code elimination: removes the blocks that cannot be
+  /// reached (code after a RETURN, or after a jump folded away), the
+  /// jumps to the instruction that follows them, the labels no jump
+  /// goes to, and, driven by liveness, the instructions whose result
+  /// is never read. Calls, PUSH/POP, READ*, WRITE* and RETURN are
+  /// kept for their side effects (a dead popparam only loses its
+  /// operand), and so are the instructions that can stop the program
+  /// with an error (DIV, LOADX, LOADC).
+  void remove_dead_code(subroutine &s, counts &c);
+
+  /// all the passes, in order
+  void optimize(subroutine &s, StringPool &pool, counts &c);
+
+}  // namespace optimizer
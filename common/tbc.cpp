@@ -0,0 +1,359 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "tbc.h"
+#include "code.h"
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstring>
+
+#include <fcntl.h>      // open
+#include <unistd.h>     // close
+#include <sys/mman.h>   // mmap, munmap
+#include <sys/stat.h>   // fstat
+
+using namespace std;
+
+namespace tbc {
+
+  namespace {
+
+    uint64_t align8(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+
+    // strings of a program, numbered in order of first appearance
+    class stringTable {
+     public:
+      uint32_t add(const string &s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        uint32_t id = strs.size();
+        ids.insert(make_pair(s, id));
+        strs.push_back(s);
+        return id;
+      }
+      vector<string> strs;
+     private:
+      unordered_map<string, uint32_t> ids;
+    };
+
+    // per subroutine tables, before being written
+    struct subTables {
+      tbcSubroutine info;
+      vector<tbcVar> params, vars;
+      vector<tbcInstruction> code;
+      vector<tbcLabel> labels;
+    };
+
+    bool is_text(uint8_t kind) {
+      return kind == operand::_NAME or kind == operand::_LABEL or kind == operand::_INT or
+             kind == operand::_FLOAT or kind == operand::_CHAR;
+    }
+
+    void write_padding(ostream &os, uint64_t &pos, uint64_t target) {
+      static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      os.write(zeros, target - pos);
+      pos = target;
+    }
+
+    template <class T>
+    void write_table(ostream &os, uint64_t &pos, const vector<T> &v) {
+      if (v.empty()) return;
+      os.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+      pos += v.size() * sizeof(T);
+    }
+  }
+
+
+  ////////////////////////////////////////////////////////////////////
+  /// write code in .tbc format
+
+  bool write(const code &c, ostream &os) {
+    const StringPool & pool = c.get_pool();
+    stringTable strings;
+    vector<subTables> subs;
+    subs.reserve(c.get_subroutines().size());
+
+    // build all tables, collecting strings on the way
+    for (auto & s : c.get_subroutines()) {
+      subs.push_back(subTables());
+      subTables & t = subs.back();
+      memset(&t.info, 0, sizeof(t.info));
+      t.info.name = strings.add(s.get_name());
+      uint32_t slot = 0;
+      for (auto & p : s.params) {
+        tbcVar v = {strings.add(*pool.name(p.name)), uint32_t(p.size), slot, 0};
+        t.params.push_back(v);
+        slot += 1;
+      }
+      for (auto & p : s.vars) {
+        tbcVar v = {strings.add(*pool.name(p.name)), uint32_t(p.size), slot, 0};
+        t.vars.push_back(v);
+        slot += (p.size == 0 ? 1 : p.size);
+      }
+      t.info.frameSize = slot;
+      const instructionList & ins = s.get_instructions();
+      t.code.reserve(ins.size());
+      for (size_t pc = 0; pc < ins.size(); ++pc) {
+        const instruction & i = ins[pc];
+        const operand * args[3] = {&i.arg1, &i.arg2, &i.arg3};
+        tbcInstruction ti;
+        ti.oper = uint8_t(i.oper);
+        for (int k = 0; k < 3; ++k) {
+          ti.kind[k] = uint8_t(args[k]->kind);
+          if (is_text(ti.kind[k])) ti.value[k] = strings.add(*pool.name(args[k]->value));
+          else                     ti.value[k] = args[k]->value;
+          if (ti.kind[k] == operand::_TEMP and args[k]->value > t.info.numTemps)
+            t.info.numTemps = args[k]->value;
+        }
+        t.code.push_back(ti);
+        if (i.oper == instruction::_LABEL) {
+          tbcLabel l = {ti.value[0], uint32_t(pc)};
+          t.labels.push_back(l);
+        }
+      }
+      t.info.numParams = t.params.size();
+      t.info.numVars = t.vars.size();
+      t.info.numInstructions = t.code.size();
+      t.info.numLabels = t.labels.size();
+    }
+
+    // compute the layout of the file
+    tbcHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(h.magic));
+    h.version = VERSION;
+    h.byteOrder = ENDIAN_MARK;
+    h.numStrings = strings.strs.size();
+    h.numSubs = subs.size();
+    h.stringsOffset = align8(sizeof(tbcHeader));
+    vector<tbcString> stringIndex;
+    uint64_t dataSize = 0;
+    for (auto & s : strings.strs) {
+      tbcString e = {uint32_t(dataSize), uint32_t(s.size())};
+      stringIndex.push_back(e);
+      dataSize += s.size() + 1;
+    }
+    h.stringDataOffset = align8(h.stringsOffset + stringIndex.size() * sizeof(tbcString));
+    h.subsOffset = align8(h.stringDataOffset + dataSize);
+    uint64_t off = h.subsOffset + subs.size() * sizeof(tbcSubroutine);
+    for (auto & t : subs) {
+      t.info.paramsOffset = off;  off += t.params.size() * sizeof(tbcVar);
+      t.info.varsOffset = off;    off += t.vars.size() * sizeof(tbcVar);
+      t.info.codeOffset = off;    off += t.code.size() * sizeof(tbcInstruction);
+      t.info.labelsOffset = off;  off += t.labels.size() * sizeof(tbcLabel);
+    }
+    h.fileSize = off;
+
+    // and write it
+    uint64_t pos = 0;
+    os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    pos += sizeof(h);
+    write_padding(os, pos, h.stringsOffset);
+    write_table(os, pos, stringIndex);
+    write_padding(os, pos, h.stringDataOffset);
+    for (auto & s : strings.strs) {
+      os.write(s.c_str(), s.size() + 1);
+      pos += s.size() + 1;
+    }
+    write_padding(os, pos, h.subsOffset);
+    for (auto & t : subs) {
+      os.write(reinterpret_cast<const char *>(&t.info), sizeof(t.info));
+      pos += sizeof(t.info);
+    }
+    for (auto & t : subs) {
+      write_table(os, pos, t.params);
+      write_table(os, pos, t.vars);
+      write_table(os, pos, t.code);
+      write_table(os, pos, t.labels);
+    }
+    return bool(os);
+  }
+
+
+  ////////////////////////////////////////////////////////////////////
+  /// Implementation for class 'tbcFile'
+
+  tbcFile::tbcFile() : base(nullptr), length(0) {}
+  tbcFile::~tbcFile() { close(); }
+
+  bool tbcFile::open(const string &fname) {
+    close();
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0) { err = "cannot open " + fname; return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 or st.st_size < off_t(sizeof(tbcHeader))) {
+      ::close(fd);
+      err = fname + " is not a .tbc file";
+      return false;
+    }
+    void * p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { err = "cannot map " + fname; return false; }
+    base = static_cast<const char *>(p);
+    length = st.st_size;
+    if (not validate()) {
+      string e = fname + ": " + err;
+      close();
+      err = e;
+      return false;
+    }
+    return true;
+  }
+
+  void tbcFile::close() {
+    if (base) munmap(const_cast<char *>(base), length);
+    base = nullptr;
+    length = 0;
+  }
+
+  const string & tbcFile::error() const { return err; }
+
+  const tbcHeader & tbcFile::header() const { return *reinterpret_cast<const tbcHeader *>(base); }
+
+  size_t tbcFile::num_strings() const { return header().numStrings; }
+
+  const char * tbcFile::string_at(uint32_t id) const {
+    const tbcString * tab = reinterpret_cast<const tbcString *>(base + header().stringsOffset);
+    return base + header().stringDataOffset + tab[id].offset;
+  }
+
+  uint32_t tbcFile::string_length(uint32_t id) const {
+    const tbcString * tab = reinterpret_cast<const tbcString *>(base + header().stringsOffset);
+    return tab[id].length;
+  }
+
+  size_t tbcFile::num_subroutines() const { return header().numSubs; }
+
+  const tbcSubroutine & tbcFile::subroutine_at(size_t i) const {
+    return reinterpret_cast<const tbcSubroutine *>(base + header().subsOffset)[i];
+  }
+
+  const tbcVar * tbcFile::params(const tbcSubroutine &s) const {
+    return reinterpret_cast<const tbcVar *>(base + s.paramsOffset);
+  }
+  const tbcVar * tbcFile::vars(const tbcSubroutine &s) const {
+    return reinterpret_cast<const tbcVar *>(base + s.varsOffset);
+  }
+  const tbcInstruction * tbcFile::instructions(const tbcSubroutine &s) const {
+    return reinterpret_cast<const tbcInstruction *>(base + s.codeOffset);
+  }
+  const tbcLabel * tbcFile::labels(const tbcSubroutine &s) const {
+    return reinterpret_cast<const tbcLabel *>(base + s.labelsOffset);
+  }
+
+  bool tbcFile::inside(uint64_t off, uint64_t n, uint64_t sz) const {
+    return off % 8 == 0 and off <= length and n <= (length - off) / sz;
+  }
+
+  // check everything once, so that accessors need no checks
+  bool tbcFile::validate() {
+    const tbcHeader & h = header();
+    if (memcmp(h.magic, MAGIC, sizeof(h.magic)) != 0) { err = "bad magic number"; return false; }
+    if (h.byteOrder != ENDIAN_MARK) { err = "written with a different byte order"; return false; }
+    if (h.version != VERSION) { err = "unsupported version " + to_string(h.version); return false; }
+    if (h.fileSize != length) { err = "truncated file"; return false; }
+    if (not inside(h.stringsOffset, h.numStrings, sizeof(tbcString)) or
+        not inside(h.subsOffset, h.numSubs, sizeof(tbcSubroutine)) or
+        not inside(h.stringDataOffset, 0, 1)) {
+      err = "corrupted tables";
+      return false;
+    }
+    uint64_t dataSize = h.subsOffset >= h.stringDataOffset ? h.subsOffset - h.stringDataOffset : 0;
+    for (uint32_t i = 0; i < h.numStrings; ++i) {
+      const tbcString & e = reinterpret_cast<const tbcString *>(base + h.stringsOffset)[i];
+      if (uint64_t(e.offset) + e.length >= dataSize or string_at(i)[e.length] != '\0') {
+        err = "corrupted string table";
+        return false;
+      }
+    }
+    for (uint32_t i = 0; i < h.numSubs; ++i) {
+      const tbcSubroutine & s = subroutine_at(i);
+      if (s.name >= h.numStrings or
+          not inside(s.paramsOffset, s.numParams, sizeof(tbcVar)) or
+          not inside(s.varsOffset, s.numVars, sizeof(tbcVar)) or
+          not inside(s.codeOffset, s.numInstructions, sizeof(tbcInstruction)) or
+          not inside(s.labelsOffset, s.numLabels, sizeof(tbcLabel))) {
+        err = "corrupted subroutine table";
+        return false;
+      }
+      for (uint32_t k = 0; k < s.numParams; ++k)
+        if (params(s)[k].name >= h.numStrings) { err = "corrupted params"; return false; }
+      for (uint32_t k = 0; k < s.numVars; ++k)
+        if (vars(s)[k].name >= h.numStrings) { err = "corrupted vars"; return false; }
+      const tbcInstruction * code = instructions(s);
+      for (uint32_t pc = 0; pc < s.numInstructions; ++pc) {
+        if (code[pc].oper >= instruction::_INVALID) { err = "invalid instruction"; return false; }
+        for (int k = 0; k < 3; ++k) {
+          if (code[pc].kind[k] > operand::_CHAR or
+              (is_text(code[pc].kind[k]) and code[pc].value[k] >= h.numStrings)) {
+            err = "invalid operand";
+            return false;
+          }
+        }
+      }
+      for (uint32_t k = 0; k < s.numLabels; ++k)
+        if (labels(s)[k].label >= h.numStrings or labels(s)[k].pc >= s.numInstructions) {
+          err = "corrupted labels";
+          return false;
+        }
+    }
+    return true;
+  }
+
+  void tbcFile::load(code &c) const {
+    // file string id -> Id in the pool of c
+    vector<StringPool::Id> ids(num_strings());
+    for (uint32_t i = 0; i < num_strings(); ++i)
+      ids[i] = c.get_pool().id(c.get_pool().intern(string_at(i), string_length(i)));
+
+    for (size_t n = 0; n < num_subroutines(); ++n) {
+      const tbcSubroutine & ts = subroutine_at(n);
+      subroutine s(*c.get_pool().name(ids[ts.name]));
+      for (uint32_t k = 0; k < ts.numParams; ++k)
+        s.add_param(ids[params(ts)[k].name]);
+      for (uint32_t k = 0; k < ts.numVars; ++k)
+        s.add_var(ids[vars(ts)[k].name], vars(ts)[k].size);
+      instructionList lins;
+      lins.reserve(ts.numInstructions);
+      const tbcInstruction * code = instructions(ts);
+      for (uint32_t pc = 0; pc < ts.numInstructions; ++pc) {
+        operand args[3];
+        for (int k = 0; k < 3; ++k) {
+          uint32_t v = code[pc].value[k];
+          args[k] = operand(operand::Kind(code[pc].kind[k]), is_text(code[pc].kind[k]) ? ids[v] : v);
+        }
+        lins.push_back(instruction(instruction::Operation(code[pc].oper), args[0], args[1], args[2]));
+      }
+      s.set_instructions(std::move(lins));
+      c.add_subroutine(std::move(s));
+    }
+  }
+
+}  // namespace tbc
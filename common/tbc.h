@@ -0,0 +1,169 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+#include "code.h"
+
+////////////////////////////////////////////////////////////////////
+/// Binary t-code (.tbc) format.
+///
+/// A .tbc file is a compact encoding of a whole 'code' object, meant
+/// to be mapped in memory and used as is. All sections are 8-byte
+/// aligned, and all integers are stored in the byte order of the
+/// machine that wrote the file (checked with 'byteOrder').
+///
+///   tbcHeader
+///   tbcString[numStrings]          offset/length of each string
+///   string data                    (each string is NUL terminated)
+///   tbcSubroutine[numSubs]
+///   for each subroutine:
+///     tbcVar[numParams]            params, at frame slots 0..numParams-1
+///     tbcVar[numVars]              local vars, laid out after the params
+///     tbcInstruction[numInstructions]
+///     tbcLabel[numLabels]          label -> pc, already resolved
+///
+/// Names, labels and constants are operands of kind _NAME/_LABEL/
+/// _INT/_FLOAT/_CHAR whose value is an index in the string table of
+/// the file (not in the StringPool of any code object).
+
+namespace tbc {
+
+  /// magic number and current version of the format
+  const char     MAGIC[4]    = {'T', 'B', 'C', '\0'};
+  const uint32_t VERSION     = 2;
+  const uint32_t ENDIAN_MARK = 0x01020304;
+
+  struct tbcHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t numStrings;
+    uint32_t numSubs;
+    uint32_t reserved;
+    uint64_t stringsOffset;      // tbcString table
+    uint64_t stringDataOffset;   // characters of all strings
+    uint64_t subsOffset;         // tbcSubroutine table
+    uint64_t fileSize;
+  };
+
+  struct tbcString {
+    uint32_t offset;             // relative to stringDataOffset
+    uint32_t length;
+  };
+
+  struct tbcSubroutine {
+    uint32_t name;               // index in string table
+    uint32_t numParams;
+    uint32_t numVars;
+    uint32_t numInstructions;
+    uint32_t numLabels;
+    uint32_t frameSize;          // slots for params and vars (temps not included)
+    uint32_t numTemps;           // highest temp number used (%1..%numTemps)
+    uint32_t reserved;
+    uint64_t paramsOffset;
+    uint64_t varsOffset;
+    uint64_t codeOffset;
+    uint64_t labelsOffset;
+  };
+
+  struct tbcVar {
+    uint32_t name;               // index in string table
+    uint32_t size;               // as in class var (0 for params)
+    uint32_t slot;               // first frame slot
+    uint32_t reserved;
+  };
+
+  struct tbcInstruction {
+    uint8_t  oper;               // instruction::Operation
+    uint8_t  kind[3];            // operand::Kind of each argument
+    uint32_t value[3];           // operand::value of each argument
+  };
+
+  struct tbcLabel {
+    uint32_t label;              // index in string table
+    uint32_t pc;
+  };
+
+  /// write given code in .tbc format. Returns false on I/O errors.
+  bool write(const code &c, std::ostream &os);
+
+  ////////////////////////////////////////////////////////////////////
+  /// Class tbcFile maps a .tbc file in memory (read only) and gives
+  /// direct access to its tables, with no parsing or copying.
+
+  class tbcFile {
+   public:
+    tbcFile();
+    ~tbcFile();
+
+    /// map given file and check its header. On failure returns false
+    /// and error() describes the problem.
+    bool open(const std::string &fname);
+    /// unmap the file
+    void close();
+    /// description of the last error
+    const std::string & error() const;
+
+    /// access to the mapped tables
+    const tbcHeader & header() const;
+    std::size_t num_strings() const;
+    const char * string_at(uint32_t id) const;
+    uint32_t string_length(uint32_t id) const;
+    std::size_t num_subroutines() const;
+    const tbcSubroutine & subroutine_at(std::size_t i) const;
+    const tbcVar * params(const tbcSubroutine &s) const;
+    const tbcVar * vars(const tbcSubroutine &s) const;
+    const tbcInstruction * instructions(const tbcSubroutine &s) const;
+    const tbcLabel * labels(const tbcSubroutine &s) const;
+
+    /// build the equivalent in-memory code object (strings are interned
+    /// in the pool of c, operands are remapped accordingly). This copies
+    /// every subroutine: to run a program, Interpreter::load(tbcFile)
+    /// decodes the mapped tables directly instead.
+    void load(code &c) const;
+
+   private:
+    const char * base;
+    std::size_t length;
+    std::string err;
+
+    // check that [off, off+n*sz) lies inside the file
+    bool inside(uint64_t off, uint64_t n, uint64_t sz) const;
+    bool validate();
+
+    tbcFile(const tbcFile &) = delete;
+    tbcFile & operator=(const tbcFile &) = delete;
+  };
+
+}  // namespace tbc
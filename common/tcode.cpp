@@ -0,0 +1,305 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "tcode.h"
+
+#include <vector>
+#include <map>
+#include <utility>
+#include <cctype>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+
+using namespace std;
+
+namespace tcode {
+
+  namespace {
+
+    // binary operators, as written in t-code
+    const map<string, instruction::Operation> binaryOps = {
+      {"+", instruction::_ADD},    {"-", instruction::_SUB},
+      {"*", instruction::_MUL},    {"/", instruction::_DIV},
+      {"==", instruction::_EQ},    {"<", instruction::_LT},
+      {"<=", instruction::_LE},    {"and", instruction::_AND},
+      {"or", instruction::_OR},    {"+.", instruction::_FADD},
+      {"-.", instruction::_FSUB},  {"*.", instruction::_FMUL},
+      {"/.", instruction::_FDIV},  {"==.", instruction::_FEQ},
+      {"<.", instruction::_FLT},   {"<=.", instruction::_FLE}
+    };
+
+    // unary operators (and prefixes) in "a1 = op a2"
+    const map<string, instruction::Operation> unaryOps = {
+      {"-", instruction::_NEG},    {"-.", instruction::_FNEG},
+      {"not", instruction::_NOT},  {"float", instruction::_FLOAT},
+      {"&", instruction::_ALOAD},  {"*", instruction::_LOADC}
+    };
+
+    // instructions with a single (optional) argument
+    const map<string, instruction::Operation> keywordOps = {
+      {"goto", instruction::_UJUMP},       {"call", instruction::_CALL},
+      {"pushparam", instruction::_PUSH},   {"popparam", instruction::_POP},
+      {"return", instruction::_RETURN},    {"readi", instruction::_READI},
+      {"readf", instruction::_READF},      {"readc", instruction::_READC},
+      {"writei", instruction::_WRITEI},    {"writef", instruction::_WRITEF},
+      {"writec", instruction::_WRITEC},    {"writeln", instruction::_WRITELN},
+      {"noop", instruction::_NOOP}
+    };
+
+    bool is_operator_char(char c) {
+      return c == '=' or c == '<' or c == '+' or c == '-' or c == '*' or c == '/' or c == '.';
+    }
+
+    // split a line in tokens. Character constants are kept with
+    // their quotes, so they can not be confused with names.
+    bool tokenize(const string &line, vector<string> &toks) {
+      size_t i = 0;
+      while (i < line.size()) {
+        char c = line[i];
+        if (isspace((unsigned char)c)) { ++i; continue; }
+        if (c == ';') break;
+        size_t j = i + 1;
+        if (c == '\'') {
+          while (j < line.size() and line[j] != '\'') j += (line[j] == '\\' ? 2 : 1);
+          if (j >= line.size()) return false;
+          ++j;
+        }
+        else if (c == '[' or c == ']' or c == '&' or c == ':') {}
+        else if (c == '-' and j < line.size() and isdigit((unsigned char)line[j]) and
+                 not toks.empty() and toks.back() == "=") {
+          // negative constant
+          while (j < line.size() and (isalnum((unsigned char)line[j]) or line[j] == '.')) ++j;
+        }
+        else if (is_operator_char(c)) {
+          while (j < line.size() and is_operator_char(line[j]) and
+                 not (c == '*' and line[j] != '.')) ++j;
+        }
+        else {
+          while (j < line.size() and not isspace((unsigned char)line[j]) and
+                 string("[]&:;'=<+*/").find(line[j]) == string::npos and
+                 not (line[j] == '-' and j+1 < line.size() and line[j+1] == '.')) ++j;
+        }
+        toks.push_back(line.substr(i, j - i));
+        i = j;
+      }
+      return true;
+    }
+
+    bool is_int(const string &s) {
+      size_t i = (s[0] == '-' ? 1 : 0);
+      return i < s.size() and s.find_first_not_of("0123456789", i) == string::npos;
+    }
+
+    bool is_float(const string &s) {
+      if (not isdigit((unsigned char)s[0]) and s[0] != '-' and s[0] != '.') return false;
+      char *end;
+      strtod(s.c_str(), &end);
+      return *end == '\0';
+    }
+
+    bool is_address(const string &s) {
+      return s[0] == '%' or isalpha((unsigned char)s[0]) or s[0] == '_';
+    }
+
+    // operand of an address: a temp ("%n") or a name, interned in pool
+    operand address(const string &s, StringPool &pool) {
+      if (s[0] == '%' and s.size() > 1 and s.find_first_not_of("0123456789", 1) == string::npos)
+        return operand::TEMP(strtoul(s.c_str()+1, nullptr, 10));
+      return operand::NAME(pool.id(pool.intern(s)));
+    }
+
+    // parse the tokens of an assignment "a1 = ...", "a1[a2] = a3" or "*a1 = a2"
+    bool assignment(const vector<string> &t, StringPool &pool, instruction &ins) {
+      size_t n = t.size();
+      auto addr = [&](size_t k) { return address(t[k], pool); };
+      if (n == 4 and t[0] == "*" and t[2] == "=" and is_address(t[1]) and is_address(t[3])) {
+        ins = instruction(instruction::_CLOAD, addr(1), addr(3));
+        return true;
+      }
+      if (n == 6 and t[1] == "[" and t[3] == "]" and t[4] == "=") {
+        ins = instruction(instruction::_XLOAD, addr(0), addr(2), addr(5));
+        return true;
+      }
+      if (n < 3 or t[1] != "=" or not is_address(t[0])) return false;
+      if (n == 3) {
+        const string &v = t[2];
+        if (v[0] == '\'')   ins = instruction(instruction::_CHLOAD, addr(0), operand::CHAR(pool.id(pool.intern(v.substr(1, v.size()-2)))));
+        else if (is_int(v)) ins = instruction(instruction::_ILOAD, addr(0), operand::INT(pool.id(pool.intern(v))));
+        else if (is_float(v)) ins = instruction(instruction::_FLOAD, addr(0), operand::FLOAT(pool.id(pool.intern(v))));
+        else if (is_address(v)) ins = instruction(instruction::_LOAD, addr(0), addr(2));
+        else return false;
+        return true;
+      }
+      if (n == 4) {
+        auto op = unaryOps.find(t[2]);
+        if (op == unaryOps.end() or not is_address(t[3])) return false;
+        ins = instruction(op->second, addr(0), addr(3));
+        return true;
+      }
+      if (n == 5) {
+        auto op = binaryOps.find(t[3]);
+        if (op == binaryOps.end() or not is_address(t[2]) or not is_address(t[4])) return false;
+        ins = instruction(op->second, addr(0), addr(2), addr(4));
+        return true;
+      }
+      if (n == 6 and t[3] == "[" and t[5] == "]") {
+        ins = instruction(instruction::_LOADX, addr(0), addr(2), addr(4));
+        return true;
+      }
+      return false;
+    }
+
+    // parse the tokens of one instruction
+    bool parse_instruction(const vector<string> &t, StringPool &pool, instruction &ins) {
+      if (t[0] == "label") {
+        if (t.size() != 3 or t[2] != ":") return false;
+        ins = instruction(instruction::_LABEL, operand::LABEL(pool.id(pool.intern(t[1]))));
+        return true;
+      }
+      if (t[0] == "ifFalse") {
+        if (t.size() != 4 or t[2] != "goto") return false;
+        ins = instruction(instruction::_FJUMP, address(t[1], pool), operand::LABEL(pool.id(pool.intern(t[3]))));
+        return true;
+      }
+      auto op = keywordOps.find(t[0]);
+      if (op != keywordOps.end()) {
+        bool noArg = (op->second == instruction::_RETURN or op->second == instruction::_WRITELN or
+                      op->second == instruction::_NOOP);
+        bool optArg = (op->second == instruction::_PUSH or op->second == instruction::_POP);
+        if (t.size() > 2 or (noArg and t.size() != 1) or
+            (not noArg and not optArg and t.size() != 2)) return false;
+        operand arg;
+        if (t.size() == 2 and op->second == instruction::_UJUMP) arg = operand::LABEL(pool.id(pool.intern(t[1])));
+        else if (t.size() == 2 and op->second == instruction::_CALL) arg = operand::NAME(pool.id(pool.intern(t[1])));
+        else if (t.size() == 2) arg = address(t[1], pool);
+        ins = instruction(op->second, arg);
+        return true;
+      }
+      return assignment(t, pool, ins);
+    }
+  }
+
+
+  bool read(std::istream &is, code &c, std::string &err) {
+    enum {OUTSIDE, BODY, PARAMS, VARS} state = OUTSIDE;
+    subroutine *sub = nullptr;
+    subroutine current("");
+    instructionList body;
+    string line;
+    vector<string> toks;
+    size_t nline = 0;
+
+    while (getline(is, line)) {
+      ++nline;
+      toks.clear();
+      if (not tokenize(line, toks)) {
+        err = "line " + to_string(nline) + ": unterminated character constant";
+        return false;
+      }
+      if (toks.empty()) continue;
+
+      string error;
+      switch (state) {
+      case OUTSIDE:
+        if (toks[0] == "function" and toks.size() == 2) {
+          current = subroutine(toks[1]);
+          sub = &current;
+          body.clear();
+          state = BODY;
+        }
+        else error = "'function' expected";
+        break;
+
+      case PARAMS:
+        if (toks[0] == "endparams" and toks.size() == 1) state = BODY;
+        else if (toks.size() == 1 and is_address(toks[0])) sub->add_param(c.get_pool().id(c.get_pool().intern(toks[0])));
+        else error = "parameter name expected";
+        break;
+
+      case VARS:
+        if (toks[0] == "endvars" and toks.size() == 1) state = BODY;
+        else if (toks.size() == 2 and is_address(toks[0]) and is_int(toks[1]))
+          sub->add_var(c.get_pool().id(c.get_pool().intern(toks[0])), strtoul(toks[1].c_str(), nullptr, 10));
+        else error = "variable name and size expected";
+        break;
+
+      case BODY:
+        if (toks[0] == "params" and toks.size() == 1) state = PARAMS;
+        else if (toks[0] == "vars" and toks.size() == 1) state = VARS;
+        else if (toks[0] == "endfunction" and toks.size() == 1) {
+          sub->set_instructions(std::move(body));
+          body = instructionList();
+          c.add_subroutine(std::move(current));
+          sub = nullptr;
+          state = OUTSIDE;
+        }
+        else {
+          instruction ins(instruction::_NOOP);
+          if (parse_instruction(toks, c.get_pool(), ins)) body.push_back(std::move(ins));
+          else error = "syntax error";
+        }
+        break;
+      }
+
+      if (not error.empty()) {
+        err = "line " + to_string(nline) + ": " + error;
+        return false;
+      }
+    }
+
+    if (state != OUTSIDE) {
+      err = "line " + to_string(nline) + ": 'endfunction' expected";
+      return false;
+    }
+    return true;
+  }
+
+
+  bool int_value(const std::string &txt, int &n) {
+    char *end;
+    errno = 0;
+    long v = strtol(txt.c_str(), &end, 10);
+    if (txt.empty() or *end != '\0' or errno == ERANGE or v < INT_MIN or v > INT_MAX) return false;
+    n = int(v);
+    return true;
+  }
+
+
+  int char_value(const std::string &txt) {
+    if (txt.size() == 2 and txt[0] == '\\') {
+      switch (txt[1]) {
+      case 'n': return '\n';
+      case 't': return '\t';
+      default:  return (unsigned char)txt[1];
+      }
+    }
+    return txt.empty() ? 0 : (unsigned char)txt[0];
+  }
+
+}  // namespace tcode
@@ -0,0 +1,56 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TVM - t-Code Virtual Machine
+//
+//    Copyright (C) 2017  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <istream>
+
+#include "code.h"
+
+////////////////////////////////////////////////////////////////////
+/// Reader for textual t-code, i.e. the format written by code::emit()
+/// (and by hand, as in tvm/examples): one instruction per line,
+/// ';' starts a comment that lasts until the end of the line.
+
+namespace tcode {
+
+  /// read a whole program from given stream and add its subroutines
+  /// to 'c' (with their names and constants in the pool of 'c'). On failure returns false, and 'err' gives the line and
+  /// the cause of the first error found.
+  bool read(std::istream &is, code &c, std::string &err);
+
+  /// value of the integer constant of an ILOAD, given its text as
+  /// stored in the operand. Returns false if it does not fit in an int
+  bool int_value(const std::string &txt, int &n);
+
+  /// value of the character constant of a CHLOAD, given its text as
+  /// stored in the operand (e.g. "a", "\n", "\\")
+  int char_value(const std::string &txt);
+
+}  // namespace tcode
@@ -0,0 +1,180 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Interpreter - Execution engine for t-code programs
+//                  (superinstruction fusion)
+//
+//    Copyright (C) 2018  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluís Padró (padro@cs.upc.edu)
+//             José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "Interpreter.h"
+
+#include <vector>
+#include <iomanip>
+
+// A superinstruction replaces the first instruction of a sequence,
+// and executes the whole sequence in a single dispatch. The other
+// instructions stay where they were (the handler reads its operands
+// from them and then skips them), so program counters do not change.
+// A sequence is fused only if no jump lands in the middle of it, so
+// the instructions after the first one can only be reached through
+// the superinstruction.
+//
+// Handlers do exactly what the original sequence did (every temp is
+// still written), so fusion never changes the behaviour of a program;
+// the conditions on operands below just pick the sequences that
+// CodeGenListener actually emits for each idiom.
+
+namespace {
+
+  struct fusionRule {
+    const char * name;
+    int          fused;          // Interpreter::Opcode of the superinstruction
+    int          length;
+    int          ops[3];         // opcodes of the sequence
+    // extra conditions on the operands of the sequence
+    bool (*matches)(int32_t a0, int32_t b0, int32_t c0,
+                    int32_t a1, int32_t b1, int32_t c1,
+                    int32_t a2, int32_t b2, int32_t c2);
+  };
+
+}
+
+void Interpreter::fuse() {
+  // conditions: the result of one instruction is used by the next one
+#define COND(expr) [](int32_t a0, int32_t b0, int32_t c0, int32_t a1, int32_t b1, int32_t c1, \
+                      int32_t a2, int32_t b2, int32_t c2) { return bool(expr); }
+  // longer sequences go first
+  static const fusionRule rules[] = {
+    // x = y + k                    %t = k ; %u = y + %t ; x = %u
+    {"increment",         INCR,   3, {LOADI, ADD, LOAD},        COND(c1 == a0 and b2 == a1)},
+    // while (y < k)                %t = k ; %u = y < %t ; ifFalse %u goto L
+    {"less-imm-branch",   BR_LTI, 3, {LOADI, LT, FJUMP},        COND(c1 == a0 and a2 == a1)},
+    // while (y <= k)
+    {"lesseq-imm-branch", BR_LEI, 3, {LOADI, LE, FJUMP},        COND(c1 == a0 and a2 == a1)},
+    // while (y > k)                %t = k ; %u = %t < y ; ifFalse %u goto L
+    {"imm-less-branch",   BR_ILT, 3, {LOADI, LT, FJUMP},        COND(b1 == a0 and a2 == a1)},
+    // if (y != z)                  %t = y == z ; %u = not %t ; ifFalse %u goto L
+    {"noteq-branch",      BR_NE,  3, {EQ, NOT, FJUMP},          COND(b1 == a0 and a2 == a1)},
+    // y % z                        %t = y / z ; %t = z * %t ; %t = y - %t
+    //                              (the product may come in either order)
+    {"modulo",            MOD,    3, {DIV, MUL, SUB},           COND(((b1 == a0 and c1 == c0) or
+                                                                      (b1 == c0 and c1 == a0)) and
+                                                                     b2 == b0 and c2 == a1 and
+                                                                     a0 != b0 and a0 != c0 and
+                                                                     a1 != b0)},
+    // y op k
+    {"add-imm",           ADDI,   2, {LOADI, ADD},              COND(c1 == a0)},
+    {"sub-imm",           SUBI,   2, {LOADI, SUB},              COND(c1 == a0)},
+    {"mul-imm",           MULI,   2, {LOADI, MUL},              COND(c1 == a0)},
+    // x = k
+    {"set-imm",           SETI,   2, {LOADI, LOAD},             COND(b1 == a0)},
+    // y != z
+    {"noteq",             NE,     2, {EQ, NOT},                 COND(b1 == a0)},
+    // if (y < z), if (y <= z), if (y == z)
+    {"less-branch",       BR_LT,  2, {LT, FJUMP},               COND(a1 == a0)},
+    {"lesseq-branch",     BR_LE,  2, {LE, FJUMP},               COND(a1 == a0)},
+    {"equal-branch",      BR_EQ,  2, {EQ, FJUMP},               COND(a1 == a0)},
+    // write a[i]
+    {"write-indexed",     WRITEI_X_LOCAL, 2, {LOADX_LOCAL, WRITEI}, COND(a1 == a0)},
+    {"write-indexed-ptr", WRITEI_X_PTR,   2, {LOADX_PTR, WRITEI},   COND(a1 == a0)}
+  };
+#undef COND
+
+  for (int op = 0; op < NUM_OPCODES; ++op) {
+    fusedName[op] = nullptr;
+    fusedLength[op] = 0;
+    fusedSites[op] = 0;
+  }
+  for (auto & r : rules) {
+    fusedName[r.fused] = r.name;
+    fusedLength[r.fused] = r.length;
+  }
+  if (not fusion) return;
+
+  // instructions that are the target of some jump
+  std::vector<bool> target(program.size(), false);
+  for (auto & d : program) {
+    if (d.op == UJUMP) target[d.a] = true;
+    else if (d.op == FJUMP) target[d.b] = true;
+  }
+
+  const std::size_t n = program.size();
+  std::size_t pc = 0;
+  while (pc < n) {
+    const fusionRule * match = nullptr;
+    for (auto & r : rules) {
+      if (pc + r.length > n) continue;
+      bool ok = true;
+      for (int k = 0; k < r.length and ok; ++k)
+        ok = (program[pc+k].op == r.ops[k] and (k == 0 or not target[pc+k]));
+      if (not ok) continue;
+      const decoded & d0 = program[pc];
+      const decoded & d1 = program[pc+1];
+      const decoded & d2 = (r.length > 2 ? program[pc+2] : program[pc+1]);
+      if (r.matches(d0.a, d0.b, d0.c, d1.a, d1.b, d1.c, d2.a, d2.b, d2.c)) {
+        match = &r;
+        break;
+      }
+    }
+    if (match) {
+      program[pc].op = Opcode(match->fused);
+      ++fusedSites[match->fused];
+      pc += match->length;
+    }
+    else ++pc;
+  }
+}
+
+void Interpreter::report_fusion(std::ostream &os) const {
+  // dynamic executions of each opcode, if profiled
+  bool profiled = not executions.empty();
+  uint64_t executed[NUM_OPCODES] = {0};
+  for (std::size_t pc = 0; pc < executions.size(); ++pc)
+    executed[program[pc].op] += executions[pc];
+
+  uint64_t sites = 0, dynamic = 0, eliminated = 0;
+  os << "superinstruction        sites";
+  if (profiled) os << "       executed     eliminated";
+  os << "\n";
+  for (int op = 0; op < NUM_OPCODES; ++op) {
+    dynamic += executed[op];
+    if (fusedLength[op] == 0 or fusedSites[op] == 0) continue;
+    uint64_t saved = executed[op] * (fusedLength[op] - 1);
+    sites += fusedSites[op];
+    eliminated += saved;
+    os << std::left << std::setw(18) << fusedName[op] << std::right << std::setw(11) << fusedSites[op];
+    if (profiled) os << std::setw(15) << executed[op] << std::setw(15) << saved;
+    os << "\n";
+  }
+  os << "total: " << sites << " superinstructions in " << program.size() << " instructions\n";
+  if (profiled) {
+    os << "dynamic instructions: " << dynamic << " executed, " << dynamic + eliminated
+       << " without fusion (" << eliminated << " eliminated";
+    if (dynamic + eliminated > 0)
+      os << ", " << std::fixed << std::setprecision(1)
+         << 100.0 * eliminated / (dynamic + eliminated) << "%" << std::defaultfloat;
+    os << ")\n";
+  }
+}
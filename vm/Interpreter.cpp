@@ -0,0 +1,687 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Interpreter - Execution engine for t-code programs
+//
+//    Copyright (C) 2018  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluís Padró (padro@cs.upc.edu)
+//             José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "Interpreter.h"
+#include "../common/tcode.h"
+
+#include <cstdlib>    // strtof
+#include <cstring>    // memcpy
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+
+// initial size of the memory, and the largest one allowed (in cells)
+static const std::size_t INITIAL_MEMORY = 1 << 12;
+static const std::size_t MAX_MEMORY     = 1 << 28;
+
+
+// computed gotos (labels as values) are a GNU extension
+#if defined(__GNUC__)
+#define HAVE_COMPUTED_GOTO 1
+#else
+#define HAVE_COMPUTED_GOTO 0
+#endif
+
+
+Interpreter::Interpreter()
+  : mainFunction(0), dispatch(HAVE_COMPUTED_GOTO ? THREADED : SWITCH), fusion(true), profiling(false) {
+  for (int op = 0; op < NUM_OPCODES; ++op) {
+    fusedName[op] = nullptr;
+    fusedLength[op] = 0;
+    fusedSites[op] = 0;
+  }
+}
+
+void Interpreter::set_dispatch(Dispatch d) { dispatch = (HAVE_COMPUTED_GOTO ? d : SWITCH); }
+Interpreter::Dispatch Interpreter::get_dispatch() const { return dispatch; }
+void Interpreter::set_fusion(bool on) { fusion = on; }
+void Interpreter::set_profiling(bool on) { profiling = on; }
+
+const std::string & Interpreter::error() const { return err; }
+
+
+////////////////////////////////////////////////////////////////////
+/// Translation of the program
+
+namespace {
+
+  // Subroutines are read through a view, so that the records of a
+  // mapped .tbc file are decoded in place, with no code object built
+  // on the way. A view gives the params, vars and instructions of a
+  // subroutine, the ids of its names, and the text of text operands.
+
+  // view of a subroutine of a code object (ids are the Ids in its pool)
+  class codeSubroutine {
+   public:
+    codeSubroutine(const code &c, const subroutine &s) : pool(&c.get_pool()), s(&s) {
+      for (auto & p : s.params) ps.push_back(&p);
+      for (auto & v : s.vars) vs.push_back(&v);
+      for (auto & i : s.get_instructions()) is.push_back(&i);
+    }
+    std::string name() const { return s->get_name(); }
+    unsigned int name_id() const {
+      return pool->id(pool->find(s->get_name()));   // always there (see code::add_subroutine)
+    }
+    std::size_t num_params() const { return ps.size(); }
+    unsigned int param_id(std::size_t k) const { return ps[k]->name; }
+    std::size_t num_vars() const { return vs.size(); }
+    unsigned int var_id(std::size_t k) const { return vs[k]->name; }
+    unsigned int var_size(std::size_t k) const { return vs[k]->size; }
+    std::size_t num_instructions() const { return is.size(); }
+    const instruction & instruction_at(std::size_t i) const { return *is[i]; }
+    std::string text(const operand &op) const { return *pool->name(op.value); }
+    std::string dump(const operand &op) const { return op.dump(*pool); }
+
+   private:
+    const StringPool * pool;
+    const subroutine * s;
+    std::vector<const var *> ps, vs;
+    std::vector<const instruction *> is;
+  };
+
+  // view of a subroutine of a mapped .tbc file (ids are indexes in the
+  // string table of the file)
+  class tbcSubroutine {
+   public:
+    tbcSubroutine(const tbc::tbcFile &file, const tbc::tbcSubroutine &s)
+      : file(&file), s(&s), ps(file.params(s)), vs(file.vars(s)), is(file.instructions(s)) {}
+    std::string name() const { return text(s->name); }
+    unsigned int name_id() const { return s->name; }
+    std::size_t num_params() const { return s->numParams; }
+    unsigned int param_id(std::size_t k) const { return ps[k].name; }
+    std::size_t num_vars() const { return s->numVars; }
+    unsigned int var_id(std::size_t k) const { return vs[k].name; }
+    unsigned int var_size(std::size_t k) const { return vs[k].size; }
+    std::size_t num_instructions() const { return s->numInstructions; }
+    instruction instruction_at(std::size_t i) const {
+      const tbc::tbcInstruction & r = is[i];
+      return instruction(instruction::Operation(r.oper),
+                         operand(operand::Kind(r.kind[0]), r.value[0]),
+                         operand(operand::Kind(r.kind[1]), r.value[1]),
+                         operand(operand::Kind(r.kind[2]), r.value[2]));
+    }
+    std::string text(const operand &op) const { return text(op.value); }
+    std::string dump(const operand &op) const {
+      if (op.kind == operand::_TEMP) return "%" + std::to_string(op.value);
+      return (op.kind == operand::_NONE ? std::string() : text(op.value));
+    }
+
+   private:
+    const tbc::tbcFile * file;
+    const tbc::tbcSubroutine * s;
+    const tbc::tbcVar * ps;
+    const tbc::tbcVar * vs;
+    const tbc::tbcInstruction * is;
+
+    std::string text(uint32_t id) const { return std::string(file->string_at(id), file->string_length(id)); }
+  };
+
+}
+
+bool Interpreter::load(const code &c) {
+  std::vector<codeSubroutine> subs;
+  for (auto & s : c.get_subroutines()) subs.push_back(codeSubroutine(c, s));
+  return load_program(subs);
+}
+
+bool Interpreter::load(const tbc::tbcFile &file) {
+  std::vector<tbcSubroutine> subs;
+  for (std::size_t k = 0; k < file.num_subroutines(); ++k)
+    subs.push_back(tbcSubroutine(file, file.subroutine_at(k)));
+  return load_program(subs);
+}
+
+template <class Subroutine>
+bool Interpreter::load_program(const std::vector<Subroutine> &subs) {
+  program.clear();
+  source.clear();
+  functions.clear();
+  blocks.clear();
+  err.clear();
+
+  functions.resize(subs.size());
+  bool hasMain = false;
+  for (std::size_t k = 0; k < subs.size(); ++k) {
+    functions[k].name = subs[k].name();
+    if (functions[k].name == "main") {
+      mainFunction = k;
+      hasMain = true;
+    }
+  }
+  if (not hasMain) {
+    err = "no 'main' function";
+    return false;
+  }
+  // subroutines, by the Id of their name
+  std::unordered_map<unsigned int, uint32_t> funcIds;
+  for (std::size_t k = 0; k < subs.size(); ++k)
+    funcIds[subs[k].name_id()] = k;
+  for (std::size_t k = 0; k < subs.size(); ++k)
+    if (not load_subroutine(subs[k], funcIds, functions[k])) return false;
+  fuse();
+  return true;
+}
+
+template <class Subroutine>
+bool Interpreter::load_subroutine(const Subroutine &s,
+                                  const std::unordered_map<unsigned int, uint32_t> &funcIds,
+                                  function &f) {
+  // frame slot of each param and var
+  std::unordered_map<unsigned int, int32_t> slots;
+  int32_t next = 0;
+  for (std::size_t k = 0; k < s.num_params(); ++k)
+    slots[s.param_id(k)] = next++;
+  f.numParams = next;
+  for (std::size_t k = 0; k < s.num_vars(); ++k) {
+    slots[s.var_id(k)] = next;
+    next += (s.var_size(k) == 0 ? 1 : s.var_size(k));
+  }
+
+  // temps go after the vars, and labels are resolved before decoding
+  const std::size_t n = s.num_instructions();
+  const int32_t tempBase = next;
+  unsigned int maxTemp = 0;
+  std::unordered_map<unsigned int, uint32_t> labels;
+  uint32_t pc = program.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    const instruction & ins = s.instruction_at(i);
+    const operand * args[3] = {&ins.arg1, &ins.arg2, &ins.arg3};
+    for (int k = 0; k < 3; ++k)
+      if (args[k]->kind == operand::_TEMP and args[k]->value > maxTemp) maxTemp = args[k]->value;
+    if (ins.oper == instruction::_LABEL) labels[ins.arg1.value] = pc;
+    else ++pc;
+  }
+  f.entry = program.size();
+  f.frameSize = tempBase + maxTemp + 1;
+
+  // basic blocks start at the entry and at each label
+  const uint32_t fidx = &f - functions.data();
+  block entry = {f.entry, fidx, ""};
+  blocks.push_back(entry);
+  pc = f.entry;
+  for (std::size_t i = 0; i < n; ++i) {
+    const instruction & ins = s.instruction_at(i);
+    if (ins.oper != instruction::_LABEL) { ++pc; continue; }
+    block & last = blocks.back();
+    if (last.start == pc) last.label += (last.label.empty() ? "" : "/") + s.text(ins.arg1);
+    else {
+      block b = {pc, fidx, s.text(ins.arg1)};
+      blocks.push_back(b);
+    }
+  }
+
+  // translation of each kind of operand
+  auto slot = [&](const operand &op, int32_t &out) {
+    if (op.kind == operand::_TEMP) { out = tempBase + op.value; return true; }
+    auto it = (op.kind == operand::_NAME ? slots.find(op.value) : slots.end());
+    if (it == slots.end()) {
+      err = "unknown variable '" + s.dump(op) + "' in function " + f.name;
+      return false;
+    }
+    out = it->second;
+    return true;
+  };
+  // as in tvm, a name as the base of an array access is an array in
+  // the frame (also for a param), and a temp holds its address
+  auto is_local = [&](const operand &op) { return op.kind == operand::_NAME; };
+  auto label = [&](const operand &op, int32_t &out) {
+    auto it = labels.find(op.value);
+    if (it == labels.end()) {
+      err = "unknown label '" + s.dump(op) + "' in function " + f.name;
+      return false;
+    }
+    out = it->second;
+    return true;
+  };
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const instruction & ins = s.instruction_at(i);
+    decoded d = {nullptr, NOOP, 0, 0, 0};
+    bool ok = true;
+    switch (ins.oper) {
+    case instruction::_LABEL: continue;
+    case instruction::_UJUMP: { d.op = UJUMP; ok = label(ins.arg1, d.a); break; }
+    case instruction::_FJUMP: { d.op = FJUMP; ok = slot(ins.arg1, d.a) and label(ins.arg2, d.b); break; }
+    case instruction::_PUSH:
+      if (ins.arg1.empty()) d.op = PUSH_EMPTY;
+      else { d.op = PUSH; ok = slot(ins.arg1, d.a); }
+      break;
+    case instruction::_POP:
+      if (ins.arg1.empty()) d.op = POP_EMPTY;
+      else { d.op = POP; ok = slot(ins.arg1, d.a); }
+      break;
+    case instruction::_CALL: {
+      d.op = CALL;
+      auto it = funcIds.find(ins.arg1.value);
+      if (it == funcIds.end()) {
+        err = "call to unknown function '" + s.dump(ins.arg1) + "' in function " + f.name;
+        return false;
+      }
+      d.a = it->second;
+      break;
+    }
+    case instruction::_RETURN: d.op = RETURN; break;
+
+    case instruction::_ADD:  d.op = ADD;  break;
+    case instruction::_SUB:  d.op = SUB;  break;
+    case instruction::_MUL:  d.op = MUL;  break;
+    case instruction::_DIV:  d.op = DIV;  break;
+    case instruction::_EQ:   d.op = EQ;   break;
+    case instruction::_LT:   d.op = LT;   break;
+    case instruction::_LE:   d.op = LE;   break;
+    case instruction::_AND:  d.op = AND;  break;
+    case instruction::_OR:   d.op = OR;   break;
+    case instruction::_FADD: d.op = FADD; break;
+    case instruction::_FSUB: d.op = FSUB; break;
+    case instruction::_FMUL: d.op = FMUL; break;
+    case instruction::_FDIV: d.op = FDIV; break;
+    case instruction::_FEQ:  d.op = FEQ;  break;
+    case instruction::_FLT:  d.op = FLT;  break;
+    case instruction::_FLE:  d.op = FLE;  break;
+    case instruction::_NEG:  d.op = NEG;  break;
+    case instruction::_NOT:  d.op = NOT;  break;
+    case instruction::_FNEG: d.op = FNEG; break;
+    case instruction::_FLOAT: d.op = FLOAT; break;
+    case instruction::_LOAD:  d.op = LOAD;  break;
+    case instruction::_ALOAD: d.op = ALOAD; break;
+    case instruction::_LOADC: d.op = LOADC; break;
+    case instruction::_CLOAD: d.op = CLOAD; break;
+
+    case instruction::_ILOAD:
+    case instruction::_FLOAD:
+    case instruction::_CHLOAD: {
+      d.op = LOADI;
+      ok = slot(ins.arg1, d.a);
+      cell v;
+      int n;
+      if (ins.oper == instruction::_ILOAD) {
+        if (not tcode::int_value(s.text(ins.arg2), n)) {
+          err = "integer constant '" + s.text(ins.arg2) + "' out of range in function " + f.name;
+          return false;
+        }
+        v.i = n;
+      }
+      else if (ins.oper == instruction::_FLOAD) v.f = std::strtof(s.text(ins.arg2).c_str(), nullptr);
+      else                                      v.i = tcode::char_value(s.text(ins.arg2));
+      std::memcpy(&d.b, &v, sizeof(v));
+      break;
+    }
+    case instruction::_LOADX: d.op = is_local(ins.arg2) ? LOADX_LOCAL : LOADX_PTR; break;
+    case instruction::_XLOAD: d.op = is_local(ins.arg1) ? XLOAD_LOCAL : XLOAD_PTR; break;
+
+    case instruction::_READI:   d.op = READI;  break;
+    case instruction::_READF:   d.op = READF;  break;
+    case instruction::_READC:   d.op = READC;  break;
+    case instruction::_WRITEI:  d.op = WRITEI; break;
+    case instruction::_WRITEF:  d.op = WRITEF; break;
+    case instruction::_WRITEC:  d.op = WRITEC; break;
+    case instruction::_WRITELN: d.op = WRITELN; break;
+    case instruction::_NOOP:    d.op = NOOP;   break;
+    default:
+      err = "invalid instruction in function " + f.name;
+      return false;
+    }
+
+    // all remaining operands are frame slots
+    if (d.op != UJUMP and d.op != FJUMP and d.op != PUSH and d.op != POP and
+        d.op != CALL and d.op != LOADI) {
+      if (not ins.arg1.empty()) ok = ok and slot(ins.arg1, d.a);
+      if (not ins.arg2.empty()) ok = ok and slot(ins.arg2, d.b);
+      if (not ins.arg3.empty()) ok = ok and slot(ins.arg3, d.c);
+    }
+    if (not ok) return false;
+    program.push_back(d);
+    source.push_back(ins.oper);
+  }
+
+  // falling off the end of a subroutine returns from it
+  decoded r = {nullptr, RETURN, 0, 0, 0};
+  program.push_back(r);
+  source.push_back(instruction::_RETURN);
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// Execution
+
+bool Interpreter::grow(std::vector<cell> &memory, std::size_t n) {
+  if (n <= memory.size()) return true;
+  if (n > MAX_MEMORY) {
+    err = "stack overflow";
+    return false;
+  }
+  std::size_t sz = memory.size();
+  while (sz < n) sz *= 2;
+  memory.resize(sz < MAX_MEMORY ? sz : MAX_MEMORY);
+  return true;
+}
+
+// time for profiles: cycles where the processor has a time stamp
+// counter, nanoseconds otherwise
+static inline uint64_t timestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint32_t Interpreter::call_node(uint32_t parent, uint32_t func) {
+  auto key = std::make_pair(parent, func);
+  auto it = callTreeIndex.find(key);
+  uint32_t node;
+  if (it != callTreeIndex.end()) node = it->second;
+  else {
+    node = callTree.size();
+    callNode n = {func, parent, 0, 0, 0};
+    callTree.push_back(n);
+    callTreeIndex.insert(std::make_pair(key, node));
+  }
+  ++callTree[node].calls;
+  return node;
+}
+
+bool Interpreter::run(std::istream &in, std::ostream &out) {
+  executions.clear();
+  callTree.clear();
+  callTreeIndex.clear();
+  if (profiling) executions.assign(program.size(), 0);
+  if (dispatch == THREADED) return profiling ? execute<true, true>(in, out) : execute<true, false>(in, out);
+  else                      return profiling ? execute<false, true>(in, out) : execute<false, false>(in, out);
+}
+
+// Each instruction is executed by the code after its label L_<opcode>,
+// which ends with NEXT. With switch dispatch, NEXT goes back to a
+// single switch on the opcode. With threaded dispatch, every handler
+// fetches the next instruction and jumps to its handler itself, so
+// each one has its own (better predicted) indirect branch and there
+// is no bounds check on the opcode. When profiling, each dispatch also
+// counts the instruction, and calls and returns take timestamps;
+// otherwise there is no instrumentation at all.
+template <bool threaded, bool profile>
+bool Interpreter::execute(std::istream &in, std::ostream &out) {
+#if HAVE_COMPUTED_GOTO
+#define VM_HANDLER_ADDRESS(op) &&L_##op,
+  static const void * const handlers[NUM_OPCODES] = { VM_OPCODES(VM_HANDLER_ADDRESS) };
+#undef VM_HANDLER_ADDRESS
+  if (threaded)
+    for (auto & d : program) d.handler = handlers[d.op];
+#define NEXT do { if (threaded) { FETCH; goto *d->handler; } goto dispatch; } while (0)
+#else
+#define NEXT goto dispatch
+#endif
+
+  err.clear();
+  std::vector<cell> memory(INITIAL_MEMORY);
+  std::vector<activation> calls;
+  // all reads go through this cell, so a failed read (e.g. at end
+  // of input) leaves in its target whatever was read last, as tvm does
+  cell input;
+  input.i = 0;
+
+  const decoded * code = program.data();
+  const decoded * d;
+  const function & fmain = functions[mainFunction];
+  uint32_t pc = fmain.entry;
+  uint32_t fp = 0;
+  uint32_t frameEnd = fmain.frameSize;
+  uint32_t sp = frameEnd;
+  if (not grow(memory, sp)) return false;
+  cell * m = memory.data();
+  cell * frame = m + fp;
+
+  // profile: executions per pc, and the calls being timed (the first
+  // one is main)
+  struct timedCall { uint32_t node; uint64_t start; uint64_t children; };
+  uint64_t * counts = executions.data();
+  std::vector<timedCall> timed;
+  if (profile) {
+    timedCall t = {call_node(UINT32_MAX, mainFunction), timestamp(), 0};
+    timed.push_back(t);
+  }
+
+  // fetch the next instruction
+#define FETCH if (profile) ++counts[pc]; d = &code[pc++]
+
+  // address computed by the current instruction, checked before use
+  uint32_t addr;
+#define CHECK_ADDRESS(x) addr = (uint32_t)(x); if (addr >= memory.size()) goto invalid_address
+
+ dispatch:
+  FETCH;
+#if HAVE_COMPUTED_GOTO
+  if (threaded) goto *d->handler;
+#endif
+  switch (d->op) {
+#define VM_SWITCH_CASE(op) case op: goto L_##op;
+    VM_OPCODES(VM_SWITCH_CASE)
+#undef VM_SWITCH_CASE
+  case NUM_OPCODES: break;
+  }
+  err = "invalid instruction";
+  return false;
+
+ L_UJUMP: pc = d->a; NEXT;
+ L_FJUMP: if (frame[d->a].i == 0) pc = d->b; NEXT;
+
+ L_PUSH:
+ L_PUSH_EMPTY:
+  if (sp >= memory.size()) {
+    if (not grow(memory, sp + 1)) return false;
+    m = memory.data();
+    frame = m + fp;
+  }
+  if (d->op == PUSH) m[sp] = frame[d->a];
+  ++sp;
+  NEXT;
+ L_POP:
+ L_POP_EMPTY:
+  if (sp <= frameEnd) { err = "popparam with no pushed value"; return false; }
+  --sp;
+  if (d->op == POP) frame[d->a] = m[sp];
+  NEXT;
+
+ L_CALL: {
+    const function & f = functions[d->a];
+    if (sp < frameEnd + f.numParams) {
+      err = "missing parameters in call to " + f.name;
+      return false;
+    }
+    activation act = {pc, fp, frameEnd, sp};
+    calls.push_back(act);
+    if (profile) {
+      timedCall t = {call_node(timed.back().node, d->a), timestamp(), 0};
+      timed.push_back(t);
+    }
+    fp = sp - f.numParams;
+    frameEnd = fp + f.frameSize;
+    sp = frameEnd;
+    if (not grow(memory, sp)) return false;
+    m = memory.data();
+    frame = m + fp;
+    pc = f.entry;
+  }
+  NEXT;
+ L_RETURN: {
+    if (profile) {
+      const timedCall & t = timed.back();
+      uint64_t elapsed = timestamp() - t.start;
+      callTree[t.node].inclusive += elapsed;
+      callTree[t.node].exclusive += elapsed - t.children;
+      timed.pop_back();
+      if (not timed.empty()) timed.back().children += elapsed;
+    }
+    if (calls.empty()) return true;
+    const activation & act = calls.back();
+    pc = act.retPc;
+    fp = act.fp;
+    frameEnd = act.frameEnd;
+    sp = act.sp;
+    calls.pop_back();
+    frame = m + fp;
+  }
+  NEXT;
+
+  // integer arithmetic wraps around, as in tvm
+ L_ADD: frame[d->a].i = (int32_t)((uint32_t)frame[d->b].i + (uint32_t)frame[d->c].i); NEXT;
+ L_SUB: frame[d->a].i = (int32_t)((uint32_t)frame[d->b].i - (uint32_t)frame[d->c].i); NEXT;
+ L_MUL: frame[d->a].i = (int32_t)((uint32_t)frame[d->b].i * (uint32_t)frame[d->c].i); NEXT;
+ L_DIV:
+  if (frame[d->c].i == 0 or (frame[d->c].i == -1 and frame[d->b].i == INT32_MIN)) {
+    err = "division by zero";
+    return false;
+  }
+  frame[d->a].i = frame[d->b].i / frame[d->c].i;
+  NEXT;
+ L_EQ:  frame[d->a].i = frame[d->b].i == frame[d->c].i; NEXT;
+ L_LT:  frame[d->a].i = frame[d->b].i < frame[d->c].i; NEXT;
+ L_LE:  frame[d->a].i = frame[d->b].i <= frame[d->c].i; NEXT;
+ L_NEG: frame[d->a].i = (int32_t)(0u - (uint32_t)frame[d->b].i); NEXT;
+ L_NOT: frame[d->a].i = frame[d->b].i == 0; NEXT;
+ L_AND: frame[d->a].i = frame[d->b].i != 0 and frame[d->c].i != 0; NEXT;
+ L_OR:  frame[d->a].i = frame[d->b].i != 0 or frame[d->c].i != 0; NEXT;
+ L_FLOAT: frame[d->a].f = (float)frame[d->b].i; NEXT;
+
+ L_FADD: frame[d->a].f = frame[d->b].f + frame[d->c].f; NEXT;
+ L_FSUB: frame[d->a].f = frame[d->b].f - frame[d->c].f; NEXT;
+ L_FMUL: frame[d->a].f = frame[d->b].f * frame[d->c].f; NEXT;
+ L_FDIV: frame[d->a].f = frame[d->b].f / frame[d->c].f; NEXT;
+ L_FEQ:  frame[d->a].i = frame[d->b].f == frame[d->c].f; NEXT;
+ L_FLT:  frame[d->a].i = frame[d->b].f < frame[d->c].f; NEXT;
+ L_FLE:  frame[d->a].i = frame[d->b].f <= frame[d->c].f; NEXT;
+ L_FNEG: frame[d->a].f = -frame[d->b].f; NEXT;
+
+ L_LOAD:  frame[d->a] = frame[d->b]; NEXT;
+ L_LOADI: std::memcpy(&frame[d->a], &d->b, sizeof(cell)); NEXT;
+ L_LOADX_LOCAL: CHECK_ADDRESS(fp + d->b + frame[d->c].i); frame[d->a] = m[addr]; NEXT;
+ L_LOADX_PTR:   CHECK_ADDRESS(frame[d->b].i + frame[d->c].i); frame[d->a] = m[addr]; NEXT;
+ L_XLOAD_LOCAL: CHECK_ADDRESS(fp + d->a + frame[d->b].i); m[addr] = frame[d->c]; NEXT;
+ L_XLOAD_PTR:   CHECK_ADDRESS(frame[d->a].i + frame[d->b].i); m[addr] = frame[d->c]; NEXT;
+ L_ALOAD: frame[d->a].i = fp + d->b; NEXT;
+ L_LOADC: CHECK_ADDRESS(frame[d->b].i); frame[d->a] = m[addr]; NEXT;
+ L_CLOAD: CHECK_ADDRESS(frame[d->a].i); m[addr] = frame[d->b]; NEXT;
+
+ L_READI: in >> input.i; frame[d->a] = input; NEXT;
+ L_READF: in >> input.f; frame[d->a] = input; NEXT;
+ L_READC: {
+    char ch;
+    if (in >> ch) input.i = (unsigned char)ch;
+    frame[d->a] = input;
+  }
+  NEXT;
+ L_WRITEI:  out << frame[d->a].i; NEXT;
+ L_WRITEF:  out << frame[d->a].f; NEXT;
+ L_WRITEC:  out << (char)frame[d->a].i; NEXT;
+ L_WRITELN: out << '\n'; NEXT;
+ L_NOOP: NEXT;
+
+  // superinstructions: d[0] is the first instruction of the fused
+  // sequence and d[1], d[2] the ones that follow (see Fusion.cpp)
+ L_ADDI:
+  std::memcpy(&frame[d[0].a], &d[0].b, sizeof(cell));
+  frame[d[1].a].i = (int32_t)((uint32_t)frame[d[1].b].i + (uint32_t)d[0].b);
+  pc += 1; NEXT;
+ L_SUBI:
+  std::memcpy(&frame[d[0].a], &d[0].b, sizeof(cell));
+  frame[d[1].a].i = (int32_t)((uint32_t)frame[d[1].b].i - (uint32_t)d[0].b);
+  pc += 1; NEXT;
+ L_MULI:
+  std::memcpy(&frame[d[0].a], &d[0].b, sizeof(cell));
+  frame[d[1].a].i = (int32_t)((uint32_t)frame[d[1].b].i * (uint32_t)d[0].b);
+  pc += 1; NEXT;
+ L_SETI:
+  std::memcpy(&frame[d[0].a], &d[0].b, sizeof(cell));
+  frame[d[1].a] = frame[d[0].a];
+  pc += 1; NEXT;
+ L_INCR:
+  std::memcpy(&frame[d[0].a], &d[0].b, sizeof(cell));
+  frame[d[1].a].i = (int32_t)((uint32_t)frame[d[1].b].i + (uint32_t)d[0].b);
+  frame[d[2].a] = frame[d[1].a];
+  pc += 2; NEXT;
+ L_NE:
+  frame[d[0].a].i = frame[d[0].b].i == frame[d[0].c].i;
+  frame[d[1].a].i = frame[d[0].a].i == 0;
+  pc += 1; NEXT;
+ L_MOD: {
+    int32_t y = frame[d[0].b].i, z = frame[d[0].c].i;
+    if (z == 0 or (z == -1 and y == INT32_MIN)) {
+      err = "division by zero";
+      return false;
+    }
+    frame[d[0].a].i = y / z;
+    frame[d[1].a].i = (int32_t)((uint32_t)frame[d[0].a].i * (uint32_t)z);
+    frame[d[2].a].i = (int32_t)((uint32_t)y - (uint32_t)frame[d[1].a].i);
+  }
+  pc += 2; NEXT;
+ L_BR_LT:
+  frame[d[0].a].i = frame[d[0].b].i < frame[d[0].c].i;
+  pc = frame[d[0].a].i ? pc + 1 : d[1].b; NEXT;
+ L_BR_LE:
+  frame[d[0].a].i = frame[d[0].b].i <= frame[d[0].c].i;
+  pc = frame[d[0].a].i ? pc + 1 : d[1].b; NEXT;
+ L_BR_EQ:
+  frame[d[0].a].i = frame[d[0].b].i == frame[d[0].c].i;
+  pc = frame[d[0].a].i ? pc + 1 : d[1].b; NEXT;
+ L_BR_NE:
+  frame[d[0].a].i = frame[d[0].b].i == frame[d[0].c].i;
+  frame[d[1].a].i = frame[d[0].a].i == 0;
+  pc = frame[d[1].a].i ? pc + 2 : d[2].b; NEXT;
+ L_BR_LTI:
+  std::memcpy(&frame[d[0].a], &d[0].b, sizeof(cell));
+  frame[d[1].a].i = frame[d[1].b].i < d[0].b;
+  pc = frame[d[1].a].i ? pc + 2 : d[2].b; NEXT;
+ L_BR_LEI:
+  std::memcpy(&frame[d[0].a], &d[0].b, sizeof(cell));
+  frame[d[1].a].i = frame[d[1].b].i <= d[0].b;
+  pc = frame[d[1].a].i ? pc + 2 : d[2].b; NEXT;
+ L_BR_ILT:
+  std::memcpy(&frame[d[0].a], &d[0].b, sizeof(cell));
+  frame[d[1].a].i = d[0].b < frame[d[1].c].i;
+  pc = frame[d[1].a].i ? pc + 2 : d[2].b; NEXT;
+ L_WRITEI_X_LOCAL:
+  CHECK_ADDRESS(fp + d[0].b + frame[d[0].c].i);
+  frame[d[0].a] = m[addr];
+  out << frame[d[0].a].i;
+  pc += 1; NEXT;
+ L_WRITEI_X_PTR:
+  CHECK_ADDRESS(frame[d[0].b].i + frame[d[0].c].i);
+  frame[d[0].a] = m[addr];
+  out << frame[d[0].a].i;
+  pc += 1; NEXT;
+
+ invalid_address:
+  err = "invalid memory access";
+  return false;
+#undef CHECK_ADDRESS
+#undef FETCH
+#undef NEXT
+}
@@ -0,0 +1,219 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Interpreter - Execution engine for t-code programs
+//
+//    Copyright (C) 2018  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluís Padró (padro@cs.upc.edu)
+//             José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../common/code.h"
+#include "../common/tbc.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <utility>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////
+/// Class Interpreter executes a whole t-code program with the same
+/// observable behaviour as tvm.
+///
+/// The program is translated once (load) into a flat array of
+/// pre-decoded instructions, where every name or temp is already a
+/// slot in the frame of its subroutine, every label a program counter
+/// and every call target a subroutine index. Nothing is looked up by
+/// name while running.
+///
+/// Memory is a single array of 32-bit cells, used as a stack of
+/// frames. A frame holds the params (pushed by the caller), then the
+/// local vars and then the temps of the subroutine. Addresses (&x) are
+/// indices in this array, so they can point into any frame.
+
+class Interpreter {
+
+ public:
+  /// a memory cell (ints, bools, chars and addresses use 'i')
+  union cell {
+    int32_t i;
+    float   f;
+  };
+
+  /// how instructions are dispatched: with a switch on the opcode,
+  /// or jumping directly to the handler stored in each instruction
+  /// (only where the compiler supports computed gotos)
+  typedef enum {SWITCH, THREADED} Dispatch;
+
+  /// constructor
+  Interpreter();
+
+  /// select the dispatch method (THREADED by default, when available)
+  void set_dispatch(Dispatch d);
+  Dispatch get_dispatch() const;
+  /// enable or disable superinstruction fusion (enabled by default).
+  /// Must be set before load().
+  void set_fusion(bool on);
+  /// profile the execution (disabled by default): count executions of
+  /// every instruction and measure the time spent in every call.
+  /// When disabled, the execution loop has no instrumentation at all.
+  void set_profiling(bool on);
+
+  /// write a report of the superinstructions made at load time and,
+  /// if profiling was enabled, of the dynamic instructions they saved
+  void report_fusion(std::ostream &os) const;
+  /// write the profile of the last run (see Profile.cpp): instructions
+  /// per operation, per subroutine and per basic block, and time per
+  /// subroutine, all sorted by cost
+  void report_profile(std::ostream &os) const;
+  /// write the time of the last run per call stack, in the "folded
+  /// stacks" format used by flamegraph tools
+  void write_folded_stacks(std::ostream &os) const;
+
+  /// translate given program. On failure returns false and error()
+  /// describes the problem.
+  bool load(const code &c);
+  /// translate the program of a mapped .tbc file, reading its
+  /// records where they are (no code object is built on the way)
+  bool load(const tbc::tbcFile &file);
+  /// execute the loaded program (from its 'main'), reading from 'in'
+  /// and writing to 'out'. Returns false on runtime errors.
+  bool run(std::istream &in, std::ostream &out);
+  /// description of the last error
+  const std::string & error() const;
+
+ private:
+  /// operations of the pre-decoded instructions. Array accesses and
+  /// push/pop come in several flavours, chosen at load time.
+#define VM_OPCODES(X)                                                        \
+    X(UJUMP) X(FJUMP) X(PUSH) X(PUSH_EMPTY) X(POP) X(POP_EMPTY) X(CALL)     \
+    X(RETURN) X(ADD) X(SUB) X(MUL) X(DIV) X(EQ) X(LT) X(LE) X(NEG) X(NOT)   \
+    X(AND) X(OR) X(FLOAT) X(FADD) X(FSUB) X(FMUL) X(FDIV) X(FEQ) X(FLT)     \
+    X(FLE) X(FNEG) X(LOAD) X(LOADI) X(LOADX_LOCAL) X(LOADX_PTR)             \
+    X(XLOAD_LOCAL) X(XLOAD_PTR) X(ALOAD) X(LOADC) X(CLOAD) X(READI)         \
+    X(READF) X(READC) X(WRITEI) X(WRITEF) X(WRITEC) X(WRITELN) X(NOOP)    \
+    VM_SUPERINSTRUCTIONS(X)
+  /// superinstructions, made by fusion of common sequences of the
+  /// above (see Fusion.cpp). The instructions they replace are kept
+  /// right after them, as operands.
+#define VM_SUPERINSTRUCTIONS(X)                                              \
+    X(ADDI) X(SUBI) X(MULI) X(SETI) X(INCR) X(NE) X(MOD)                    \
+    X(BR_LT) X(BR_LE) X(BR_EQ) X(BR_NE) X(BR_LTI) X(BR_LEI) X(BR_ILT)       \
+    X(WRITEI_X_LOCAL) X(WRITEI_X_PTR)
+#define VM_ENUM_ITEM(op) op,
+  typedef enum { VM_OPCODES(VM_ENUM_ITEM) NUM_OPCODES } Opcode;
+#undef VM_ENUM_ITEM
+
+  /// a pre-decoded instruction. Depending on the opcode, each argument
+  /// is a frame slot, an immediate value, a program counter or a
+  /// subroutine index. With threaded dispatch, 'handler' is the
+  /// address of the code that executes the instruction.
+  struct decoded {
+    const void * handler;
+    Opcode       op;
+    int32_t      a, b, c;
+  };
+
+  /// translated subroutine
+  struct function {
+    std::string name;
+    uint32_t    entry;       // pc of the first instruction
+    uint32_t    numParams;
+    uint32_t    frameSize;   // params + vars + temps
+  };
+
+  /// saved state of a caller
+  struct activation {
+    uint32_t retPc;
+    uint32_t fp;
+    uint32_t frameEnd;
+    uint32_t sp;              // top of the stack after the callee returns
+  };
+
+  /// a label-delimited basic block, for profiles
+  struct block {
+    uint32_t    start;       // pc of its first instruction
+    uint32_t    func;
+    std::string label;       // empty for the entry of a subroutine
+  };
+
+  /// a node of the call tree (a subroutine in a given call stack), with
+  /// the time spent in it (in cycles, or in ns where they are not available)
+  struct callNode {
+    uint32_t func;
+    uint32_t parent;
+    uint64_t calls;
+    uint64_t inclusive;
+    uint64_t exclusive;
+  };
+
+  std::vector<decoded>  program;
+  /// instruction::Operation each decoded instruction comes from
+  std::vector<uint8_t>  source;
+  std::vector<function> functions;
+  std::vector<block>    blocks;
+  uint32_t              mainFunction;
+  Dispatch              dispatch;
+  bool                  fusion;
+  bool                  profiling;
+  std::string           err;
+
+  /// name of each superinstruction (null for plain instructions), the
+  /// number of instructions it replaces, and how many of them were made
+  /// at load time
+  const char *          fusedName[NUM_OPCODES];
+  uint8_t               fusedLength[NUM_OPCODES];
+  uint64_t              fusedSites[NUM_OPCODES];
+  /// profile of the last run (if profiling is enabled): executions
+  /// of each pc (superinstructions count once), and the call tree,
+  /// whose root is the call to main
+  std::vector<uint64_t> executions;
+  std::vector<callNode> callTree;
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> callTreeIndex;
+
+  // translate a whole program, given as a view of each subroutine
+  // (see Interpreter.cpp: one for code objects, one for .tbc files)
+  template <class Subroutine>
+  bool load_program(const std::vector<Subroutine> &subs);
+  // translate one subroutine, appending its code to 'program'
+  template <class Subroutine>
+  bool load_subroutine(const Subroutine &s,
+                       const std::unordered_map<unsigned int, uint32_t> &funcIds,
+                       function &f);
+  // replace common sequences of instructions with superinstructions
+  void fuse();
+  // the execution loop, for each dispatch method, with or without profiling
+  template <bool threaded, bool profile>
+  bool execute(std::istream &in, std::ostream &out);
+  // node of the call tree for a call to 'func' from node 'parent'
+  uint32_t call_node(uint32_t parent, uint32_t func);
+  // executions of every pc as if there was no fusion
+  std::vector<uint64_t> unfused_executions() const;
+  // make room for at least 'n' cells in 'memory'
+  bool grow(std::vector<cell> &memory, std::size_t n);
+};
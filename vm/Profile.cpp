@@ -0,0 +1,157 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Interpreter - Execution engine for t-code programs
+//                  (execution profiles)
+//
+//    Copyright (C) 2018  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluís Padró (padro@cs.upc.edu)
+//             José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "Interpreter.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iomanip>
+#include <cstdio>     // snprintf
+
+namespace {
+
+  // names of instruction::Operation, as in the textual t-code
+  const char * const operationNames[] = {
+    "label", "goto", "ifFalse", "pushparam", "popparam", "call", "return",
+    "+", "-", "*", "/", "==", "<", "<=", "- (neg)", "not", "and", "or", "float",
+    "+.", "-.", "*.", "/.", "==.", "<.", "<=.", "-. (neg)",
+    "load", "load int", "load char", "load float", "a[i] = x", "x = a[i]", "&", "x = *p", "*p = x",
+    "readi", "readf", "readc", "writei", "writef", "writec", "writeln", "noop"
+  };
+
+  // percentage of a total
+  std::string percent(uint64_t n, uint64_t total) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%5.1f%%", total ? 100.0 * n / total : 0.0);
+    return buf;
+  }
+
+  // indices 0..n-1 sorted by decreasing key
+  template <class T>
+  std::vector<std::size_t> sorted_by(const std::vector<T> &key) {
+    std::vector<std::size_t> idx(key.size());
+    for (std::size_t i = 0; i < idx.size(); ++i) idx[i] = i;
+    std::stable_sort(idx.begin(), idx.end(),
+                     [&](std::size_t a, std::size_t b) { return key[a] > key[b]; });
+    return idx;
+  }
+
+}
+
+// a superinstruction counts once in 'executions'; give the same count
+// to the instructions it replaced
+std::vector<uint64_t> Interpreter::unfused_executions() const {
+  std::vector<uint64_t> count(executions);
+  for (std::size_t pc = 0; pc < count.size(); ++pc)
+    for (int k = 1; k < fusedLength[program[pc].op]; ++k)
+      count[pc + k] = count[pc];
+  return count;
+}
+
+void Interpreter::report_profile(std::ostream &os) const {
+  if (executions.empty()) return;
+  const std::vector<uint64_t> count = unfused_executions();
+  uint64_t total = 0;
+  for (auto n : count) total += n;
+#if defined(__x86_64__) || defined(__i386__)
+  const char * unit = "cycles";
+#else
+  const char * unit = "ns";
+#endif
+
+  // instructions per operation
+  const std::size_t numOps = sizeof(operationNames) / sizeof(operationNames[0]);
+  std::vector<uint64_t> perOp(numOps, 0);
+  for (std::size_t pc = 0; pc < count.size(); ++pc) perOp[source[pc]] += count[pc];
+  os << "=== Instructions executed per operation (" << total << " in total)\n";
+  for (auto op : sorted_by(perOp)) {
+    if (perOp[op] == 0) break;
+    os << "  " << std::left << std::setw(14) << operationNames[op] << std::right
+       << std::setw(16) << perOp[op] << "  " << percent(perOp[op], total) << "\n";
+  }
+
+  // instructions, calls and time per subroutine. Inclusive time of
+  // recursive calls is only counted at the outermost one.
+  std::vector<uint64_t> instrs(functions.size(), 0), calls(functions.size(), 0);
+  std::vector<uint64_t> inclusive(functions.size(), 0), exclusive(functions.size(), 0);
+  std::vector<uint64_t> perBlock(blocks.size(), 0);
+  for (std::size_t k = 0; k < blocks.size(); ++k) {
+    std::size_t end = (k + 1 < blocks.size() ? blocks[k+1].start : count.size());
+    for (std::size_t pc = blocks[k].start; pc < end; ++pc) perBlock[k] += count[pc];
+    instrs[blocks[k].func] += perBlock[k];
+  }
+  uint64_t totalTime = 0;
+  for (std::size_t n = 0; n < callTree.size(); ++n) {
+    const callNode & c = callTree[n];
+    calls[c.func] += c.calls;
+    exclusive[c.func] += c.exclusive;
+    totalTime += c.exclusive;
+    bool outermost = true;
+    for (uint32_t p = c.parent; p != UINT32_MAX and outermost; p = callTree[p].parent)
+      outermost = (callTree[p].func != c.func);
+    if (outermost) inclusive[c.func] += c.inclusive;
+  }
+  os << "\n=== Subroutines (time in " << unit << ", sorted by exclusive time)\n";
+  os << "  " << std::left << std::setw(20) << "subroutine" << std::right
+     << std::setw(12) << "calls" << std::setw(16) << "instructions"
+     << std::setw(16) << "inclusive" << std::setw(16) << "exclusive" << "\n";
+  for (auto f : sorted_by(exclusive)) {
+    if (calls[f] == 0) continue;
+    os << "  " << std::left << std::setw(20) << functions[f].name << std::right
+       << std::setw(12) << calls[f] << std::setw(16) << instrs[f]
+       << std::setw(16) << inclusive[f] << std::setw(16) << exclusive[f]
+       << "  " << percent(exclusive[f], totalTime) << "\n";
+  }
+
+  // label-delimited basic blocks
+  os << "\n=== Basic blocks (sorted by instructions executed)\n";
+  os << "  " << std::left << std::setw(36) << "block" << std::right
+     << std::setw(14) << "entries" << std::setw(16) << "instructions" << "\n";
+  for (auto k : sorted_by(perBlock)) {
+    if (perBlock[k] == 0) break;
+    const block & b = blocks[k];
+    std::string name = functions[b.func].name + ":" + (b.label.empty() ? "<entry>" : b.label);
+    os << "  " << std::left << std::setw(36) << name << std::right
+       << std::setw(14) << count[b.start] << std::setw(16) << perBlock[k]
+       << "  " << percent(perBlock[k], total) << "\n";
+  }
+}
+
+void Interpreter::write_folded_stacks(std::ostream &os) const {
+  // one line per call stack: "main;f;g <exclusive time>"
+  for (std::size_t n = 0; n < callTree.size(); ++n) {
+    if (callTree[n].exclusive == 0) continue;
+    std::string stack = functions[callTree[n].func].name;
+    for (uint32_t p = callTree[n].parent; p != UINT32_MAX; p = callTree[p].parent)
+      stack = functions[callTree[p].func].name + ";" + stack;
+    os << stack << " " << callTree[n].exclusive << "\n";
+  }
+}
@@ -0,0 +1,49 @@
+function fib
+  params
+    _result
+    n
+  endparams
+
+     %1 = 2
+     %2 = n < %1
+     ifFalse %2 goto endif1
+     _result = n
+     return
+  label endif1 :
+     pushparam 
+     %3 = 1
+     %4 = n - %3
+     pushparam %4
+     call fib
+     popparam 
+     popparam %5
+     pushparam 
+     %6 = 2
+     %7 = n - %6
+     pushparam %7
+     call fib
+     popparam 
+     popparam %8
+     %9 = %5 + %8
+     _result = %9
+     return
+     return
+endfunction
+
+function main
+  vars
+    n 1
+  endvars
+
+   readi n
+   pushparam 
+   pushparam n
+   call fib
+   popparam 
+   popparam %1
+   writei %1
+   writeln
+   return
+endfunction
+
+
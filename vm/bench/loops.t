@@ -0,0 +1,44 @@
+function main
+  vars
+    n 1
+    i 1
+    j 1
+    s 1
+  endvars
+
+     readi n
+     %1 = 0
+     s = %1
+     %2 = 0
+     i = %2
+  label while2 :
+     %3 = i < n
+     ifFalse %3 goto endwhile2
+     %4 = 0
+     j = %4
+  label while1 :
+     %5 = j < n
+     ifFalse %5 goto endwhile1
+     %6 = i * j
+     %7 = 7
+     %8 = %6 / %7
+     %8 = %7 * %8
+     %8 = %6 - %8
+     %9 = s + %8
+     s = %9
+     %10 = 1
+     %11 = j + %10
+     j = %11
+     goto while1
+  label endwhile1 :
+     %12 = 1
+     %13 = i + %12
+     i = %13
+     goto while2
+  label endwhile2 :
+     writei s
+     writeln
+     return
+endfunction
+
+
@@ -0,0 +1,72 @@
+function main
+  vars
+    r 1
+    k 1
+    i 1
+    j 1
+    count 1
+    composite 10000
+  endvars
+
+     readi r
+     %1 = 0
+     k = %1
+  label while4 :
+     %2 = k < r
+     ifFalse %2 goto endwhile4
+     %3 = 0
+     i = %3
+  label while1 :
+     %4 = 10000
+     %5 = i < %4
+     ifFalse %5 goto endwhile1
+     %6 = 0
+     composite[i] = %6
+     %7 = 1
+     %8 = i + %7
+     i = %8
+     goto while1
+  label endwhile1 :
+     %9 = 0
+     count = %9
+     %10 = 2
+     i = %10
+  label while3 :
+     %11 = 10000
+     %12 = i < %11
+     ifFalse %12 goto endwhile3
+     %13 = composite[i]
+     %14 = not %13
+     ifFalse %14 goto endif1
+     %15 = 1
+     %16 = count + %15
+     count = %16
+     %17 = i * i
+     j = %17
+  label while2 :
+     %18 = 10000
+     %19 = j < %18
+     ifFalse %19 goto endwhile2
+     %20 = 1
+     composite[j] = %20
+     %21 = j + i
+     j = %21
+     goto while2
+  label endwhile2 :
+  label endif1 :
+     %22 = 1
+     %23 = i + %22
+     i = %23
+     goto while3
+  label endwhile3 :
+     %24 = 1
+     %25 = k + %24
+     k = %25
+     goto while4
+  label endwhile4 :
+     writei count
+     writeln
+     return
+endfunction
+
+
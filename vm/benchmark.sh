@@ -0,0 +1,51 @@
+#!/bin/bash
+#
+# Compare the dispatch methods of vm and measure superinstruction
+# fusion: runs every program with each configuration and prints the
+# execution time (load time not included).
+#   - programs are ../examples/*.aux.t, the t-code asl generates for
+#     the examples, run with their .in file as input
+#   - they are small, so each one is repeated $REPEAT times in the
+#     same process
+#   - then bench/*.t, loop-heavy synthetic programs where dispatch
+#     dominates: the t-code asl generates for bench/*.asl (after
+#     editing one, regenerate it with ../asl/asl bench/x.asl > bench/x.t),
+#     each one repeated $BENCH_REPEAT times
+# Columns: switch and threaded dispatch without fusion, threaded
+# dispatch with fusion, and the dynamic instructions fusion removes.
+# Usage: ./benchmark.sh [repeat [bench-repeat]]
+
+REPEAT=${1:-2000}
+BENCH_REPEAT=${2:-5}
+
+# time reported by vm --time for given repetitions, program, input
+# and options
+vmtime() {
+    ./vm --time --repeat $1 "${@:4}" "$2" < "$3" 2>&1 >/dev/null |
+        sed -n 's/^execution time: \([^ ]*\) s.*/\1/p'
+}
+
+# ratio of two times
+ratio() {
+    awk -v s="$1" -v t="$2" 'BEGIN { if (t > 0) printf "%.2fx", s/t; else print "-" }'
+}
+
+# one line of the table, for given repetitions, program and input
+measure() {
+    ts=$(vmtime $1 "$2" "$3" --dispatch=switch --no-fusion)
+    tt=$(vmtime $1 "$2" "$3" --dispatch=threaded --no-fusion)
+    tf=$(vmtime $1 "$2" "$3" --dispatch=threaded)
+    el=$(./vm --fusion-stats "$2" < "$3" 2>&1 >/dev/null |
+         sed -n 's/.*eliminated, \(.*\))$/\1/p')
+    printf "%-22s %10s %10s %8s %10s %8s %10s\n" $(basename "$2") \
+           "$ts" "$tt" $(ratio "$ts" "$tt") "$tf" $(ratio "$tt" "$tf") "$el"
+}
+
+printf "%-22s %10s %10s %8s %10s %8s %10s\n" \
+       program switch threaded speedup fused speedup eliminated
+for f in ../examples/*.aux.t; do
+    measure $REPEAT "$f" "${f/aux.t/in}"
+done
+for f in bench/*.t; do
+    measure $BENCH_REPEAT "$f" "${f%.t}.in"
+done
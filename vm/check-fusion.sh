@@ -0,0 +1,44 @@
+#!/bin/bash
+#
+# Check superinstruction fusion on compiler output: every program
+# must print its expected output with and without fusion, and every
+# MOD sequence emitted by asl (%t = y / z ; %t = z * %t ; %t = y - %t)
+# must be fused into a modulo superinstruction.
+# Usage: ./check-fusion.sh [program.t ...]
+#   (default: ../examples/*.aux.t, the output of asl for the examples;
+#    input and expected output are looked up next to each program)
+
+if [ $# -eq 0 ]; then
+    set -- ../examples/*.aux.t
+fi
+
+# number of MOD sequences in the t-code of a program
+modsequences() {
+    awk '{ p2 = p1; p1 = l; l = $0 }
+         l ~ /^ *%[^ ]+ = [^ ]+ - %[^ ]+$/ {
+             split(p2, d, " "); split(p1, m, " "); split(l, s, " ")
+             if (d[4] == "/" && m[4] == "*" &&
+                 m[1] == d[1] && m[3] == d[5] && m[5] == d[1] &&
+                 s[1] == d[1] && s[3] == d[3] && s[5] == d[1]) n++
+         }
+         END { print n + 0 }' "$1"
+}
+
+status=0
+for f in "$@"; do
+    base="${f%.t}"; base="${base%.aux}"
+    in="$base.in"; [ -f "$in" ] || in=/dev/null
+    echo $(basename "$f")
+    if [ -f "$base.out" ]; then
+        ./vm "$f" < "$in" | diff - "$base.out" || status=1
+        ./vm --no-fusion "$f" < "$in" | diff - "$base.out" || status=1
+    fi
+    expected=$(modsequences "$f")
+    fused=$(./vm --fusion-stats "$f" < "$in" 2>&1 >/dev/null |
+            awk '$1 == "modulo" { print $2 }')
+    if [ "${fused:-0}" != "$expected" ]; then
+        echo "modulo: $expected MOD sequences, ${fused:-0} fused"
+        status=1
+    fi
+done
+exit $status
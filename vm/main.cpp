@@ -0,0 +1,157 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Main program - Interpreter for t-code programs. Runs the
+//                   textual (.t) or binary (.tbc) code generated
+//                   by asl, with the same behaviour as tvm.
+//
+//    Copyright (C) 2018  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluís Padró (padro@cs.upc.edu)
+//             José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+
+#include "../common/code.h"
+#include "../common/tcode.h"
+#include "../common/tbc.h"
+#include "Interpreter.h"
+
+#include <iostream>
+#include <fstream>    // ifstream
+#include <sstream>    // istringstream, ostringstream
+#include <iterator>   // istreambuf_iterator
+#include <string>
+#include <chrono>
+
+#include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS, strtoul
+
+
+static void usage() {
+  std::cerr << "Usage: ./vm [--dispatch=switch|threaded] [--no-fusion] [--fusion-stats]" << std::endl
+            << "            [--profile <report>] [--time] [--repeat <n>] <file.t|file.tbc>" << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // check the correct use of the program
+  std::string inFile;
+  Interpreter vm;
+  bool time = false;          // report execution time on std::cerr
+  bool fusionStats = false;   // report superinstructions on std::cerr
+  std::string profile;        // write a profile to this file (and its .folded stacks)
+  unsigned long repeat = 1;   // run the program several times (benchmarks)
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--dispatch=switch")        vm.set_dispatch(Interpreter::SWITCH);
+    else if (arg == "--dispatch=threaded") vm.set_dispatch(Interpreter::THREADED);
+    else if (arg == "--no-fusion")         vm.set_fusion(false);
+    else if (arg == "--fusion-stats")      { fusionStats = true; vm.set_profiling(true); }
+    else if (arg == "--profile" and i+1 < argc) { profile = argv[++i]; vm.set_profiling(true); }
+    else if (arg == "--time")              time = true;
+    else if (arg == "--repeat" and i+1 < argc and std::strtoul(argv[i+1], nullptr, 10) > 0)
+      repeat = std::strtoul(argv[++i], nullptr, 10);
+    else if (arg[0] != '-' and inFile.empty()) inFile = arg;
+    else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (inFile.empty()) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  // load the program, either decoding a mapped binary file in place
+  // or parsing a text one
+  bool binary = inFile.size() > 4 and inFile.compare(inFile.size()-4, 4, ".tbc") == 0;
+  if (binary) {
+    tbc::tbcFile file;
+    if (not file.open(inFile)) {
+      std::cerr << file.error() << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (not vm.load(file)) {
+      std::cerr << inFile << ": " << vm.error() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  else {
+    std::ifstream stream(inFile);
+    if (not stream) {
+      std::cerr << "No such file: " << inFile << std::endl;
+      return EXIT_FAILURE;
+    }
+    code program;
+    std::string err;
+    if (not tcode::read(stream, program, err)) {
+      std::cerr << inFile << ": " << err << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (not vm.load(program)) {
+      std::cerr << inFile << ": " << vm.error() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // program output goes only through std::cout
+  std::ios::sync_with_stdio(false);
+  bool ok = true;
+  auto start = std::chrono::steady_clock::now();
+  if (repeat == 1)
+    ok = vm.run(std::cin, std::cout);
+  else {
+    // every run gets the same input; only the output of the first one is shown
+    std::string input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+    for (unsigned long r = 0; r < repeat and ok; ++r) {
+      std::istringstream in(input);
+      std::ostringstream out;
+      ok = vm.run(in, out);
+      if (r == 0) std::cout << out.str();
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::cout.flush();
+
+  // reports are also written if the program failed
+  if (fusionStats) vm.report_fusion(std::cerr);
+  if (not profile.empty()) {
+    std::ofstream report(profile), folded(profile + ".folded");
+    if (not report or not folded) {
+      std::cerr << "Cannot write file: " << profile << std::endl;
+      return EXIT_FAILURE;
+    }
+    vm.report_profile(report);
+    vm.write_folded_stacks(folded);
+  }
+  if (not ok) {
+    std::cerr << "Runtime error: " << vm.error() << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (time) {
+    std::chrono::duration<double> secs = end - start;
+    std::cerr << "execution time: " << secs.count() << " s ("
+              << repeat << (repeat == 1 ? " run, " : " runs, ")
+              << (vm.get_dispatch() == Interpreter::THREADED ? "threaded" : "switch")
+              << " dispatch)" << std::endl;
+  }
+  return EXIT_SUCCESS;
+}